@@ -64,6 +64,8 @@ crc32_file (int fd, uint32_t *resp)
 	{
 	  do
 	    {
+	      /* The data is read only once, front to back.  */
+	      (void) posix_madvise (mapped, mapsize, POSIX_MADV_SEQUENTIAL);
 	      if (st.st_size <= (off_t) mapsize)
 		{
 		  *resp = crc32 (crc, mapped, st.st_size);
@@ -0,0 +1,225 @@
+/* Cached demangling of C++ symbol names.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <argp.h>
+#include <libintl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "system.h"
+#include "libeu.h"
+#include "demangle.h"
+#include "dl-hash.h"
+
+/* Prototype for option handler.  */
+static error_t parse_opt (int key, char *arg, struct argp_state *state);
+
+/* Option values.  */
+#define OPT_DEMANGLE_STATS 0x100200
+
+/* Definitions of arguments for argp functions.  */
+static const struct argp_option options[] =
+{
+  { "demangle-stats", OPT_DEMANGLE_STATS, NULL, 0,
+    N_("Print how many demangled names were found in the cache"), 0 },
+
+  { NULL, 0, NULL, 0, NULL, 0 }
+};
+
+/* Parser data structure.  */
+const struct argp demangle_argp =
+  {
+    options, parse_opt, NULL, NULL, NULL, NULL, NULL
+  };
+
+/* True if --demangle-stats was given.  */
+static bool print_stats;
+
+/* A cached name.  DEMANGLED is NULL if MANGLED could not be
+   demangled.  MANGLED points to a copy of the name allocated together
+   with the entry.  */
+struct demangle_entry
+{
+  const char *mangled;
+  char *demangled;
+};
+
+/* Definitions for the cache hash table.  */
+#define TYPE struct demangle_entry *
+#define NAME demangle_tab
+#define COMPARE(a, b) strcmp ((a)->mangled, (b)->mangled)
+#define NO_UNDEF
+#include "dynamicsizehash.h"
+#include "dynamicsizehash.c"
+
+/* The cache is emptied when it has this many names.  Names used more
+   than once usually come back soon after.  */
+#define MAX_CACHED 65536
+
+/* Each thread has its own cache, so no locking is needed for
+   lookups.  Returned names stay valid until the thread's cache is
+   emptied.  */
+static __thread demangle_tab cache;
+static __thread bool cache_init;
+
+/* How often demangle_cached was called for mangled names, and how
+   often it found them in the cache.  */
+static __thread size_t nlookups;
+static __thread size_t nhits;
+
+/* The largest number of names cached at a time.  */
+static __thread size_t maxfilled;
+
+/* The numbers of all threads that freed their cache.  */
+static pthread_mutex_t total_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t total_lookups;
+static size_t total_hits;
+static size_t total_maxfilled;
+
+
+/* Handle program arguments.  */
+static error_t
+parse_opt (int key, char *arg __attribute__ ((unused)),
+	   struct argp_state *state __attribute__ ((unused)))
+{
+  switch (key)
+    {
+    case OPT_DEMANGLE_STATS:
+      print_stats = true;
+      break;
+
+    default:
+      return ARGP_ERR_UNKNOWN;
+    }
+  return 0;
+}
+
+
+static void
+free_entries (void)
+{
+  for (size_t idx = 1; idx <= cache.size; ++idx)
+    if (cache.table[idx].hashval != 0)
+      {
+	free (cache.table[idx].data->demangled);
+	free (cache.table[idx].data);
+      }
+}
+
+
+const char *
+demangle_cached (const char *name)
+{
+  /* Require GNU v3 ABI by the "_Z" prefix.  */
+  if (name[0] != '_' || name[1] != 'Z')
+    return name;
+
+  ++nlookups;
+
+  if (! cache_init)
+    {
+      if (demangle_tab_init (&cache, 1021) != 0)
+	error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+      cache_init = true;
+    }
+
+  /* Hash value 0 marks an empty slot in the table.  */
+  unsigned long int hval = _dl_elf_hash (name);
+  hval = hval ?: 1;
+  struct demangle_entry key = { .mangled = name };
+  struct demangle_entry *found = demangle_tab_find (&cache, hval, &key);
+  if (found != NULL)
+    {
+      ++nhits;
+      return found->demangled ?: name;
+    }
+
+  if (cache.filled >= MAX_CACHED)
+    {
+      free_entries ();
+      demangle_tab_free (&cache);
+      if (demangle_tab_init (&cache, 1021) != 0)
+	error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+    }
+
+  size_t len = strlen (name);
+  struct demangle_entry *entry = xmalloc (sizeof *entry + len + 1);
+  entry->mangled = memcpy (entry + 1, name, len + 1);
+
+  int status = -1;
+#ifdef USE_DEMANGLE
+  entry->demangled = __cxa_demangle (name, NULL, NULL, &status);
+#endif
+  if (status != 0)
+    entry->demangled = NULL;
+
+  (void) demangle_tab_insert (&cache, hval, entry);
+  if (cache.filled > maxfilled)
+    maxfilled = cache.filled;
+
+  return entry->demangled ?: name;
+}
+
+
+void
+demangle_cache_thread_end (void)
+{
+  pthread_mutex_lock (&total_lock);
+  total_lookups += nlookups;
+  total_hits += nhits;
+  if (maxfilled > total_maxfilled)
+    total_maxfilled = maxfilled;
+  pthread_mutex_unlock (&total_lock);
+  nlookups = nhits = maxfilled = 0;
+
+  if (cache_init)
+    {
+      free_entries ();
+      demangle_tab_free (&cache);
+      cache_init = false;
+    }
+}
+
+
+void
+demangle_cache_end (void)
+{
+  demangle_cache_thread_end ();
+
+  if (print_stats)
+    fprintf (stderr, gettext ("\
+demangle cache: %zu lookups, %zu hits, at most %zu names cached\n"),
+	     total_lookups, total_hits, total_maxfilled);
+}
@@ -0,0 +1,52 @@
+/* Cached demangling of C++ symbol names.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+
+#ifndef DEMANGLE_H
+#define DEMANGLE_H 1
+
+/* Command line parser for --demangle-stats.  */
+extern const struct argp demangle_argp;
+
+/* Return the demangled form of NAME if it is a GNU v3 mangled name,
+   otherwise NAME itself.  The results are cached by mangled name, up
+   to a fixed number of names.  Every thread has its own cache.  The
+   returned string stays valid until that cache is emptied, which a
+   call in the same thread does when the cache is full, or until
+   demangle_cache_thread_end or demangle_cache_end.  */
+extern const char *demangle_cached (const char *name);
+
+/* Free the cache of the calling thread.  Threads other than the main
+   one have to call this before they exit.  */
+extern void demangle_cache_thread_end (void);
+
+/* Free the cache.  Print how well it worked in all threads to stderr
+   if --demangle-stats was given.  */
+extern void demangle_cache_end (void);
+
+#endif	/* demangle.h */
@@ -32,6 +32,7 @@
 #endif
 
 #include "dwarf_sig8_hash.h"
+#include "dwarf_loc_hash.h"
 #define NO_UNDEF
 #include "libdwP.h"
 
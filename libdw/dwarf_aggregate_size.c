@@ -171,8 +171,8 @@ array_size (Dwarf_Die *die, Dwarf_Word *size,
 }
 
 static int
-aggregate_size (Dwarf_Die *die, Dwarf_Word *size,
-		Dwarf_Die *type_mem, int depth)
+compute_aggregate_size (Dwarf_Die *die, Dwarf_Word *size,
+			Dwarf_Die *type_mem, int depth)
 {
   Dwarf_Attribute attr_mem;
 
@@ -209,6 +209,42 @@ aggregate_size (Dwarf_Die *die, Dwarf_Word *size,
   return -1;
 }
 
+/* A remembered aggregate size, see dwarf_cache_types.  */
+struct size_s
+{
+  Dwarf_Word size;
+};
+
+static int
+aggregate_size (Dwarf_Die *die, Dwarf_Word *size,
+		Dwarf_Die *type_mem, int depth)
+{
+  if (die == NULL || ! die->cu->dbg->type_cache)
+    return compute_aggregate_size (die, size, type_mem, depth);
+
+  Dwarf *dbg = die->cu->dbg;
+  uintptr_t key = (uintptr_t) die->addr;
+  struct size_s *found = Dwarf_Loc_Hash_find (&dbg->size_hash, key);
+  if (found != NULL)
+    {
+      *size = found->size;
+      return 0;
+    }
+
+  /* Only sizes we could determine are remembered.  */
+  int res = compute_aggregate_size (die, size, type_mem, depth);
+  if (res == 0)
+    {
+      struct size_s *newp = libdw_typed_alloc (dbg, struct size_s);
+      newp->size = *size;
+      if (Dwarf_Loc_Hash_insert (&dbg->size_hash, key, newp) != 0)
+	/* Another thread was faster.  */
+	libdw_typed_unalloc (dbg, struct size_s);
+    }
+
+  return res;
+}
+
 int
 dwarf_aggregate_size (Dwarf_Die *die, Dwarf_Word *size)
 {
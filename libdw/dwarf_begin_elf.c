@@ -66,10 +66,21 @@ static const char dwarf_scnnames[IDX_last][19] =
   [IDX_debug_macro] = ".debug_macro",
   [IDX_debug_ranges] = ".debug_ranges",
   [IDX_debug_rnglists] = ".debug_rnglists",
+  [IDX_debug_cu_index] = ".debug_cu_index",
+  [IDX_debug_tu_index] = ".debug_tu_index",
   [IDX_gnu_debugaltlink] = ".gnu_debugaltlink"
 };
 #define ndwarf_scnnames (sizeof (dwarf_scnnames) / sizeof (dwarf_scnnames[0]))
 
+/* Free the hash tables of RESULT when it cannot be used.  */
+static void
+free_hashes (Dwarf *result)
+{
+  Dwarf_Sig8_Hash_free (&result->sig8_hash);
+  Dwarf_Loc_Hash_free (&result->loc_hash);
+  Dwarf_Loc_Hash_free (&result->loclist_hash);
+}
+
 static Dwarf *
 check_section (Dwarf *result, size_t shstrndx, Elf_Scn *scn, bool inscngrp)
 {
@@ -108,7 +119,7 @@ check_section (Dwarf *result, size_t shstrndx, Elf_Scn *scn, bool inscngrp)
       /* The section name must be valid.  Otherwise is the ELF file
 	 invalid.  */
     err:
-      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      free_hashes (result);
       __libdw_seterrno (DWARF_E_INVALID_ELF);
       free (result);
       return NULL;
@@ -212,7 +223,7 @@ valid_p (Dwarf *result)
 		   && result->sectiondata[IDX_debug_line] == NULL
 		   && result->sectiondata[IDX_debug_frame] == NULL))
     {
-      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      free_hashes (result);
       __libdw_seterrno (DWARF_E_NO_DWARF);
       free (result);
       result = NULL;
@@ -226,7 +237,7 @@ valid_p (Dwarf *result)
       result->fake_loc_cu = (Dwarf_CU *) malloc (sizeof (Dwarf_CU));
       if (unlikely (result->fake_loc_cu == NULL))
 	{
-	  Dwarf_Sig8_Hash_free (&result->sig8_hash);
+	  free_hashes (result);
 	  __libdw_seterrno (DWARF_E_NOMEM);
 	  free (result);
 	  result = NULL;
@@ -240,10 +251,10 @@ valid_p (Dwarf *result)
 	  result->fake_loc_cu->endp
 	    = (result->sectiondata[IDX_debug_loc]->d_buf
 	       + result->sectiondata[IDX_debug_loc]->d_size);
-	  result->fake_loc_cu->locs = NULL;
 	  result->fake_loc_cu->address_size = 0;
 	  result->fake_loc_cu->version = 0;
 	  result->fake_loc_cu->split = NULL;
+	  result->fake_loc_cu->dwp_index = NULL;
 	}
     }
 
@@ -252,7 +263,7 @@ valid_p (Dwarf *result)
       result->fake_loclists_cu = (Dwarf_CU *) malloc (sizeof (Dwarf_CU));
       if (unlikely (result->fake_loclists_cu == NULL))
 	{
-	  Dwarf_Sig8_Hash_free (&result->sig8_hash);
+	  free_hashes (result);
 	  __libdw_seterrno (DWARF_E_NOMEM);
 	  free (result->fake_loc_cu);
 	  free (result);
@@ -267,10 +278,10 @@ valid_p (Dwarf *result)
 	  result->fake_loclists_cu->endp
 	    = (result->sectiondata[IDX_debug_loclists]->d_buf
 	       + result->sectiondata[IDX_debug_loclists]->d_size);
-	  result->fake_loclists_cu->locs = NULL;
 	  result->fake_loclists_cu->address_size = 0;
 	  result->fake_loclists_cu->version = 0;
 	  result->fake_loclists_cu->split = NULL;
+	  result->fake_loclists_cu->dwp_index = NULL;
 	}
     }
 
@@ -283,7 +294,7 @@ valid_p (Dwarf *result)
       result->fake_addr_cu = (Dwarf_CU *) malloc (sizeof (Dwarf_CU));
       if (unlikely (result->fake_addr_cu == NULL))
 	{
-	  Dwarf_Sig8_Hash_free (&result->sig8_hash);
+	  free_hashes (result);
 	  __libdw_seterrno (DWARF_E_NOMEM);
 	  free (result->fake_loc_cu);
 	  free (result->fake_loclists_cu);
@@ -299,15 +310,24 @@ valid_p (Dwarf *result)
 	  result->fake_addr_cu->endp
 	    = (result->sectiondata[IDX_debug_addr]->d_buf
 	       + result->sectiondata[IDX_debug_addr]->d_size);
-	  result->fake_addr_cu->locs = NULL;
 	  result->fake_addr_cu->address_size = 0;
 	  result->fake_addr_cu->version = 0;
 	  result->fake_addr_cu->split = NULL;
+	  result->fake_addr_cu->dwp_index = NULL;
 	}
     }
 
   if (result != NULL)
-    result->debugdir = __libdw_debugdir (result->elf->fildes);
+    {
+      result->debugdir = __libdw_debugdir (result->elf->fildes);
+
+      /* A DWARF package file has indexes of the unit contributions to
+	 all other sections.  */
+      result->cu_index = __libdw_read_package_index (result,
+						      IDX_debug_cu_index);
+      result->tu_index = __libdw_read_package_index (result,
+						      IDX_debug_tu_index);
+    }
 
   return result;
 }
@@ -332,7 +352,7 @@ scngrp_read (Dwarf *result, Elf *elf, size_t shstrndx, Elf_Scn *scngrp)
   GElf_Shdr *shdr = gelf_getshdr (scngrp, &shdr_mem);
   if (shdr == NULL)
     {
-      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      free_hashes (result);
       __libdw_seterrno (DWARF_E_INVALID_ELF);
       free (result);
       return NULL;
@@ -341,7 +361,7 @@ scngrp_read (Dwarf *result, Elf *elf, size_t shstrndx, Elf_Scn *scngrp)
   if ((shdr->sh_flags & SHF_COMPRESSED) != 0
       && elf_compress (scngrp, 0, 0) < 0)
     {
-      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      free_hashes (result);
       __libdw_seterrno (DWARF_E_COMPRESSED_ERROR);
       free (result);
       return NULL;
@@ -353,7 +373,7 @@ scngrp_read (Dwarf *result, Elf *elf, size_t shstrndx, Elf_Scn *scngrp)
   if (data == NULL)
     {
       /* We cannot read the section content.  Fail!  */
-      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      free_hashes (result);
       free (result);
       return NULL;
     }
@@ -369,7 +389,7 @@ scngrp_read (Dwarf *result, Elf *elf, size_t shstrndx, Elf_Scn *scngrp)
 	{
 	  /* A section group refers to a non-existing section.  Should
 	     never happen.  */
-	  Dwarf_Sig8_Hash_free (&result->sig8_hash);
+	  free_hashes (result);
 	  __libdw_seterrno (DWARF_E_INVALID_ELF);
 	  free (result);
 	  return NULL;
@@ -417,6 +437,21 @@ dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp)
       __libdw_seterrno (DWARF_E_NOMEM);
       return NULL;
     }
+  if (unlikely (Dwarf_Loc_Hash_init (&result->loc_hash, 61) < 0))
+    {
+      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      free (result);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return NULL;
+    }
+  if (unlikely (Dwarf_Loc_Hash_init (&result->loclist_hash, 11) < 0))
+    {
+      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      Dwarf_Loc_Hash_free (&result->loc_hash);
+      free (result);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return NULL;
+    }
 
   /* Fill in some values.  */
   if ((BYTE_ORDER == LITTLE_ENDIAN && ehdr->e_ident[EI_DATA] == ELFDATA2MSB)
@@ -425,6 +460,7 @@ dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp)
 
   result->elf = elf;
   result->alt_fd = -1;
+  result->dwp_fd = -1;
 
   /* Initialize the memory handling.  Initial blocks are allocated on first
      actual allocation.  */
@@ -436,8 +472,24 @@ dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp)
       __libdw_seterrno (DWARF_E_NOMEM); /* no memory.  */
       return NULL;
     }
+  if (pthread_mutex_init (&result->files_lines_lock, NULL) != 0)
+    {
+      pthread_rwlock_destroy (&result->mem_rwl);
+      free (result);
+      __libdw_seterrno (DWARF_E_NOMEM); /* no memory.  */
+      return NULL;
+    }
+  if (pthread_mutex_init (&result->abbrev_tables_lock, NULL) != 0)
+    {
+      pthread_mutex_destroy (&result->files_lines_lock);
+      pthread_rwlock_destroy (&result->mem_rwl);
+      free (result);
+      __libdw_seterrno (DWARF_E_NOMEM); /* no memory.  */
+      return NULL;
+    }
   result->mem_stacks = 0;
   result->mem_tails = NULL;
+  atomic_init (&result->srcfile_index, (uintptr_t) NULL);
 
   if (cmd == DWARF_C_READ || cmd == DWARF_C_RDWR)
     {
@@ -446,7 +498,7 @@ dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp)
       size_t shstrndx;
       if (elf_getshdrstrndx (elf, &shstrndx) != 0)
 	{
-	  Dwarf_Sig8_Hash_free (&result->sig8_hash);
+	  free_hashes (result);
 	  __libdw_seterrno (DWARF_E_INVALID_ELF);
 	  free (result);
 	  return NULL;
@@ -464,13 +516,13 @@ dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp)
     }
   else if (cmd == DWARF_C_WRITE)
     {
-      Dwarf_Sig8_Hash_free (&result->sig8_hash);
+      free_hashes (result);
       __libdw_seterrno (DWARF_E_UNIMPL);
       free (result);
       return NULL;
     }
 
-  Dwarf_Sig8_Hash_free (&result->sig8_hash);
+  free_hashes (result);
   __libdw_seterrno (DWARF_E_INVALID_CMD);
   free (result);
   return NULL;
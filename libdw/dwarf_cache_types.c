@@ -0,0 +1,59 @@
+/* Memoize the results of type queries.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwP.h"
+
+
+int
+dwarf_cache_types (Dwarf *dbg)
+{
+  if (dbg == NULL)
+    return -1;
+
+  if (dbg->type_cache)
+    return 0;
+
+  if (Dwarf_Loc_Hash_init (&dbg->peel_hash, 31) != 0)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+  if (Dwarf_Loc_Hash_init (&dbg->size_hash, 31) != 0)
+    {
+      Dwarf_Loc_Hash_free (&dbg->peel_hash);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+
+  dbg->type_cache = true;
+  return 0;
+}
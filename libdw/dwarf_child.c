@@ -33,9 +33,7 @@
 
 #include "libdwP.h"
 #include <string.h>
-
-/* Some arbitrary value not conflicting with any existing code.  */
-#define INVALID 0xffffe444
+#include "system.h"
 
 
 unsigned char *
@@ -53,65 +51,69 @@ __libdw_find_attr (Dwarf_Die *die, unsigned int search_name,
       return NULL;
     }
 
-  /* Search the name attribute.  Attribute has been checked when
-     Dwarf_Abbrev was created, we can read unchecked.  */
-  const unsigned char *attrp = abbrevp->attrp;
-  while (1)
+  /* Abbrevs from the CU abbrev hash come with their attribute name/form
+     pairs already decoded, so we can find the attribute by index.  */
+  const Dwarf_Abbrev_Attr *attrs = abbrevp->attrs;
+  if (unlikely (attrs == NULL))
     {
-      /* Get attribute name and form.  */
-      unsigned int attr_name;
-      get_uleb128_unchecked (attr_name, attrp);
-
-      unsigned int attr_form;
-      get_uleb128_unchecked (attr_form, attrp);
-
-      /* We can stop if we found the attribute with value zero.  */
-      if (attr_name == 0 && attr_form == 0)
-	break;
+      __libdw_seterrno (DWARF_E_INVALID_DWARF);
+      return NULL;
+    }
 
-      /* Is this the name attribute?  */
-      if (attr_name == search_name && search_name != INVALID)
+  unsigned int nattrs = abbrevp->nattrs;
+  unsigned int idx = 0;
+  if (search_name != INVALID_ATTR)
+    while (idx < nattrs && attrs[idx].name != search_name)
+      ++idx;
+  else
+    idx = nattrs;
+
+  /* Normally the attribute data comes from the DIE/info,
+     except for implicit_form, where it comes from the abbrev.  */
+  if (idx < nattrs && attrs[idx].form == DW_FORM_implicit_const)
+    readp = abbrevp->attrp + attrs[idx].constoff;
+  else
+    {
+      /* Jump directly to the last value with a known offset and skip
+	 over the rest of the attributes before it (if there are any).  */
+      unsigned int known = MIN (idx, abbrevp->nfixed - 1);
+      const unsigned char *endp = die->cu->endp;
+      if (unlikely (attrs[known].offset > (size_t) (endp - readp)))
 	{
-	  if (codep != NULL)
-	    *codep = attr_name;
-	  if (formp != NULL)
-	    *formp = attr_form;
-
-	  /* Normally the attribute data comes from the DIE/info,
-	     except for implicit_form, where it comes from the abbrev.  */
-	  if (attr_form == DW_FORM_implicit_const)
-	    return (unsigned char *) attrp;
-	  else
-	    return (unsigned char *) readp;
+	  __libdw_seterrno (DWARF_E_INVALID_DWARF);
+	  readp = NULL;
 	}
+      else
+	readp += attrs[known].offset;
 
-      /* Skip over the rest of this attribute (if there is any).  */
-      if (attr_form != 0)
-	{
-	  size_t len = __libdw_form_val_len (die->cu, attr_form, readp);
-	  if (unlikely (len == (size_t) -1l))
-	    {
+      for (unsigned int i = known; readp != NULL && i < idx; ++i)
+	if (attrs[i].form != 0)
+	  {
+	    size_t len = __libdw_form_val_len (die->cu, attrs[i].form, readp);
+	    if (unlikely (len == (size_t) -1l))
 	      readp = NULL;
-	      break;
-	    }
-
-	  // __libdw_form_val_len will have done a bounds check.
-	  readp += len;
-
-	  // If the value is in the abbrev data, skip it.
-	  if (attr_form == DW_FORM_implicit_const)
-	    {
-	      int64_t attr_value __attribute__((__unused__));
-	      get_sleb128_unchecked (attr_value, attrp);
-	    }
-	}
+	    else
+	      // __libdw_form_val_len will have done a bounds check.
+	      readp += len;
+	  }
     }
 
-  // XXX Do we need other values?
-  if (codep != NULL)
-    *codep = INVALID;
-  if (formp != NULL)
-    *formp = INVALID;
+  /* Is this the name attribute?  */
+  if (idx < nattrs && readp != NULL)
+    {
+      if (codep != NULL)
+	*codep = attrs[idx].name;
+      if (formp != NULL)
+	*formp = attrs[idx].form;
+    }
+  else
+    {
+      // XXX Do we need other values?
+      if (codep != NULL)
+	*codep = INVALID_ATTR;
+      if (formp != NULL)
+	*formp = INVALID_ATTR;
+    }
 
   return (unsigned char *) readp;
 }
@@ -137,13 +139,14 @@ dwarf_child (Dwarf_Die *die, Dwarf_Die *result)
     return 1;
 
   /* Skip past the last attribute.  */
-  void *addr = __libdw_find_attr (die, INVALID, NULL, NULL);
+  void *addr = __libdw_find_attr (die, INVALID_ATTR, NULL, NULL);
 
   if (addr == NULL)
     return -1;
 
   /* RESULT can be the same as DIE.  So preserve what we need.  */
   struct Dwarf_CU *cu = die->cu;
+  long int pos = die->padding__;
 
   /* It's kosher (just suboptimal) to have a null entry first thing (7.5.3).
      So if this starts with ULEB128 of 0 (even with silly encoding of 0),
@@ -172,6 +175,11 @@ dwarf_child (Dwarf_Die *die, Dwarf_Die *result)
   /* Same CU as the parent.  */
   result->cu = cu;
 
+  /* If DIE came from the unit DIE index, its first child is the next
+     DIE in the index.  */
+  if (pos != 0)
+    result->padding__ = pos + 1;
+
   return 0;
 }
 INTDEF(dwarf_child)
@@ -48,7 +48,7 @@ dwarf_cu_die (Dwarf_CU *cu, Dwarf_Die *result, Dwarf_Half *versionp,
   if (versionp != NULL)
     *versionp = cu->version;
   if (abbrev_offsetp != NULL)
-    *abbrev_offsetp = cu->orig_abbrev_offset;
+    *abbrev_offsetp = cu->abbrevs->offset;
   if (address_sizep != NULL)
     *address_sizep = cu->address_size;
   if (offset_sizep != NULL)
@@ -0,0 +1,59 @@
+/* Return next sibling of DIE using the unit DIE index.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwP.h"
+
+
+int
+dwarf_die_sibling (Dwarf_Die *die, Dwarf_Die *result)
+{
+  if (die == NULL || die->cu == NULL)
+    return -1;
+
+  Dwarf_Die_Index *index = __libdw_die_index (die->cu);
+  if (index == NULL)
+    return -1;
+
+  size_t idx = __libdw_die_index_find (index, die);
+  if (idx == (size_t) -1)
+    {
+      __libdw_seterrno (DWARF_E_INVALID_DWARF);
+      return -1;
+    }
+
+  size_t sibling = index->siblings[idx];
+  if (sibling == (size_t) -1)
+    return 1;
+
+  __libdw_die_index_die (die->cu, index, sibling, result);
+  return 0;
+}
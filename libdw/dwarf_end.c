@@ -47,22 +47,30 @@ noop_free (void *arg __attribute__ ((unused)))
 }
 
 
+static void
+abbrev_table_free (void *arg)
+{
+  Dwarf_Abbrev_Table *t = (Dwarf_Abbrev_Table *) arg;
+
+  Dwarf_Abbrev_Hash_free (&t->hash);
+  pthread_mutex_destroy (&t->lock);
+}
+
+
 static void
 cu_free (void *arg)
 {
   struct Dwarf_CU *p = (struct Dwarf_CU *) arg;
 
-  tdestroy (p->locs, noop_free);
-
   /* Only free the CU internals if its not a fake CU.  */
   if(p != p->dbg->fake_loc_cu && p != p->dbg->fake_loclists_cu
      && p != p->dbg->fake_addr_cu)
     {
-      Dwarf_Abbrev_Hash_free (&p->abbrev_hash);
-
-      /* Free split dwarf one way (from skeleton to split).  */
+      /* Free split dwarf one way (from skeleton to split).  Split
+	 units from a DWARF package file are freed with the package.  */
       if (p->unit_type == DW_UT_skeleton
-	  && p->split != NULL && p->split != (void *)-1)
+	  && p->split != NULL && p->split != (void *)-1
+	  && p->split->dbg != p->dbg->dwp_dwarf)
 	{
 	  /* The fake_addr_cu might be shared, only release one.  */
 	  if (p->dbg->fake_addr_cu == p->split->dbg->fake_addr_cu)
@@ -83,18 +91,59 @@ dwarf_end (Dwarf *dwarf)
 	__libdw_destroy_frame_cache (dwarf->cfi);
 
       Dwarf_Sig8_Hash_free (&dwarf->sig8_hash);
+      Dwarf_Loc_Hash_free (&dwarf->loc_hash);
+      Dwarf_Loc_Hash_free (&dwarf->loclist_hash);
+      if (dwarf->type_cache)
+	{
+	  Dwarf_Loc_Hash_free (&dwarf->peel_hash);
+	  Dwarf_Loc_Hash_free (&dwarf->size_hash);
+	}
 
       /* The search tree for the CUs.  NB: the CU data itself is
-	 allocated separately, but the abbreviation hash tables need
-	 to be handled.  */
+	 allocated separately, but the split units need to be
+	 handled.  */
       tdestroy (dwarf->cu_tree, cu_free);
       tdestroy (dwarf->tu_tree, cu_free);
 
+      /* The DWARF package file might share our .debug_addr data.  Only
+	 end it if we found and allocated it ourselves.  */
+      if (dwarf->dwp_dwarf != NULL && dwarf->dwp_dwarf != (void *) -1)
+	{
+	  Dwarf *dwp = dwarf->dwp_dwarf;
+	  if (dwarf->fake_addr_cu != NULL
+	      && dwp->fake_addr_cu == dwarf->fake_addr_cu)
+	    {
+	      dwp->sectiondata[IDX_debug_addr] = NULL;
+	      dwp->fake_addr_cu = NULL;
+	    }
+	  if (dwarf->dwp_fd != -1)
+	    {
+	      INTUSE(dwarf_end) (dwp);
+	      close (dwarf->dwp_fd);
+	    }
+	}
+
+      /* The sorted units, if they were read in advance.  */
+      if (dwarf->cu_array != NULL)
+	Dwarf_Sig8_Hash_free (&dwarf->cu_die_hash);
+      free (dwarf->cu_array);
+
+      /* The unit indexes, if this is a DWARF package file.  */
+      __libdw_free_package_index (dwarf->cu_index);
+      __libdw_free_package_index (dwarf->tu_index);
+
+      /* Search tree for the abbreviation tables.  The tables are
+	 allocated separately, but their hash tables need to be
+	 freed.  */
+      tdestroy (dwarf->abbrev_tables, abbrev_table_free);
+      pthread_mutex_destroy (&dwarf->abbrev_tables_lock);
+
       /* Search tree for macro opcode tables.  */
       tdestroy (dwarf->macro_ops, noop_free);
 
       /* Search tree for decoded .debug_lines units.  */
       tdestroy (dwarf->files_lines, noop_free);
+      pthread_mutex_destroy (&dwarf->files_lines_lock);
 
       /* And the split Dwarf.  */
       tdestroy (dwarf->split_tree, noop_free);
@@ -144,6 +193,8 @@ dwarf_end (Dwarf *dwarf)
 	  INTUSE(dwarf_end) (dwarf->alt_dwarf);
 	  close (dwarf->alt_fd);
 	}
+      else if (dwarf->alt_shared)
+	__libdw_release_alt (dwarf->alt_dwarf);
 
       /* The cached dir we found the Dwarf ELF file in.  */
       free (dwarf->debugdir);
@@ -72,9 +72,9 @@ search_range (Dwarf_Addr low, Dwarf_Addr high,
       while (l < u)
 	{
 	  size_t idx = (l + u) / 2;
-	  if (lines->info[idx].addr < low)
+	  if (__libdw_lines_addr (lines, idx) < low)
 	    l = idx + 1;
-	  else if (lines->info[idx].addr > low)
+	  else if (__libdw_lines_addr (lines, idx) > low)
 	    u = idx;
 	  else if (lines->info[idx].end_sequence)
 	    l = idx + 1;
@@ -87,14 +87,14 @@ search_range (Dwarf_Addr low, Dwarf_Addr high,
       if (l < u)
 	{
 	  if (dwarf)
-	    for (size_t i = l; i < u && lines->info[i].addr < high; ++i)
+	    for (size_t i = l; i < u && __libdw_lines_addr (lines, i) < high; ++i)
 	      if (lines->info[i].prologue_end
-		  && add_bkpt (lines->info[i].addr, bkpts, pnbkpts) < 0)
+		  && add_bkpt (__libdw_lines_addr (lines, i), bkpts, pnbkpts) < 0)
 		return -1;
 	  if (adhoc && *pnbkpts == 0)
-	    while (++l < nlines && lines->info[l].addr < high)
+	    while (++l < nlines && __libdw_lines_addr (lines, l) < high)
 	      if (!lines->info[l].end_sequence)
-		return add_bkpt (lines->info[l].addr, bkpts, pnbkpts);
+		return add_bkpt (__libdw_lines_addr (lines, l), bkpts, pnbkpts);
 	  return *pnbkpts;
 	}
       __libdw_seterrno (DWARF_E_INVALID_DWARF);
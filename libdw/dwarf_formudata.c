@@ -97,6 +97,10 @@ __libdw_formptr (Dwarf_Attribute *attr, int sec_index,
 				   attr->cu->offset_size, &offset,
 				   sec_index, 0))
 	    return NULL;
+
+	  /* Units from a DWARF package file have offsets relative to
+	     their own contribution to the section.  */
+	  offset += __libdw_cu_dwp_offset (attr->cu, sec_index);
 	}
     }
   else if (attr->cu->version > 3)
@@ -32,9 +32,18 @@
 #endif
 
 #include <dwarf.h>
+#include <limits.h>
 #include "libdwP.h"
 
 
+/* An abbrev in an abbrev table hash together with its decoded
+   attributes.  */
+struct abbrev_block
+{
+  Dwarf_Abbrev abb;
+  Dwarf_Abbrev_Attr attrs[];
+};
+
 Dwarf_Abbrev *
 internal_function
 __libdw_getabbrev (Dwarf *dbg, struct Dwarf_CU *cu, Dwarf_Off offset,
@@ -80,53 +89,41 @@ __libdw_getabbrev (Dwarf *dbg, struct Dwarf_CU *cu, Dwarf_Off offset,
   get_uleb128 (code, abbrevp, end);
 
   /* Check whether this code is already in the hash table.  */
-  bool foundit = false;
   Dwarf_Abbrev *abb = NULL;
-  if (cu == NULL
-      || (abb = Dwarf_Abbrev_Hash_find (&cu->abbrev_hash, code)) == NULL)
-    {
-      if (result == NULL)
-	abb = libdw_typed_alloc (dbg, Dwarf_Abbrev);
-      else
-	abb = result;
-    }
-  else
+  if (cu != NULL
+      && (abb = Dwarf_Abbrev_Hash_find (&cu->abbrevs->hash, code)) != NULL)
     {
-      foundit = true;
-
       if (unlikely (abb->offset != offset))
 	{
 	  /* A duplicate abbrev code at a different offset,
 	     that should never happen.  */
-	invalid:
-	  if (! foundit)
-	    libdw_typed_unalloc (dbg, Dwarf_Abbrev);
 	  __libdw_seterrno (DWARF_E_INVALID_DWARF);
 	  return NULL;
 	}
 
       /* If the caller doesn't need the length we are done.  */
       if (lengthp == NULL)
-	goto out;
+	return abb;
     }
 
-  /* If there is already a value in the hash table we are going to
-     overwrite its content.  This must not be a problem, since the
-     content better be the same.  */
-  abb->code = code;
+  /* An abbrev already in the hash table can be in use by other
+     threads, only a new one is filled in below, once the whole
+     entry is known to be valid.  The content of an existing one
+     better be the same.  */
+  unsigned int tag;
   if (abbrevp >= end)
     goto invalid;
-  get_uleb128 (abb->tag, abbrevp, end);
+  get_uleb128 (tag, abbrevp, end);
   if (abbrevp + 1 >= end)
     goto invalid;
-  abb->has_children = *abbrevp++ == DW_CHILDREN_yes;
-  abb->attrp = (unsigned char *) abbrevp;
-  abb->offset = offset;
+  bool has_children = *abbrevp++ == DW_CHILDREN_yes;
+  const unsigned char *attrp = abbrevp;
 
   /* Skip over all the attributes and check rest of the abbrev is valid.  */
   unsigned int attrname;
   unsigned int attrform;
-  do
+  unsigned int nattrs = 0;
+  while (1)
     {
       if (abbrevp >= end)
 	goto invalid;
@@ -141,25 +138,99 @@ __libdw_getabbrev (Dwarf *dbg, struct Dwarf_CU *cu, Dwarf_Off offset,
 	    goto invalid;
 	  get_sleb128 (formval, abbrevp, end);
 	}
+
+      if (attrname == 0 && attrform == 0)
+	break;
+      ++nattrs;
     }
-  while (attrname != 0 || attrform != 0);
 
   /* Return the length to the caller if she asked for it.  */
   if (lengthp != NULL)
     *lengthp = abbrevp - start_abbrevp;
 
+  if (abb != NULL)
+    return abb;
+
+  if (cu == NULL)
+    {
+      abb = result != NULL ? result : libdw_typed_alloc (dbg, Dwarf_Abbrev);
+      abb->code = code;
+      abb->tag = tag;
+      abb->has_children = has_children;
+      abb->attrp = (unsigned char *) attrp;
+      abb->offset = offset;
+      abb->attrs = NULL;
+      abb->nattrs = nattrs;
+      abb->nfixed = 0;
+      return abb;
+    }
+
+  /* Decode the attribute name/form pairs once, so DIE attribute
+     lookups can index them directly.  The abbrev and its attributes
+     are allocated as one block, so it can be given back as a whole
+     when another thread inserted the same abbrev first.  This is
+     done before the abbrev is published in the hash table, so
+     readers in other threads always see the complete array.  */
+  size_t blocksize = (sizeof (struct abbrev_block)
+		      + (nattrs + 1) * sizeof (Dwarf_Abbrev_Attr));
+  struct abbrev_block *block = libdw_alloc (dbg, struct abbrev_block,
+					    blocksize, 1);
+  Dwarf_Abbrev_Attr *attrs = block->attrs;
+  unsigned int nfixed = 0;
+  size_t valoff = 0;
+  abbrevp = attrp;
+  for (unsigned int i = 0; i <= nattrs; ++i)
+    {
+      get_uleb128_unchecked (attrs[i].name, abbrevp);
+      get_uleb128_unchecked (attrs[i].form, abbrevp);
+      attrs[i].constoff = abbrevp - attrp;
+      if (attrs[i].form == DW_FORM_implicit_const)
+	{
+	  int64_t formval __attribute__((__unused__));
+	  get_sleb128_unchecked (formval, abbrevp);
+	}
+
+      /* The value offset is known as long as all previous forms
+	 have a fixed length.  */
+      if (nfixed == i && valoff <= UINT_MAX)
+	{
+	  attrs[i].offset = valoff;
+	  nfixed = i + 1;
+	  size_t len = (attrs[i].form == 0 ? 0
+			: __libdw_form_val_fixed_len (attrs[i].form));
+	  if (len != (size_t) -1)
+	    valoff += len;
+	  else
+	    valoff = (size_t) -1;
+	}
+      else
+	attrs[i].offset = (unsigned int) -1;
+    }
+
+  abb = &block->abb;
+  abb->code = code;
+  abb->tag = tag;
+  abb->has_children = has_children;
+  abb->attrp = (unsigned char *) attrp;
+  abb->offset = offset;
+  abb->attrs = attrs;
+  abb->nattrs = nattrs;
+  abb->nfixed = nfixed;
+
   /* Add the entry to the hash table.  */
-  if (cu != NULL && ! foundit)
-    if (Dwarf_Abbrev_Hash_insert (&cu->abbrev_hash, abb->code, abb) == -1)
-      {
-	/* The entry was already in the table, remove the one we just
-	   created and get the one already inserted.  */
-	libdw_typed_unalloc (dbg, Dwarf_Abbrev);
-	abb = Dwarf_Abbrev_Hash_find (&cu->abbrev_hash, code);
-      }
-
- out:
+  if (Dwarf_Abbrev_Hash_insert (&cu->abbrevs->hash, code, abb) == -1)
+    {
+      /* The entry was already in the table, remove the one we just
+	 created and get the one already inserted.  */
+      libdw_unalloc (dbg, struct abbrev_block, blocksize, 1);
+      abb = Dwarf_Abbrev_Hash_find (&cu->abbrevs->hash, code);
+    }
+
   return abb;
+
+ invalid:
+  __libdw_seterrno (DWARF_E_INVALID_DWARF);
+  return NULL;
 }
 
 
@@ -171,7 +242,7 @@ dwarf_getabbrev (Dwarf_Die *die, Dwarf_Off offset, size_t *lengthp)
 
   Dwarf_CU *cu = die->cu;
   Dwarf *dbg = cu->dbg;
-  Dwarf_Off abbrev_offset = cu->orig_abbrev_offset;
+  Dwarf_Off abbrev_offset = cu->abbrevs->offset;
   Elf_Data *data = dbg->sectiondata[IDX_debug_abbrev];
   if (data == NULL)
     return NULL;
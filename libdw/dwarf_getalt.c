@@ -38,6 +38,7 @@
 #include <inttypes.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -95,6 +96,104 @@ __libdw_filepath (const char *debugdir, const char *dir, const char *file)
   return NULL;
 }
 
+/* dwz files are normally shared by many main files (all debuginfo
+   files of a package).  Keep the ones opened for Dwarfs that called
+   dwarf_share_alt in a process wide list, so each is only opened and
+   its units read once.  */
+struct shared_alt
+{
+  struct shared_alt *next;
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  Dwarf *dbg;
+  int fd;
+  unsigned int refs;
+};
+
+static struct shared_alt *shared_alts;
+static pthread_mutex_t shared_alts_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Returns the shared Dwarf for the alt file opened as FD, creating it
+   if necessary.  Takes ownership of FD on success.  */
+static Dwarf *
+get_shared_alt (int fd)
+{
+  struct stat st;
+  if (fstat (fd, &st) != 0)
+    return NULL;
+
+  Dwarf *alt = NULL;
+  pthread_mutex_lock (&shared_alts_lock);
+
+  for (struct shared_alt *sa = shared_alts; sa != NULL; sa = sa->next)
+    if (sa->dev == st.st_dev && sa->ino == st.st_ino
+	&& sa->size == st.st_size
+	&& sa->mtime.tv_sec == st.st_mtim.tv_sec
+	&& sa->mtime.tv_nsec == st.st_mtim.tv_nsec)
+      {
+	sa->refs++;
+	alt = sa->dbg;
+	close (fd);
+	goto out;
+      }
+
+  struct shared_alt *sa = malloc (sizeof *sa);
+  if (sa == NULL)
+    goto out;
+
+  alt = dwarf_begin (fd, O_RDONLY);
+  /* Read all units now, so the lookups of DW_FORM_GNU_ref_alt offsets
+     are just a binary search and don't change the CU tree.  */
+  if (alt == NULL || __libdw_index_units (alt) != 0)
+    {
+      if (alt != NULL)
+	INTUSE(dwarf_end) (alt);
+      free (sa);
+      alt = NULL;
+      goto out;
+    }
+
+  sa->dev = st.st_dev;
+  sa->ino = st.st_ino;
+  sa->size = st.st_size;
+  sa->mtime = st.st_mtim;
+  sa->dbg = alt;
+  sa->fd = fd;
+  sa->refs = 1;
+  sa->next = shared_alts;
+  shared_alts = sa;
+
+ out:
+  pthread_mutex_unlock (&shared_alts_lock);
+  return alt;
+}
+
+void
+internal_function
+__libdw_release_alt (Dwarf *alt)
+{
+  pthread_mutex_lock (&shared_alts_lock);
+
+  for (struct shared_alt **sap = &shared_alts; *sap != NULL;
+       sap = &(*sap)->next)
+    if ((*sap)->dbg == alt)
+      {
+	struct shared_alt *sa = *sap;
+	if (--sa->refs == 0)
+	  {
+	    *sap = sa->next;
+	    INTUSE(dwarf_end) (sa->dbg);
+	    close (sa->fd);
+	    free (sa);
+	  }
+	break;
+      }
+
+  pthread_mutex_unlock (&shared_alts_lock);
+}
+
 static void
 find_debug_altlink (Dwarf *dbg)
 {
@@ -149,9 +248,21 @@ find_debug_altlink (Dwarf *dbg)
 
   if (fd >= 0)
     {
-      Dwarf *alt = dwarf_begin (fd, O_RDONLY);
+      Dwarf *alt = dbg->share_alt ? get_shared_alt (fd) : NULL;
+      if (alt != NULL)
+	{
+	  dbg->alt_dwarf = alt;
+	  dbg->alt_shared = true;
+	  return;
+	}
+
+      /* Use a private copy.  Read all its units now too, so the lookups
+	 of DW_FORM_GNU_ref_alt offsets don't have to search the CU tree.
+	 If that fails they still work, just slower.  */
+      alt = dwarf_begin (fd, O_RDONLY);
       if (alt != NULL)
 	{
+	  (void) __libdw_index_units (alt);
 	  dbg->alt_dwarf = alt;
 	  dbg->alt_fd = fd;
 	}
@@ -0,0 +1,120 @@
+/* Retrieves the DWARF descriptor of the DWARF package file.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwP.h"
+#include "libelfP.h"
+#include "system.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+
+static int
+try_dwp_file (Dwarf *dbg, const char *path)
+{
+  int fd = TEMP_FAILURE_RETRY (open (path, O_RDONLY));
+  if (fd < 0)
+    return -1;
+
+  /* It is only a package file if it has a unit index.  */
+  Dwarf *dwp = INTUSE(dwarf_begin) (fd, DWARF_C_READ);
+  if (dwp == NULL || dwp->cu_index == NULL)
+    {
+      INTUSE(dwarf_end) (dwp);
+      close (fd);
+      return -1;
+    }
+
+  dbg->dwp_dwarf = dwp;
+  dbg->dwp_fd = fd;
+  return 0;
+}
+
+static void
+find_dwp_file (Dwarf *dbg)
+{
+  /* The package file is named like the file we came from plus .dwp.
+     For separate debuginfo files also try without the .debug suffix.
+     We only know our own file name if we were opened from a file.  */
+  if (dbg->elf->fildes < 0)
+    return;
+
+  /* strlen ("/proc/self/fd/") = 14 + strlen (<MAXINT>) = 10 + 1 = 25.  */
+  char devfdpath[25];
+  sprintf (devfdpath, "/proc/self/fd/%u", dbg->elf->fildes);
+  char *path = realpath (devfdpath, NULL);
+  if (path == NULL)
+    return;
+
+  size_t len = strlen (path);
+  char *dwp_path = malloc (len + sizeof ".dwp");
+  if (dwp_path != NULL)
+    {
+      strcpy (mempcpy (dwp_path, path, len), ".dwp");
+      if (try_dwp_file (dbg, dwp_path) != 0
+	  && len > strlen (".debug")
+	  && strcmp (path + len - strlen (".debug"), ".debug") == 0)
+	{
+	  strcpy (dwp_path + len - strlen (".debug"), ".dwp");
+	  try_dwp_file (dbg, dwp_path);
+	}
+      free (dwp_path);
+    }
+  free (path);
+}
+
+Dwarf *
+dwarf_getdwp (Dwarf *main)
+{
+  /* Only try once.  */
+  if (main == NULL || main->dwp_dwarf == (void *) -1)
+    return NULL;
+
+  if (main->dwp_dwarf != NULL)
+    return main->dwp_dwarf;
+
+  find_dwp_file (main);
+
+  /* If we found nothing, make sure we don't try again.  */
+  if (main->dwp_dwarf == NULL)
+    {
+      main->dwp_dwarf = (void *) -1;
+      return NULL;
+    }
+
+  return main->dwp_dwarf;
+}
+INTDEF (dwarf_getdwp)
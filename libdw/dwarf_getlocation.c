@@ -119,11 +119,42 @@ loc_compare (const void *p1, const void *p2)
   return 0;
 }
 
+/* Find the decoded location expression at ADDR in the cache of DBG, or
+   in the search tree CACHE if DBG is NULL.  */
+static void *
+find_loc (Dwarf *dbg, void **cache, const void *addr)
+{
+  if (dbg != NULL)
+    return Dwarf_Loc_Hash_find (&dbg->loc_hash, (uintptr_t) addr);
+
+  struct loc_s fake = { .addr = (void *) addr };
+  struct loc_s **found = tfind (&fake, cache, loc_compare);
+  return found != NULL ? *found : NULL;
+}
+
+/* Add LOC to the cache of DBG, or to the search tree CACHE if DBG is
+   NULL.  Returns the entry now in the cache, which is not LOC if another
+   thread added the same one first, or NULL if we ran out of memory.  */
+static void *
+add_loc (Dwarf *dbg, void **cache, struct loc_s *loc)
+{
+  if (dbg != NULL)
+    {
+      if (Dwarf_Loc_Hash_insert (&dbg->loc_hash, (uintptr_t) loc->addr,
+				 loc) == 0)
+	return loc;
+      return Dwarf_Loc_Hash_find (&dbg->loc_hash, (uintptr_t) loc->addr);
+    }
+
+  struct loc_s **found = tsearch (loc, cache, loc_compare);
+  return found != NULL ? *found : NULL;
+}
+
 /* For each DW_OP_implicit_value, we store a special entry in the cache.
    This points us directly to the block data for later fetching.
-   Returns zero on success, -1 on bad DWARF or 1 if tsearch failed.  */
+   Returns zero on success, -1 on bad DWARF or 1 if adding it failed.  */
 static int
-store_implicit_value (Dwarf *dbg, void **cache, Dwarf_Op *op)
+store_implicit_value (Dwarf *dbg, Dwarf_Op *op)
 {
   if (dbg == NULL)
     return -1;
@@ -136,7 +167,7 @@ store_implicit_value (Dwarf *dbg, void **cache, Dwarf_Op *op)
   block->addr = op;
   block->data = (unsigned char *) data;
   block->length = op->number;
-  if (unlikely (tsearch (block, cache, loc_compare) == NULL))
+  if (unlikely (add_loc (dbg, NULL, (struct loc_s *) block) == NULL))
     return 1;
   return 0;
 }
@@ -148,16 +179,15 @@ dwarf_getlocation_implicit_value (Dwarf_Attribute *attr, const Dwarf_Op *op,
   if (attr == NULL)
     return -1;
 
-  struct loc_block_s fake = { .addr = (void *) op };
-  struct loc_block_s **found = tfind (&fake, &attr->cu->locs, loc_compare);
+  struct loc_block_s *found = find_loc (attr->cu->dbg, NULL, op);
   if (unlikely (found == NULL))
     {
       __libdw_seterrno (DWARF_E_NO_BLOCK);
       return -1;
     }
 
-  return_block->length = (*found)->length;
-  return_block->data = (*found)->data;
+  return_block->length = found->length;
+  return_block->data = found->data;
   return 0;
 }
 
@@ -188,8 +218,7 @@ check_constant_offset (Dwarf_Attribute *attr,
     }
 
   /* Check whether we already cached this location.  */
-  struct loc_s fake = { .addr = attr->valp };
-  struct loc_s **found = tfind (&fake, &attr->cu->locs, loc_compare);
+  struct loc_s *found = find_loc (attr->cu->dbg, NULL, attr->valp);
 
   if (found == NULL)
     {
@@ -213,14 +242,19 @@ check_constant_offset (Dwarf_Attribute *attr,
       newp->loc = result;
       newp->nloc = 1;
 
-      found = tsearch (newp, &attr->cu->locs, loc_compare);
+      found = add_loc (attr->cu->dbg, NULL, newp);
+      if (found == NULL)
+	{
+	  __libdw_seterrno (DWARF_E_NOMEM);
+	  return -1;
+	}
     }
 
-  assert ((*found)->nloc == 1);
+  assert (found->nloc == 1);
 
   if (llbuf != NULL)
     {
-      *llbuf = (*found)->loc;
+      *llbuf = found->loc;
       *listlen = 1;
     }
 
@@ -243,13 +277,12 @@ __libdw_intern_expression (Dwarf *dbg, bool other_byte_order,
     }
 
   /* Check whether we already looked at this list.  */
-  struct loc_s fake = { .addr = block->data };
-  struct loc_s **found = tfind (&fake, cache, loc_compare);
+  struct loc_s *found = find_loc (dbg, cache, block->data);
   if (found != NULL)
     {
       /* We already saw it.  */
-      *llbuf = (*found)->loc;
-      *listlen = (*found)->nloc;
+      *llbuf = found->loc;
+      *listlen = found->nloc;
 
       if (valuep)
 	{
@@ -598,7 +631,7 @@ __libdw_intern_expression (Dwarf *dbg, bool other_byte_order,
 
       if (result[n].atom == DW_OP_implicit_value)
 	{
-	  int store = store_implicit_value (dbg, cache, &result[n]);
+	  int store = store_implicit_value (dbg, &result[n]);
 	  if (unlikely (store != 0))
 	    {
 	      if (store < 0)
@@ -632,7 +665,14 @@ __libdw_intern_expression (Dwarf *dbg, bool other_byte_order,
   newp->addr = block->data;
   newp->loc = result;
   newp->nloc = *listlen;
-  (void) tsearch (newp, cache, loc_compare);
+  found = add_loc (dbg, cache, newp);
+  if (found != NULL && found != newp)
+    {
+      /* Another thread was faster, use its result.  Ours just stays
+	 unused until dwarf_end.  */
+      *llbuf = found->loc;
+      *listlen = found->nloc;
+    }
 
   /* We did it.  */
   return 0;
@@ -654,7 +694,7 @@ getlocation (struct Dwarf_CU *cu, const Dwarf_Block *block,
 				    cu->address_size, (cu->version == 2
 						       ? cu->address_size
 						       : cu->offset_size),
-				    &cu->locs, block,
+				    NULL, block,
 				    false, false,
 				    llbuf, listlen, sec_index);
 }
@@ -863,6 +903,221 @@ getlocations_addr (Dwarf_Attribute *attr, ptrdiff_t offset,
   return readp - (unsigned char *) locs->d_buf;
 }
 
+/* All entries of a location list, decoded at once.  The same encoding
+   can be used by several CUs, with possibly different base addresses.
+   The hash table has the list of the first CU, NEXT chains the ones
+   of the other CUs.  */
+struct loclist_s
+{
+  void *addr;
+  Dwarf_CU *cu;
+  atomic_uintptr_t next;
+  Dwarf_Location_Entry *entries;
+  size_t nentries;
+  Dwarf_Location_Entry entries_mem[];
+};
+
+/* Find the cached location list for the encoding at ADDR in CU.  */
+static struct loclist_s *
+find_loclist (Dwarf_CU *cu, void *addr)
+{
+  struct loclist_s *list = Dwarf_Loc_Hash_find (&cu->dbg->loclist_hash,
+						(uintptr_t) addr);
+  while (list != NULL && list->cu != cu)
+    list = (struct loclist_s *) atomic_load_explicit (&list->next,
+						      memory_order_acquire);
+  return list;
+}
+
+/* Add a location list with the NENTRIES ENTRIES for the encoding at
+   ADDR in CU to the cache.  Returns NULL if we ran out of memory.  */
+static struct loclist_s *
+add_loclist (Dwarf_CU *cu, void *addr, const Dwarf_Location_Entry *entries,
+	     size_t nentries)
+{
+  Dwarf *dbg = cu->dbg;
+  size_t size = (sizeof (struct loclist_s)
+		 + nentries * sizeof (Dwarf_Location_Entry));
+  struct loclist_s *list = libdw_alloc (dbg, struct loclist_s, size, 1);
+  list->addr = addr;
+  list->cu = cu;
+  atomic_init (&list->next, (uintptr_t) NULL);
+  list->nentries = nentries;
+  list->entries = list->entries_mem;
+  memcpy (list->entries, entries, nentries * sizeof entries[0]);
+
+  if (Dwarf_Loc_Hash_insert (&dbg->loclist_hash, (uintptr_t) addr, list) == 0)
+    return list;
+
+  /* Another thread was faster, or the same list was used in another
+     CU.  In the latter case chain ours to the end of the lists of the
+     other CUs.  */
+  struct loclist_s *found = Dwarf_Loc_Hash_find (&dbg->loclist_hash,
+						 (uintptr_t) addr);
+  if (found == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return NULL;
+    }
+  while (found->cu != cu)
+    {
+      uintptr_t next = (uintptr_t) NULL;
+      if (atomic_compare_exchange_strong_explicit (&found->next, &next,
+						   (uintptr_t) list,
+						   memory_order_acq_rel,
+						   memory_order_acquire))
+	return list;
+      found = (struct loclist_s *) next;
+    }
+
+  /* Another thread added the list of this CU first, drop ours.  */
+  libdw_unalloc (dbg, struct loclist_s, size, 1);
+  return found;
+}
+
+/* Get all entries of the location list of ATTR, a true loclistptr,
+   decoding them if they are not cached yet.  */
+static struct loclist_s *
+getloclist (Dwarf_Attribute *attr)
+{
+  Dwarf_CU *cu = attr->cu;
+  ptrdiff_t off;
+  if (initial_offset (attr, &off) != 0)
+    return NULL;
+
+  size_t secidx = cu->version < 5 ? IDX_debug_loc : IDX_debug_loclists;
+  const Elf_Data *d = cu->dbg->sectiondata[secidx];
+  if (d == NULL)
+    {
+      __libdw_seterrno (secidx == IDX_debug_loc
+			? DWARF_E_NO_DEBUG_LOC
+			: DWARF_E_NO_DEBUG_LOCLISTS);
+      return NULL;
+    }
+
+  void *addr = d->d_buf + off;
+  struct loclist_s *found = find_loclist (cu, addr);
+  if (found != NULL)
+    return found;
+
+  Dwarf_Addr base = __libdw_cu_base_address (cu);
+  if (base == (Dwarf_Addr) -1)
+    return NULL;
+
+  /* Location lists are usually short, so normally we don't need to
+     malloc anything.  */
+#define MAX_STACK_ENTRIES 64
+  Dwarf_Location_Entry stack_entries[MAX_STACK_ENTRIES];
+  Dwarf_Location_Entry *entries = stack_entries;
+  size_t maxentries = MAX_STACK_ENTRIES;
+  size_t nentries = 0;
+  Dwarf_Location_Entry entry;
+  while ((entry.expr = NULL,
+	  off = getlocations_addr (attr, off, &base, &entry.start, &entry.end,
+				   (Dwarf_Word) -1, d, &entry.expr,
+				   &entry.exprlen)) > 0)
+    {
+      if (nentries == maxentries)
+	{
+	  maxentries *= 2;
+	  Dwarf_Location_Entry *newp;
+	  if (entries == stack_entries)
+	    {
+	      newp = malloc (maxentries * sizeof entries[0]);
+	      if (newp != NULL)
+		memcpy (newp, entries, nentries * sizeof entries[0]);
+	    }
+	  else
+	    newp = realloc (entries, maxentries * sizeof entries[0]);
+	  if (newp == NULL)
+	    {
+	      __libdw_seterrno (DWARF_E_NOMEM);
+	      off = -1;
+	      break;
+	    }
+	  entries = newp;
+	}
+      entries[nentries++] = entry;
+    }
+
+  struct loclist_s *list = NULL;
+  if (off == 0)
+    list = add_loclist (cu, addr, entries, nentries);
+
+  if (entries != stack_entries)
+    free (entries);
+  return list;
+}
+
+/* Get a location list of one entry covering everything for ATTR, which
+   has a single location description EXPR of EXPRLEN operations.  */
+static struct loclist_s *
+getsingleloc (Dwarf_Attribute *attr, Dwarf_Op *expr, size_t exprlen)
+{
+  struct loclist_s *found = find_loclist (attr->cu, attr->valp);
+  if (found != NULL)
+    return found;
+
+  Dwarf_Location_Entry entry =
+    {
+      .start = 0,
+      .end = -1,
+      .expr = exprlen != 0 ? expr : NULL,
+      .exprlen = exprlen
+    };
+  return add_loclist (attr->cu, attr->valp, &entry, 1);
+}
+
+int
+dwarf_getlocation_entries (Dwarf_Attribute *attr,
+			   Dwarf_Location_Entry **entries, size_t *nentries)
+{
+  if (! attr_ok (attr))
+    return -1;
+
+  /* If it has a block form, it's a single location expression.
+     Except for DW_FORM_data16, which is a 128bit constant.  */
+  struct loclist_s *list;
+  Dwarf_Op *expr;
+  size_t exprlen;
+  Dwarf_Block block;
+  if (attr->form != DW_FORM_data16
+      && INTUSE(dwarf_formblock) (attr, &block) == 0)
+    {
+      if (getlocation (attr->cu, &block, &expr, &exprlen,
+		       cu_sec_idx (attr->cu)) != 0)
+	return -1;
+      list = getsingleloc (attr, expr, exprlen);
+    }
+  else
+    {
+      if (attr->form != DW_FORM_data16)
+	{
+	  int error = INTUSE(dwarf_errno) ();
+	  if (unlikely (error != DWARF_E_NO_BLOCK))
+	    {
+	      __libdw_seterrno (error);
+	      return -1;
+	    }
+	}
+
+      int result = check_constant_offset (attr, &expr, &exprlen);
+      if (result < 0)
+	return -1;
+      if (result == 0)
+	list = getsingleloc (attr, expr, exprlen);
+      else
+	list = getloclist (attr);
+    }
+
+  if (list == NULL)
+    return -1;
+
+  *entries = list->entries;
+  *nentries = list->nentries;
+  return 0;
+}
+
 int
 dwarf_getlocation_addr (Dwarf_Attribute *attr, Dwarf_Addr address,
 			Dwarf_Op **llbufs, size_t *listlens, size_t maxlocs)
@@ -881,8 +1136,9 @@ dwarf_getlocation_addr (Dwarf_Attribute *attr, Dwarf_Addr address,
     {
       if (maxlocs == 0)
 	return 0;
-      if (llbufs != NULL &&
-	  getlocation (attr->cu, &block, &llbufs[0], &listlens[0],
+      if (llbufs == NULL)
+	return block.length == 0 ? 0 : 1;
+      if (getlocation (attr->cu, &block, &llbufs[0], &listlens[0],
 		       cu_sec_idx (attr->cu)) != 0)
 	return -1;
       return listlens[0] == 0 ? 0 : 1;
@@ -898,17 +1154,52 @@ dwarf_getlocation_addr (Dwarf_Attribute *attr, Dwarf_Addr address,
 	}
     }
 
-  int result = check_constant_offset (attr, llbufs, listlens);
+  Dwarf_Op *const_expr;
+  size_t const_len;
+  int result = check_constant_offset (attr, &const_expr, &const_len);
   if (result != 1)
-    return result ?: 1;
+    {
+      if (result == 0 && llbufs != NULL && maxlocs > 0)
+	{
+	  llbufs[0] = const_expr;
+	  listlens[0] = const_len;
+	}
+      return result ?: 1;
+    }
+
+  size_t got = 0;
+
+  /* This is a true loclistptr.  Normally we decode the whole list once
+     and look at the cached entries after that.  If that fails we fall
+     back to just decoding the entries up to the ones we want, which
+     might not run into the same problem.  */
+  struct loclist_s *list = getloclist (attr);
+  if (list != NULL)
+    {
+      for (size_t i = 0; got < maxlocs && i < list->nentries; ++i)
+	{
+	  Dwarf_Location_Entry *entry = &list->entries[i];
+	  if (address != (Dwarf_Word) -1
+	      && (address < entry->start || address >= entry->end))
+	    continue;
+
+	  /* This one matches the address.  */
+	  if (llbufs != NULL)
+	    {
+	      llbufs[got] = entry->expr;
+	      listlens[got] = entry->exprlen;
+	    }
+	  ++got;
+	}
+      return got;
+    }
 
   Dwarf_Addr base, start, end;
   Dwarf_Op *expr;
   size_t expr_len;
   ptrdiff_t off = 0;
-  size_t got = 0;
 
-  /* This is a true loclistptr, fetch the initial base address and offset.  */
+  /* Fetch the initial base address and offset.  */
   base = __libdw_cu_base_address (attr->cu);
   if (base == (Dwarf_Addr) -1)
     return -1;
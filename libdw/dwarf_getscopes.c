@@ -1,5 +1,5 @@
 /* Return scope DIEs containing PC address.
-   Copyright (C) 2005, 2007, 2015 Red Hat, Inc.
+   Copyright (C) 2005, 2007, 2015, 2026 Red Hat, Inc.
    This file is part of elfutils.
 
    This file is free software; you can redistribute it and/or modify
@@ -32,6 +32,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include "libdwP.h"
 #include <dwarf.h>
 
@@ -182,12 +183,435 @@ pc_record (unsigned int depth, struct Dwarf_Die_Chain *die, void *arg)
 }
 
 
+/* Index from addresses to the scopes of a unit.  Only scopes that have
+   address ranges, and of which all containing scopes have address
+   ranges, can ever match a PC, so only those are recorded.  */
+struct Dwarf_Scope_Index
+{
+  /* The scopes in the order __libdw_visit_scopes visits them.  */
+  size_t nscopes;
+  struct scope_node
+  {
+    Dwarf_Die die;
+    /* Index of the containing scope, (size_t) -1 for the unit DIE.  */
+    size_t parent;
+    unsigned int depth;
+  } *scopes;
+
+  /* All address ranges of the scopes sorted by start address.  MAXEND
+     is the highest end address of the ranges in the (implicit) subtree
+     that has this range in the middle, see collect_scopes.  */
+  size_t nranges;
+  struct scope_range
+  {
+    Dwarf_Addr start;
+    Dwarf_Addr end;
+    Dwarf_Addr maxend;
+    size_t scope;
+  } *ranges;
+};
+
+struct index_args
+{
+  struct scope_node *scopes;
+  size_t nscopes;
+  size_t maxscopes;
+  struct scope_range *ranges;
+  size_t nranges;
+  size_t maxranges;
+  /* Scope index of the (non-pruned) DIE at each depth.  */
+  size_t *stack;
+  unsigned int maxdepth;
+};
+
+/* Preorder visitor: record the DIE and its ranges, prune it if it has
+   no ranges.  */
+static int
+index_scope (unsigned int depth, struct Dwarf_Die_Chain *die, void *arg)
+{
+  struct index_args *a = arg;
+
+  if (depth >= a->maxdepth)
+    {
+      unsigned int maxdepth = 2 * depth;
+      size_t *stack = realloc (a->stack, maxdepth * sizeof (size_t));
+      if (stack == NULL)
+	goto nomem;
+      a->stack = stack;
+      a->maxdepth = maxdepth;
+    }
+
+  size_t scope = a->nscopes;
+  size_t nranges = a->nranges;
+  Dwarf_Addr base;
+  Dwarf_Addr begin;
+  Dwarf_Addr end;
+  ptrdiff_t offset = 0;
+  while ((offset = INTUSE(dwarf_ranges) (&die->die, offset, &base,
+					 &begin, &end)) > 0)
+    {
+      if (begin >= end)
+	continue;
+
+      if (a->nranges == a->maxranges)
+	{
+	  size_t maxranges = a->maxranges == 0 ? 64 : 2 * a->maxranges;
+	  struct scope_range *ranges = realloc (a->ranges,
+						maxranges * sizeof ranges[0]);
+	  if (ranges == NULL)
+	    goto nomem;
+	  a->ranges = ranges;
+	  a->maxranges = maxranges;
+	}
+
+      a->ranges[a->nranges++] = (struct scope_range)
+	{ .start = begin, .end = end, .scope = scope };
+    }
+
+  /* Just like pc_match, treat a DIE without appropriate attributes as
+     not matching.  */
+  if (offset < 0)
+    {
+      int error = INTUSE(dwarf_errno) ();
+      if (error != DWARF_E_NOERROR
+	  && error != DWARF_E_NO_DEBUG_RANGES
+	  && error != DWARF_E_NO_DEBUG_RNGLISTS)
+	{
+	  __libdw_seterrno (error);
+	  return -1;
+	}
+    }
+
+  if (a->nranges == nranges)
+    {
+      die->prune = true;
+      return 0;
+    }
+
+  if (a->nscopes == a->maxscopes)
+    {
+      size_t maxscopes = a->maxscopes == 0 ? 64 : 2 * a->maxscopes;
+      struct scope_node *scopes = realloc (a->scopes,
+					   maxscopes * sizeof scopes[0]);
+      if (scopes == NULL)
+	goto nomem;
+      a->scopes = scopes;
+      a->maxscopes = maxscopes;
+    }
+
+  a->scopes[a->nscopes++] = (struct scope_node)
+    {
+      .die = die->die,
+      .parent = depth > 1 ? a->stack[depth - 1] : (size_t) -1,
+      .depth = depth
+    };
+  a->stack[depth] = scope;
+  return 0;
+
+ nomem:
+  __libdw_seterrno (DWARF_E_NOMEM);
+  return -1;
+}
+
+static int
+compare_ranges (const void *p1, const void *p2)
+{
+  const struct scope_range *r1 = p1;
+  const struct scope_range *r2 = p2;
+
+  if (r1->start < r2->start)
+    return -1;
+  if (r1->start > r2->start)
+    return 1;
+  return 0;
+}
+
+/* Set MAXEND of the middle range of RANGES[LO, HI) and return it.  */
+static Dwarf_Addr
+set_maxend (struct scope_range *ranges, size_t lo, size_t hi)
+{
+  if (lo >= hi)
+    return 0;
+
+  size_t mid = (lo + hi) / 2;
+  Dwarf_Addr maxend = ranges[mid].end;
+  Dwarf_Addr left = set_maxend (ranges, lo, mid);
+  Dwarf_Addr right = set_maxend (ranges, mid + 1, hi);
+  if (left > maxend)
+    maxend = left;
+  if (right > maxend)
+    maxend = right;
+  return ranges[mid].maxend = maxend;
+}
+
+/* Get the scope index of the unit, building it if not yet done.  */
+static struct Dwarf_Scope_Index *
+scope_index (Dwarf_Die *cudie)
+{
+  Dwarf_CU *cu = cudie->cu;
+  struct Dwarf_Scope_Index *index
+    = (struct Dwarf_Scope_Index *) atomic_load_explicit (&cu->scope_index,
+							 memory_order_acquire);
+  if (index != NULL)
+    return index;
+
+  struct index_args a = { .maxdepth = 0 };
+  struct Dwarf_Die_Chain root = { .parent = NULL, .die = *cudie };
+  if (__libdw_visit_scopes (0, &root, NULL, &index_scope, NULL, &a) == 0)
+    {
+      /* Allocate the index and both arrays in one block, so it can
+	 be given back as a whole.  */
+      Dwarf *dbg = cu->dbg;
+      size_t size = (sizeof (struct Dwarf_Scope_Index)
+		     + a.nscopes * sizeof (struct scope_node)
+		     + a.nranges * sizeof (struct scope_range));
+      index = libdw_alloc (dbg, struct Dwarf_Scope_Index, size, 1);
+      index->nscopes = a.nscopes;
+      index->scopes = (struct scope_node *) (index + 1);
+      memcpy (index->scopes, a.scopes, a.nscopes * sizeof a.scopes[0]);
+
+      qsort (a.ranges, a.nranges, sizeof a.ranges[0], compare_ranges);
+      set_maxend (a.ranges, 0, a.nranges);
+      index->nranges = a.nranges;
+      index->ranges = (struct scope_range *) (index->scopes + a.nscopes);
+      memcpy (index->ranges, a.ranges, a.nranges * sizeof a.ranges[0]);
+
+      /* Publish the complete index.  If another thread was faster,
+	 use that one.  */
+      uintptr_t expected = (uintptr_t) NULL;
+      if (! atomic_compare_exchange_strong_explicit (&cu->scope_index,
+						     &expected,
+						     (uintptr_t) index,
+						     memory_order_release,
+						     memory_order_acquire))
+	{
+	  libdw_unalloc (dbg, struct Dwarf_Scope_Index, size, 1);
+	  index = (struct Dwarf_Scope_Index *) expected;
+	}
+    }
+
+  free (a.scopes);
+  free (a.ranges);
+  free (a.stack);
+  return index;
+}
+
+struct found_scopes
+{
+  size_t *scopes;
+  size_t nscopes;
+  size_t maxscopes;
+};
+
+/* Collect the scopes of all ranges in RANGES[LO, HI) containing PC.
+   RANGES[LO, HI) is an implicit binary search tree with the middle
+   range at the root, so this takes O(log n) plus the matches.  */
+static int
+collect_scopes (const struct scope_range *ranges, size_t lo, size_t hi,
+		Dwarf_Addr pc, struct found_scopes *found)
+{
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      if (ranges[mid].maxend <= pc)
+	return 0;
+
+      if (collect_scopes (ranges, lo, mid, pc, found) != 0)
+	return -1;
+
+      /* All other ranges start at or after this one.  */
+      if (ranges[mid].start > pc)
+	return 0;
+
+      if (pc < ranges[mid].end)
+	{
+	  if (found->nscopes == found->maxscopes)
+	    {
+	      size_t maxscopes = found->maxscopes == 0 ? 16
+				 : 2 * found->maxscopes;
+	      size_t *scopes = realloc (found->scopes,
+					maxscopes * sizeof (size_t));
+	      if (scopes == NULL)
+		{
+		  __libdw_seterrno (DWARF_E_NOMEM);
+		  return -1;
+		}
+	      found->scopes = scopes;
+	      found->maxscopes = maxscopes;
+	    }
+	  found->scopes[found->nscopes++] = ranges[mid].scope;
+	}
+
+      lo = mid + 1;
+    }
+
+  return 0;
+}
+
+static int
+compare_scopes (const void *p1, const void *p2)
+{
+  size_t s1 = *(const size_t *) p1;
+  size_t s2 = *(const size_t *) p2;
+
+  return s1 < s2 ? -1 : s1 > s2;
+}
+
+/* Same as the traversal of dwarf_getscopes, but using the scope index
+   of the unit of CUDIE to find the scopes containing PC.  */
+static int
+getscopes_indexed (Dwarf_Die *cudie, struct Dwarf_Scope_Index *index,
+		   Dwarf_Addr pc, Dwarf_Die **scopes)
+{
+  struct found_scopes found = { .nscopes = 0 };
+  if (collect_scopes (index->ranges, 0, index->nranges, pc, &found) != 0)
+    {
+      free (found.scopes);
+      return -1;
+    }
+
+  /* The traversal descends into the first (in visiting order) scope
+     containing PC at each level.  Scopes are recorded in visiting order,
+     so the first match with the current innermost scope as parent is
+     that one.  Scopes of which some parent doesn't contain PC are
+     never matched.  */
+  qsort (found.scopes, found.nscopes, sizeof (size_t), compare_scopes);
+  size_t innermost = (size_t) -1;
+  for (size_t i = 0; i < found.nscopes; ++i)
+    if (index->scopes[found.scopes[i]].parent == innermost)
+      innermost = found.scopes[i];
+  free (found.scopes);
+
+  if (innermost == (size_t) -1)
+    return 0;
+
+  /* Like pc_match, remember the depth of the innermost concrete inlined
+     instance.  */
+  unsigned int depth = index->scopes[innermost].depth;
+  struct args a = { .pc = pc, .inlined = 0 };
+  for (size_t s = innermost; s != (size_t) -1; s = index->scopes[s].parent)
+    if (a.inlined == 0
+	&& INTUSE (dwarf_tag) (&index->scopes[s].die)
+	   == DW_TAG_inlined_subroutine)
+      a.inlined = index->scopes[s].depth;
+
+  /* Like pc_record, record the scopes up to the unit DIE or to the
+     concrete inlined instance.  */
+  a.nscopes = depth + 1 - a.inlined;
+  a.scopes = malloc (a.nscopes * sizeof a.scopes[0]);
+  if (a.scopes == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+
+  size_t s = innermost;
+  for (unsigned int i = 0; i < a.nscopes; ++i)
+    {
+      a.scopes[i] = s != (size_t) -1 ? index->scopes[s].die : *cudie;
+      if (s != (size_t) -1)
+	s = index->scopes[s].parent;
+    }
+
+  if (a.inlined == 0)
+    {
+      *scopes = a.scopes;
+      return a.nscopes;
+    }
+
+  Dwarf_Die *const inlinedie = &a.scopes[depth - a.inlined];
+  assert (INTUSE (dwarf_tag) (inlinedie) == DW_TAG_inlined_subroutine);
+  Dwarf_Attribute attr_mem;
+  Dwarf_Attribute *attr = INTUSE (dwarf_attr) (inlinedie,
+					       DW_AT_abstract_origin,
+					       &attr_mem);
+  if (INTUSE (dwarf_formref_die) (attr, &a.inlined_origin) == NULL)
+    {
+      free (a.scopes);
+      return -1;
+    }
+
+  /* If the abstract definition is in the same unit, the scopes that
+     contain it are its parents in the unit DIE index.  */
+  Dwarf_Die_Index *die_index = NULL;
+  if (a.inlined_origin.cu == cudie->cu)
+    die_index = __libdw_die_index (cudie->cu);
+  if (die_index != NULL)
+    {
+      Dwarf_Die *origin_scopes;
+      int norigin = __libdw_index_scopes (die_index, &a.inlined_origin,
+					  &origin_scopes);
+      if (norigin <= 0)
+	{
+	  free (a.scopes);
+	  return norigin;
+	}
+
+      /* Add the scopes containing the abstract definition, but not
+	 the definition itself, like origin_match.  */
+      unsigned int nscopes = a.nscopes + norigin - 1;
+      Dwarf_Die *newscopes = realloc (a.scopes, nscopes * sizeof a.scopes[0]);
+      if (newscopes == NULL)
+	{
+	  free (a.scopes);
+	  free (origin_scopes);
+	  __libdw_seterrno (DWARF_E_NOMEM);
+	  return -1;
+	}
+      memcpy (&newscopes[a.nscopes], &origin_scopes[1],
+	      (norigin - 1) * sizeof origin_scopes[0]);
+      free (origin_scopes);
+      *scopes = newscopes;
+      return nscopes;
+    }
+
+  /* Search the scopes containing the concrete inlined instance for the
+     abstract definition, from the innermost one out to the unit DIE.  */
+  struct Dwarf_Die_Chain *chain = malloc (a.inlined * sizeof chain[0]);
+  if (chain == NULL)
+    {
+      free (a.scopes);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+  chain[0] = (struct Dwarf_Die_Chain) { .parent = NULL, .die = *cudie };
+  for (s = index->scopes[innermost].parent; s != (size_t) -1;
+       s = index->scopes[s].parent)
+    if (index->scopes[s].depth < a.inlined)
+      chain[index->scopes[s].depth].die = index->scopes[s].die;
+  for (unsigned int d = 1; d < a.inlined; ++d)
+    chain[d].parent = &chain[d - 1];
+
+  int result = 0;
+  for (unsigned int d = a.inlined; result == 0 && d-- > 0; )
+    result = __libdw_visit_scopes (d, &chain[d], NULL, &origin_match, NULL,
+				   &a);
+  free (chain);
+
+  if (result > 0)
+    *scopes = a.scopes;
+  else if (result == 0)
+    free (a.scopes);
+
+  return result;
+}
+
+
 int
 dwarf_getscopes (Dwarf_Die *cudie, Dwarf_Addr pc, Dwarf_Die **scopes)
 {
   if (cudie == NULL)
     return -1;
 
+  /* Use the address index of the unit if we are asked about a whole
+     unit.  Fall back to the full traversal if it cannot be built.  */
+  if (is_cudie (cudie))
+    {
+      struct Dwarf_Scope_Index *index = scope_index (cudie);
+      if (index != NULL)
+	return getscopes_indexed (cudie, index, pc, scopes);
+    }
+
   struct Dwarf_Die_Chain cu = { .parent = NULL, .die = *cudie };
   struct args a = { .pc = pc };
 
@@ -65,6 +65,12 @@ dwarf_getscopes_die (Dwarf_Die *die, Dwarf_Die **scopes)
   if (die == NULL)
     return -1;
 
+  /* Follow the parents in the unit DIE index, if it can be built,
+     instead of walking the unit from the start.  */
+  Dwarf_Die_Index *index = __libdw_die_index (die->cu);
+  if (index != NULL)
+    return __libdw_index_scopes (index, die, scopes);
+
   struct Dwarf_Die_Chain cu = { .die = CUDIE (die->cu), .parent = NULL };
   void *info = die->addr;
   int result = __libdw_visit_scopes (1, &cu, NULL, &scope_visitor, NULL, &info);
@@ -51,8 +51,7 @@ dwarf_getsrc_die (Dwarf_Die *cudie, Dwarf_Addr addr)
       while (l < u)
 	{
 	  size_t idx = u - (u - l) / 2;
-	  Dwarf_Line *line = &lines->info[idx];
-	  if (addr < line->addr)
+	  if (addr < __libdw_lines_addr (lines, idx))
 	    u = idx - 1;
 	  else
 	    l = idx;
@@ -65,7 +64,7 @@ dwarf_getsrc_die (Dwarf_Die *cudie, Dwarf_Addr addr)
 	 want, unless it is the end_sequence which is after the
 	 current line sequence.  */
       Dwarf_Line *line = &lines->info[l];
-      if (! line->end_sequence && line->addr <= addr)
+      if (! line->end_sequence && __libdw_lines_addr (lines, l) <= addr)
 	return &lines->info[l];
     }
 
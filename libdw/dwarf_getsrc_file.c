@@ -1,5 +1,5 @@
 /* Find line information for given file/line/column triple.
-   Copyright (C) 2005-2009 Red Hat, Inc.
+   Copyright (C) 2005-2009, 2026 Red Hat, Inc.
    This file is part of elfutils.
    Written by Ulrich Drepper <drepper@redhat.com>, 2005.
 
@@ -39,6 +39,105 @@
 #include "libdwP.h"
 
 
+struct matches
+{
+  const char *fname;
+  bool is_basename;
+  int lineno;
+  int column;
+
+  size_t max_match;
+  size_t act_match;
+  size_t cur_match;
+  Dwarf_Line **match;
+
+  Dwarf_Files *lastfiles;
+  unsigned int lastfile;
+  bool lastmatch;
+};
+
+/* Check whether LINE matches and record it if so.  Returns -1 on
+   error.  */
+static int
+add_line (struct matches *m, Dwarf_Line *line)
+{
+  if (m->lastfiles != __libdw_line_files (line) || m->lastfile != line->file)
+    {
+      m->lastfiles = __libdw_line_files (line);
+      m->lastfile = line->file;
+      if (m->lastfile >= __libdw_line_files (line)->nfiles)
+	{
+	  __libdw_seterrno (DWARF_E_INVALID_DWARF);
+	  return -1;
+	}
+
+      /* Match the name with the name the user provided.  */
+      const char *fname2 = __libdw_line_files (line)->info[m->lastfile].name;
+      if (m->is_basename)
+	m->lastmatch = strcmp (basename (fname2), m->fname) == 0;
+      else
+	m->lastmatch = strcmp (fname2, m->fname) == 0;
+    }
+  if (!m->lastmatch)
+    return 0;
+
+  /* See whether line and possibly column match.  */
+  int lineno = m->lineno;
+  int column = m->column;
+  if (lineno != 0
+      && (lineno > line->line
+	  || (column != 0 && column > line->column)))
+    /* Cannot match.  */
+    return 0;
+
+  /* Determine whether this is the best match so far.  */
+  Dwarf_Line **match = m->match;
+  size_t inner;
+  for (inner = 0; inner < m->cur_match; ++inner)
+    if (__libdw_line_files (match[inner]) == __libdw_line_files (line)
+	&& match[inner]->file == line->file)
+      break;
+  if (inner < m->cur_match
+      && (match[inner]->line != line->line
+	  || match[inner]->line != lineno
+	  || (column != 0
+	      && (match[inner]->column != line->column
+		  || match[inner]->column != column))))
+    {
+      /* We know about this file already.  If this is a better
+	 match for the line number, use it.  */
+      if (match[inner]->line >= line->line
+	  && (match[inner]->line != line->line
+	      || match[inner]->column >= line->column))
+	/*  Use the new line.  Otherwise the old one.  */
+	match[inner] = line;
+      return 0;
+    }
+
+  if (m->cur_match < m->max_match)
+    {
+      if (m->cur_match == m->act_match)
+	{
+	  /* Enlarge the array for the results.  */
+	  m->act_match += 10;
+	  Dwarf_Line **newp = realloc (match,
+				       m->act_match
+				       * sizeof (Dwarf_Line *));
+	  if (newp == NULL)
+	    {
+	      free (match);
+	      __libdw_seterrno (DWARF_E_NOMEM);
+	      return -1;
+	    }
+	  m->match = newp;
+	}
+
+      m->match[m->cur_match++] = line;
+    }
+
+  return 0;
+}
+
 int
 dwarf_getsrc_file (Dwarf *dbg, const char *fname, int lineno, int column,
 		   Dwarf_Line ***srcsp, size_t *nsrcs)
@@ -46,129 +145,90 @@ dwarf_getsrc_file (Dwarf *dbg, const char *fname, int lineno, int column,
   if (dbg == NULL)
     return -1;
 
-  bool is_basename = strchr (fname, '/') == NULL;
-
-  size_t max_match = *nsrcs ?: ~0u;
-  size_t act_match = *nsrcs;
-  size_t cur_match = 0;
-  Dwarf_Line **match = *nsrcs == 0 ? NULL : *srcsp;
-
-  size_t cuhl;
-  Dwarf_Off noff;
-  for (Dwarf_Off off = 0;
-       INTUSE(dwarf_nextcu) (dbg, off, &noff, &cuhl, NULL, NULL, NULL) == 0;
-       off = noff)
+  struct matches m =
     {
-      Dwarf_Die cudie_mem;
-      Dwarf_Die *cudie = INTUSE(dwarf_offdie) (dbg, off + cuhl, &cudie_mem);
-      if (cudie == NULL)
-	continue;
-
-      /* Get the line number information for this file.  */
-      Dwarf_Lines *lines;
-      size_t nlines;
-      if (INTUSE(dwarf_getsrclines) (cudie, &lines, &nlines) != 0)
-	{
-	  /* Ignore a CU that just has no DW_AT_stmt_list at all.  */
-	  int error = INTUSE(dwarf_errno) ();
-	  if (error == 0)
-	    continue;
-	  __libdw_seterrno (error);
-	  return -1;
-	}
-
-      /* Search through all the line number records for a matching
-	 file and line/column number.  If any of the numbers is zero,
-	 no match is performed.  */
-      unsigned int lastfile = UINT_MAX;
-      bool lastmatch = false;
-      for (size_t cnt = 0; cnt < nlines; ++cnt)
+      .fname = fname,
+      .is_basename = strchr (fname, '/') == NULL,
+      .lineno = lineno,
+      .column = column,
+      .max_match = *nsrcs ?: ~0u,
+      .act_match = *nsrcs,
+      .cur_match = 0,
+      .match = *nsrcs == 0 ? NULL : *srcsp
+    };
+
+  Dwarf_Srcfile_Index *index
+    = (Dwarf_Srcfile_Index *) atomic_load_explicit (&dbg->srcfile_index,
+						    memory_order_acquire);
+  if (index != NULL)
+    {
+      /* Only the rows of files with the same base name can match.  They
+	 are in the same order as below, so the result is the same.  */
+      const char *name = m.is_basename ? fname : basename (fname);
+      struct Dwarf_Srcfile_Bucket *bucket
+	= __libdw_srcfile_bucket (index, name, elf_hash (name));
+      m.lastfiles = NULL;
+      for (size_t cnt = 0; cnt < bucket->nrows; ++cnt)
 	{
-	  Dwarf_Line *line = &lines->info[cnt];
+	  struct Dwarf_Srcfile_Row *row = &index->rows[bucket->first + cnt];
 
-	  if (lastfile != line->file)
-	    {
-	      lastfile = line->file;
-	      if (lastfile >= line->files->nfiles)
-		{
-		  __libdw_seterrno (DWARF_E_INVALID_DWARF);
-		  return -1;
-		}
-
-	      /* Match the name with the name the user provided.  */
-	      const char *fname2 = line->files->info[lastfile].name;
-	      if (is_basename)
-		lastmatch = strcmp (basename (fname2), fname) == 0;
-	      else
-		lastmatch = strcmp (fname2, fname) == 0;
-	    }
-	  if (!lastmatch)
-	    continue;
+	  /* If we managed to find as many matches as the user requested
+	     already, there is no need to go on to the next CU.  */
+	  if (m.cur_match == m.max_match && cnt > 0
+	      && row->unit != index->rows[bucket->first + cnt - 1].unit)
+	    break;
 
-	  /* See whether line and possibly column match.  */
-	  if (lineno != 0
-	      && (lineno > line->line
-		  || (column != 0 && column > line->column)))
-	    /* Cannot match.  */
+	  if (add_line (&m, row->line) != 0)
+	    return -1;
+	}
+    }
+  else
+    {
+      size_t cuhl;
+      Dwarf_Off noff;
+      for (Dwarf_Off off = 0;
+	   INTUSE(dwarf_nextcu) (dbg, off, &noff, &cuhl, NULL, NULL, NULL) == 0;
+	   off = noff)
+	{
+	  Dwarf_Die cudie_mem;
+	  Dwarf_Die *cudie = INTUSE(dwarf_offdie) (dbg, off + cuhl, &cudie_mem);
+	  if (cudie == NULL)
 	    continue;
 
-	  /* Determine whether this is the best match so far.  */
-	  size_t inner;
-	  for (inner = 0; inner < cur_match; ++inner)
-	    if (match[inner]->files == line->files
-		&& match[inner]->file == line->file)
-	      break;
-	  if (inner < cur_match
-	      && (match[inner]->line != line->line
-		  || match[inner]->line != lineno
-		  || (column != 0
-		      && (match[inner]->column != line->column
-			  || match[inner]->column != column))))
+	  /* Get the line number information for this file.  */
+	  Dwarf_Lines *lines;
+	  size_t nlines;
+	  if (INTUSE(dwarf_getsrclines) (cudie, &lines, &nlines) != 0)
 	    {
-	      /* We know about this file already.  If this is a better
-		 match for the line number, use it.  */
-	      if (match[inner]->line >= line->line
-		  && (match[inner]->line != line->line
-		      || match[inner]->column >= line->column))
-		/*  Use the new line.  Otherwise the old one.  */
-		match[inner] = line;
-	      continue;
+	      /* Ignore a CU that just has no DW_AT_stmt_list at all.  */
+	      int error = INTUSE(dwarf_errno) ();
+	      if (error == 0)
+		continue;
+	      __libdw_seterrno (error);
+	      return -1;
 	    }
 
-	  if (cur_match < max_match)
-	    {
-	      if (cur_match == act_match)
-		{
-		  /* Enlarge the array for the results.  */
-		  act_match += 10;
-		  Dwarf_Line **newp = realloc (match,
-					       act_match
-					       * sizeof (Dwarf_Line *));
-		  if (newp == NULL)
-		    {
-		      free (match);
-		      __libdw_seterrno (DWARF_E_NOMEM);
-		      return -1;
-		    }
-		  match = newp;
-		}
-
-	      match[cur_match++] = line;
-	    }
+	  /* Search through all the line number records for a matching
+	     file and line/column number.  If any of the numbers is zero,
+	     no match is performed.  */
+	  m.lastfiles = NULL;
+	  for (size_t cnt = 0; cnt < nlines; ++cnt)
+	    if (add_line (&m, &lines->info[cnt]) != 0)
+	      return -1;
+
+	  /* If we managed to find as many matches as the user requested
+	     already, there is no need to go on to the next CU.  */
+	  if (m.cur_match == m.max_match)
+	    break;
 	}
-
-      /* If we managed to find as many matches as the user requested
-	 already, there is no need to go on to the next CU.  */
-      if (cur_match == max_match)
-	break;
     }
 
-  if (cur_match > 0)
+  if (m.cur_match > 0)
     {
-      assert (*nsrcs == 0 || *srcsp == match);
+      assert (*nsrcs == 0 || *srcsp == m.match);
 
-      *nsrcs = cur_match;
-      *srcsp = match;
+      *nsrcs = m.cur_match;
+      *srcsp = m.match;
 
       return 0;
     }
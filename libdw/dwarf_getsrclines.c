@@ -31,6 +31,7 @@
 #endif
 
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <search.h>
@@ -45,36 +46,83 @@ struct filelist
   struct filelist *next;
 };
 
-struct linelist
+/* A line as the state machine adds it.  Until we have all lines, we
+   don't know what Dwarf_Line.addroff is relative to.  */
+struct new_line
 {
+  Dwarf_Addr addr;
   Dwarf_Line line;
-  struct linelist *next;
-  size_t sequence;
 };
 
-
-/* Compare by Dwarf_Line.addr, given pointers into an array of pointers.  */
-static int
-compare_lines (const void *a, const void *b)
+/* Whether LINE1 sorts before LINE2 by address.  */
+static inline bool
+line_before (const struct new_line *line1, const struct new_line *line2)
 {
-  struct linelist *const *p1 = a;
-  struct linelist *const *p2 = b;
-  struct linelist *list1 = *p1;
-  struct linelist *list2 = *p2;
-  Dwarf_Line *line1 = &list1->line;
-  Dwarf_Line *line2 = &list2->line;
-
   if (line1->addr != line2->addr)
-    return (line1->addr < line2->addr) ? -1 : 1;
+    return line1->addr < line2->addr;
 
   /* An end_sequence marker precedes a normal record at the same address.  */
-  if (line1->end_sequence != line2->end_sequence)
-    return line2->end_sequence - line1->end_sequence;
+  return line1->line.end_sequence > line2->line.end_sequence;
+}
+
+/* Return the end of the run of sorted lines in LINES starting at START.  */
+static inline size_t
+lines_run_end (const struct new_line *lines, size_t start, size_t nlines)
+{
+  size_t end = start + 1;
+  while (end < nlines && ! line_before (&lines[end], &lines[end - 1]))
+    ++end;
+  return end;
+}
+
+/* Merge the sorted runs LINES[LO, MID) and LINES[MID, HI) into
+   RESULT[LO, HI).  Equal lines keep their order.  */
+static void
+merge_lines (const struct new_line *lines, size_t lo, size_t mid, size_t hi,
+	     struct new_line *result)
+{
+  size_t i = lo;
+  size_t j = mid;
+  size_t k = lo;
+  while (i < mid && j < hi)
+    if (line_before (&lines[j], &lines[i]))
+      result[k++] = lines[j++];
+    else
+      result[k++] = lines[i++];
+  while (i < mid)
+    result[k++] = lines[i++];
+  while (j < hi)
+    result[k++] = lines[j++];
+}
 
-  /* Otherwise, the linelist sequence maintains a stable sort.  */
-  return (list1->sequence < list2->sequence) ? -1
-    : (list1->sequence > list2->sequence) ? 1
-    : 0;
+/* Stable sort the NLINES LINES by ascending address.  The lines of each
+   sequence normally are in order already, so just merge the runs of
+   sorted lines until there is only one.  Returns either LINES or
+   SCRATCH, whichever has the result.  */
+static struct new_line *
+sort_lines (struct new_line *lines, struct new_line *scratch, size_t nlines)
+{
+  struct new_line *src = lines;
+  struct new_line *dst = scratch;
+  size_t nruns;
+  do
+    {
+      nruns = 0;
+      for (size_t lo = 0; lo < nlines; ++nruns)
+	{
+	  size_t mid = lines_run_end (src, lo, nlines);
+	  size_t hi = mid < nlines ? lines_run_end (src, mid, nlines) : mid;
+	  merge_lines (src, lo, mid, hi, dst);
+	  lo = hi;
+	}
+
+      struct new_line *tmp = src;
+      src = dst;
+      dst = tmp;
+    }
+  while (nruns > 1);
+
+  return src;
 }
 
 struct line_state
@@ -90,8 +138,9 @@ struct line_state
   bool epilogue_begin;
   unsigned int isa;
   unsigned int discriminator;
-  struct linelist *linelist;
-  size_t nlinelist;
+  struct new_line *lines;
+  size_t nlines;
+  size_t maxlines;
   unsigned int end_sequence;
 };
 
@@ -104,30 +153,45 @@ run_advance_pc (struct line_state *state, unsigned int op_advance,
   state->op_index = (state->op_index + op_advance) % max_ops_per_instr;
 }
 
+/* Make room for more lines.  The first lines are stored in STACK.  */
+static bool
+grow_lines (struct line_state *state, struct new_line *stack)
+{
+  size_t maxlines = 2 * state->maxlines;
+  struct new_line *lines;
+  if (state->lines == stack)
+    {
+      lines = malloc (maxlines * sizeof lines[0]);
+      if (lines != NULL)
+	memcpy (lines, stack, state->nlines * sizeof lines[0]);
+    }
+  else
+    lines = realloc (state->lines, maxlines * sizeof lines[0]);
+  if (unlikely (lines == NULL))
+    return true;
+
+  state->lines = lines;
+  state->maxlines = maxlines;
+  return false;
+}
+
 static inline bool
-add_new_line (struct line_state *state, struct linelist *new_line)
+add_new_line (struct line_state *state, struct new_line *new)
 {
-  /* Set the line information.  For some fields we use bitfields,
-     so we would lose information if the encoded values are too large.
-     Check just for paranoia, and call the data "invalid" if it
-     violates our assumptions on reasonable limits for the values.  */
-  new_line->next = state->linelist;
-  new_line->sequence = state->nlinelist;
-  state->linelist = new_line;
-  ++(state->nlinelist);
+  new->addr = state->addr;
 
+  Dwarf_Line *new_line = &new->line;
   /* Set the line information.  For some fields we use bitfields,
      so we would lose information if the encoded values are too large.
      Check just for paranoia, and call the data "invalid" if it
      violates our assumptions on reasonable limits for the values.  */
 #define SET(field)						      \
   do {								      \
-     new_line->line.field = state->field;			      \
-     if (unlikely (new_line->line.field != state->field))	      \
+     new_line->field = state->field;				      \
+     if (unlikely (new_line->field != state->field))		      \
        return true;						      \
    } while (0)
 
-  SET (addr);
   SET (op_index);
   SET (file);
   SET (line);
@@ -168,8 +232,9 @@ read_srclines (Dwarf *dbg,
   /* Initial statement program state (except for stmt_list, see below).  */
   struct line_state state =
     {
-      .linelist = NULL,
-      .nlinelist = 0,
+      .lines = NULL,
+      .nlines = 0,
+      .maxlines = 0,
       .addr = 0,
       .op_index = 0,
       .file = 1,
@@ -667,18 +732,19 @@ read_srclines (Dwarf *dbg,
 
   /* Process the instructions.  */
 
-  /* Adds a new line to the matrix.  For the first MAX_STACK_LINES
-     entries just return a slot in the preallocated stack array.  */
-  struct linelist llstack[MAX_STACK_LINES];
+  /* Adds a new line to the matrix.  The first MAX_STACK_LINES entries
+     go into the preallocated stack array, after that into a malloced
+     array that grows as needed.  */
+  struct new_line linestack[MAX_STACK_LINES];
+  state.lines = linestack;
+  state.maxlines = MAX_STACK_LINES;
 #define NEW_LINE(end_seq)						\
   do {								\
-    struct linelist *ll = (state.nlinelist < MAX_STACK_LINES	\
-			   ? &llstack[state.nlinelist]		\
-			   : malloc (sizeof (struct linelist)));	\
-    if (unlikely (ll == NULL))					\
+    if (unlikely (state.nlines == state.maxlines)		\
+	&& unlikely (grow_lines (&state, linestack)))		\
       goto no_mem;						\
     state.end_sequence = end_seq;				\
-    if (unlikely (add_new_line (&state, ll)))			\
+    if (unlikely (add_new_line (&state, &state.lines[state.nlines++]))) \
       goto invalid_data;						\
   } while (0)
 
@@ -1010,51 +1076,53 @@ read_srclines (Dwarf *dbg,
     dirs[i] = dirarray[i].dir;
   dirs[ndirlist] = NULL;
 
+  /* Dwarf_Line.idx must be able to hold every index.  */
+  if (unlikely (state.nlines > UINT_MAX))
+    goto invalid_data;
+
+  /* Sort by ascending address.  */
+  struct new_line *scratch = malloc (state.nlines * sizeof scratch[0]);
+  if (unlikely (scratch == NULL) && state.nlines > 0)
+    goto no_mem;
+  struct new_line *sorted = sort_lines (state.lines, scratch, state.nlines);
+
   /* Pass the file data structure to the caller.  */
   if (filesp != NULL)
     *filesp = files;
 
   size_t buf_size = (sizeof (Dwarf_Lines)
-		     + (sizeof (Dwarf_Line) * state.nlinelist));
-  void *buf = libdw_alloc (dbg, Dwarf_Lines, buf_size, 1);
-
-  /* First use the buffer for the pointers, and sort the entries.
-     We'll write the pointers in the end of the buffer, and then
-     copy into the buffer from the beginning so the overlap works.  */
-  assert (sizeof (Dwarf_Line) >= sizeof (struct linelist *));
-  struct linelist **sortlines = (buf + buf_size
-				 - sizeof (struct linelist **) * state.nlinelist);
-
-  /* The list is in LIFO order and usually they come in clumps with
-     ascending addresses.  So fill from the back to probably start with
-     runs already in order before we sort.  */
-  struct linelist *lineslist = state.linelist;
-  for (size_t i = state.nlinelist; i-- > 0; )
-    {
-      sortlines[i] = lineslist;
-      lineslist = lineslist->next;
-    }
-  assert (lineslist == NULL);
-
-  /* Sort by ascending address.  */
-  qsort (sortlines, state.nlinelist, sizeof sortlines[0], &compare_lines);
-
-  /* Now that they are sorted, put them in the final array.
-     The buffers overlap, so we've clobbered the early elements
-     of SORTLINES by the time we're reading the later ones.  */
-  Dwarf_Lines *lines = buf;
-  lines->nlines = state.nlinelist;
-  for (size_t i = 0; i < state.nlinelist; ++i)
+		     + (sizeof (Dwarf_Line) * state.nlines));
+  Dwarf_Lines *lines = libdw_alloc (dbg, Dwarf_Lines, buf_size, 1);
+  lines->nlines = state.nlines;
+  lines->files = files;
+
+  /* Keep the addresses as offsets from the lowest one if they all fit,
+     otherwise in a separate array.  */
+  lines->addr_base = state.nlines > 0 ? sorted[0].addr : 0;
+  lines->addrs = NULL;
+  if (state.nlines > 0
+      && sorted[state.nlines - 1].addr - lines->addr_base > UINT32_MAX)
+    lines->addrs = libdw_alloc (dbg, Dwarf_Addr, sizeof (Dwarf_Addr),
+				state.nlines);
+  for (size_t i = 0; i < state.nlines; ++i)
     {
-      lines->info[i] = sortlines[i]->line;
-      lines->info[i].files = files;
+      lines->info[i] = sorted[i].line;
+      lines->info[i].idx = i;
+      if (lines->addrs != NULL)
+	{
+	  lines->addrs[i] = sorted[i].addr;
+	  lines->info[i].addroff = 0;
+	}
+      else
+	lines->info[i].addroff = sorted[i].addr - lines->addr_base;
     }
+  free (scratch);
 
   /* Make sure the highest address for the CU is marked as end_sequence.
      This is required by the DWARF spec, but some compilers forget and
      dwfl_module_getsrc depends on it.  */
-  if (state.nlinelist > 0)
-    lines->info[state.nlinelist - 1].end_sequence = 1;
+  if (state.nlines > 0)
+    lines->info[state.nlines - 1].end_sequence = 1;
 
   /* Pass the line structure back to the caller.  */
   if (linesp != NULL)
@@ -1065,12 +1133,8 @@ read_srclines (Dwarf *dbg,
 
  out:
   /* Free malloced line records, if any.  */
-  for (size_t i = MAX_STACK_LINES; i < state.nlinelist; i++)
-    {
-      struct linelist *ll = state.linelist->next;
-      free (state.linelist);
-      state.linelist = ll;
-    }
+  if (state.lines != linestack)
+    free (state.lines);
   if (dirarray != dirstack)
     free (dirarray);
   for (size_t i = MAX_STACK_FILES; i < nfilelist; i++)
@@ -1103,10 +1167,15 @@ __libdw_getsrclines (Dwarf *dbg, Dwarf_Off debug_line_offset,
 		     const char *comp_dir, unsigned address_size,
 		     Dwarf_Lines **linesp, Dwarf_Files **filesp)
 {
+  /* The search tree is protected by a lock, so dwarf_index_srcfiles can
+     decode the line tables of different units in parallel.  */
   struct files_lines_s fake = { .debug_line_offset = debug_line_offset };
+  pthread_mutex_lock (&dbg->files_lines_lock);
   struct files_lines_s **found = tfind (&fake, &dbg->files_lines,
 					files_lines_compare);
-  if (found == NULL)
+  struct files_lines_s *node = found != NULL ? *found : NULL;
+  pthread_mutex_unlock (&dbg->files_lines_lock);
+  if (node == NULL)
     {
       Elf_Data *data = __libdw_checked_get_data (dbg, IDX_debug_line);
       if (data == NULL
@@ -1117,8 +1186,7 @@ __libdw_getsrclines (Dwarf *dbg, Dwarf_Off debug_line_offset,
       const unsigned char *linep = data->d_buf + debug_line_offset;
       const unsigned char *lineendp = data->d_buf + data->d_size;
 
-      struct files_lines_s *node = libdw_alloc (dbg, struct files_lines_s,
-						sizeof *node, 1);
+      node = libdw_alloc (dbg, struct files_lines_s, sizeof *node, 1);
 
       if (read_srclines (dbg, linep, lineendp, comp_dir, address_size,
 			 &node->lines, &node->files) != 0)
@@ -1126,8 +1194,13 @@ __libdw_getsrclines (Dwarf *dbg, Dwarf_Off debug_line_offset,
 
       node->debug_line_offset = debug_line_offset;
 
+      /* If another thread inserted the same table in the meantime, we
+	 get that one back and ours just stays unused.  */
+      pthread_mutex_lock (&dbg->files_lines_lock);
       found = tsearch (node, &dbg->files_lines, files_lines_compare);
-      if (found == NULL)
+      node = found != NULL ? *found : NULL;
+      pthread_mutex_unlock (&dbg->files_lines_lock);
+      if (node == NULL)
 	{
 	  __libdw_seterrno (DWARF_E_NOMEM);
 	  return -1;
@@ -1135,10 +1208,10 @@ __libdw_getsrclines (Dwarf *dbg, Dwarf_Off debug_line_offset,
     }
 
   if (linesp != NULL)
-    *linesp = (*found)->lines;
+    *linesp = node->lines;
 
   if (filesp != NULL)
-    *filesp = (*found)->files;
+    *filesp = node->files;
 
   return 0;
 }
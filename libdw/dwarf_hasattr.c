@@ -49,29 +49,18 @@ dwarf_hasattr (Dwarf_Die *die, unsigned int search_name)
       return 0;
     }
 
-  /* Search the name attribute.  Dwarf_Abbrev was checked when created,
-     so we can read unchecked here.  */
-  const unsigned char *attrp = abbrevp->attrp;
-  while (1)
+  /* Search the name attribute in the decoded name/form pairs.  */
+  const Dwarf_Abbrev_Attr *attrs = abbrevp->attrs;
+  if (unlikely (attrs == NULL))
     {
-      /* Get attribute name and form.  */
-      unsigned int attr_name;
-      get_uleb128_unchecked (attr_name, attrp);
-      unsigned int attr_form;
-      get_uleb128_unchecked (attr_form, attrp);
-
-      /* We can stop if we found the end of the attribute list.  */
-      if (attr_name == 0 && attr_form == 0)
-	return 0;
+      __libdw_seterrno (DWARF_E_INVALID_DWARF);
+      return 0;
+    }
 
-      if (attr_name == search_name)
-	return 1;
+  for (unsigned int i = 0; i < abbrevp->nattrs; ++i)
+    if (attrs[i].name == search_name)
+      return 1;
 
-      if (attr_form == DW_FORM_implicit_const)
-	{
-	  int64_t attr_value __attribute__ ((unused));
-	  get_sleb128_unchecked (attr_value, attrp);
-	}
-    }
+  return 0;
 }
 INTDEF (dwarf_hasattr)
@@ -0,0 +1,264 @@
+/* Add address ranges of units missing from .debug_aranges.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libdwP.h"
+
+
+struct unit
+{
+  Dwarf_Die cudie;
+  bool decoded;
+  Dwarf_Arange *ranges;
+  size_t nranges;
+  int error;
+};
+
+static int
+compare_arange (const void *a, const void *b)
+{
+  const Dwarf_Arange *r1 = a, *r2 = b;
+  if (r1->addr != r2->addr)
+    return r1->addr < r2->addr ? -1 : 1;
+  return 0;
+}
+
+static int
+compare_offset (const void *a, const void *b)
+{
+  const Dwarf_Off *o1 = a, *o2 = b;
+  if (*o1 != *o2)
+    return *o1 < *o2 ? -1 : 1;
+  return 0;
+}
+
+static void
+decode_unit (struct unit *unit)
+{
+  Dwarf_Off offset = INTUSE(dwarf_dieoffset) (&unit->cudie);
+  size_t maxranges = 0;
+  ptrdiff_t off = 0;
+  Dwarf_Addr base, start, end;
+  while ((off = INTUSE(dwarf_ranges) (&unit->cudie, off, &base,
+				      &start, &end)) > 0)
+    {
+      if (start >= end)
+	continue;
+
+      if (unit->nranges == maxranges)
+	{
+	  maxranges = maxranges == 0 ? 8 : 2 * maxranges;
+	  Dwarf_Arange *newp = realloc (unit->ranges,
+					maxranges * sizeof newp[0]);
+	  if (newp == NULL)
+	    {
+	      unit->error = DWARF_E_NOMEM;
+	      break;
+	    }
+	  unit->ranges = newp;
+	}
+
+      unit->ranges[unit->nranges++] = (Dwarf_Arange) { .addr = start,
+						       .length = end - start,
+						       .offset = offset };
+    }
+
+  /* A unit with bad ranges is left out, like it would be when it has
+     no .debug_aranges entries.  */
+  if (off < 0)
+    unit->nranges = 0;
+  unit->decoded = true;
+}
+
+/* Decode the ranges of unit IDX in the UNITS array ARG, unless that
+   was already done.  Called by several threads.  */
+static void
+decode_units (void *arg, size_t idx)
+{
+  struct unit *units = arg;
+  if (! units[idx].decoded)
+    decode_unit (&units[idx]);
+}
+
+/* Merge the sorted OLD ranges and the ranges of all UNITS into a new
+   Dwarf_Aranges for DBG.  */
+static int
+merge_ranges (Dwarf *dbg, Dwarf_Aranges *old, struct unit *units,
+	      size_t nunits)
+{
+  size_t nnew = 0;
+  for (size_t u = 0; u < nunits; ++u)
+    {
+      if (units[u].error != 0)
+	{
+	  __libdw_seterrno (units[u].error);
+	  return -1;
+	}
+      nnew += units[u].nranges;
+    }
+
+  /* Nothing to add, keep what .debug_aranges gave us.  */
+  if (nnew == 0)
+    return 0;
+
+  Dwarf_Arange *ranges = malloc (nnew * sizeof ranges[0]);
+  if (ranges == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+  size_t n = 0;
+  for (size_t u = 0; u < nunits; ++u)
+    {
+      memcpy (&ranges[n], units[u].ranges,
+	      units[u].nranges * sizeof ranges[0]);
+      n += units[u].nranges;
+    }
+  qsort (ranges, nnew, sizeof ranges[0], compare_arange);
+
+  size_t nold = old != NULL ? old->naranges : 0;
+  Dwarf_Aranges *result = libdw_alloc (dbg, Dwarf_Aranges,
+				       sizeof (Dwarf_Aranges)
+				       + ((nold + nnew)
+					  * sizeof (Dwarf_Arange)), 1);
+  result->dbg = dbg;
+  result->naranges = nold + nnew;
+  size_t i = 0, j = 0;
+  for (size_t k = 0; k < nold + nnew; ++k)
+    if (j == nnew || (i < nold && old->info[i].addr <= ranges[j].addr))
+      result->info[k] = old->info[i++];
+    else
+      result->info[k] = ranges[j++];
+  free (ranges);
+
+  dbg->aranges = result;
+  return 0;
+}
+
+int
+dwarf_index_aranges (Dwarf *dbg, unsigned int nthreads)
+{
+  if (dbg == NULL)
+    return -1;
+
+  if (dbg->aranges_indexed)
+    return 0;
+
+  /* Start with what .debug_aranges has, if anything.  */
+  Dwarf_Aranges *old;
+  size_t nold;
+  if (INTUSE(dwarf_getaranges) (dbg, &old, &nold) != 0)
+    return -1;
+
+  /* The (sorted) CU DIE offsets of the units covered by .debug_aranges.
+     We assume their entries are complete.  */
+  Dwarf_Off *covered = NULL;
+  size_t ncovered = 0;
+  if (nold > 0)
+    {
+      covered = malloc (nold * sizeof covered[0]);
+      if (covered == NULL)
+	{
+	  __libdw_seterrno (DWARF_E_NOMEM);
+	  return -1;
+	}
+      for (size_t i = 0; i < nold; ++i)
+	covered[i] = old->info[i].offset;
+      qsort (covered, nold, sizeof covered[0], compare_offset);
+      for (size_t i = 0; i < nold; ++i)
+	if (ncovered == 0 || covered[ncovered - 1] != covered[i])
+	  covered[ncovered++] = covered[i];
+    }
+
+  /* Collect the unit DIEs of all other units that can have code.  */
+  struct unit *units = NULL;
+  size_t nunits = 0;
+  int result = -1;
+  Dwarf_Die *dies;
+  size_t ndies;
+  if (__libdw_unit_dies (dbg, &dies, &ndies) != 0)
+    goto out;
+  if (ndies > 0)
+    {
+      units = malloc (ndies * sizeof units[0]);
+      if (units == NULL)
+	{
+	  free (dies);
+	  __libdw_seterrno (DWARF_E_NOMEM);
+	  goto out;
+	}
+    }
+  for (size_t i = 0; i < ndies; ++i)
+    {
+      Dwarf_Off dieoff = INTUSE(dwarf_dieoffset) (&dies[i]);
+      if (ncovered > 0
+	  && bsearch (&dieoff, covered, ncovered, sizeof covered[0],
+		      compare_offset) != NULL)
+	continue;
+
+      uint8_t unit_type = dies[i].cu->unit_type;
+      if (unit_type != DW_UT_compile && unit_type != DW_UT_skeleton)
+	continue;
+
+      struct unit *unit = &units[nunits];
+      unit->cudie = dies[i];
+      unit->decoded = false;
+      unit->ranges = NULL;
+      unit->nranges = 0;
+      unit->error = 0;
+      ++nunits;
+
+      /* The ranges of skeleton units might need the split unit.
+	 Finding that is not thread safe, so do it right away.  */
+      if (unit_type == DW_UT_skeleton)
+	decode_unit (unit);
+    }
+  free (dies);
+
+  /* Decode all other unit ranges, in up to NTHREADS threads.  */
+  __libdw_decode_units (nunits, nthreads, decode_units, units);
+
+  result = merge_ranges (dbg, old, units, nunits);
+  if (result == 0)
+    dbg->aranges_indexed = true;
+
+ out:
+  for (size_t u = 0; u < nunits; ++u)
+    free (units[u].ranges);
+  free (units);
+  free (covered);
+  return result;
+}
+INTDEF(dwarf_index_aranges)
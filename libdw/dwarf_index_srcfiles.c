@@ -0,0 +1,222 @@
+/* Index the line table rows of all units by source file name.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libdwP.h"
+
+
+struct unit
+{
+  Dwarf_Die cudie;
+  bool decoded;
+  Dwarf_Lines *lines;
+  size_t nlines;
+  int error;
+};
+
+static void
+decode_unit (struct unit *unit)
+{
+  if (INTUSE(dwarf_getsrclines) (&unit->cudie, &unit->lines,
+				 &unit->nlines) != 0)
+    {
+      /* A unit that just has no DW_AT_stmt_list at all doesn't set an
+	 error, dwarf_getsrc_file ignores those.  */
+      unit->lines = NULL;
+      unit->error = INTUSE(dwarf_errno) ();
+    }
+  unit->decoded = true;
+}
+
+/* Decode the line table of unit IDX in the UNITS array ARG, unless
+   that was already done.  Called by several threads.  */
+static void
+decode_units (void *arg, size_t idx)
+{
+  struct unit *units = arg;
+  if (! units[idx].decoded)
+    decode_unit (&units[idx]);
+}
+
+/* Go through the rows of all units and count them per base name in
+   INDEX, or when FILL store them in INDEX->rows.  */
+static int
+add_rows (Dwarf_Srcfile_Index *index, struct unit *units, size_t nunits,
+	  bool fill)
+{
+  for (size_t u = 0; u < nunits; ++u)
+    {
+      if (units[u].lines == NULL)
+	{
+	  if (units[u].error == 0)
+	    continue;
+	  __libdw_seterrno (units[u].error);
+	  return -1;
+	}
+
+      Dwarf_Files *lastfiles = NULL;
+      unsigned int lastfile = UINT_MAX;
+      struct Dwarf_Srcfile_Bucket *bucket = NULL;
+      for (size_t cnt = 0; cnt < units[u].nlines; ++cnt)
+	{
+	  Dwarf_Line *line = &units[u].lines->info[cnt];
+	  if (lastfiles != __libdw_line_files (line) || lastfile != line->file)
+	    {
+	      lastfiles = __libdw_line_files (line);
+	      lastfile = line->file;
+	      if (lastfile >= __libdw_line_files (line)->nfiles)
+		{
+		  __libdw_seterrno (DWARF_E_INVALID_DWARF);
+		  return -1;
+		}
+
+	      const char *name = basename (__libdw_line_files (line)->info[lastfile].name);
+	      unsigned long int hval = elf_hash (name);
+	      bucket = __libdw_srcfile_bucket (index, name, hval);
+	      if (bucket->basename == NULL)
+		{
+		  bucket->basename = name;
+		  bucket->hval = hval;
+		}
+	    }
+
+	  if (fill)
+	    index->rows[bucket->first + bucket->nrows]
+	      = (struct Dwarf_Srcfile_Row) { .line = line, .unit = u };
+	  ++bucket->nrows;
+	}
+    }
+
+  return 0;
+}
+
+static int
+build_index (Dwarf *dbg, struct unit *units, size_t nunits)
+{
+  /* There cannot be more base names than file entries, use at most
+     half of the buckets.  */
+  size_t nfiles = 0;
+  size_t nrows = 0;
+  for (size_t u = 0; u < nunits; ++u)
+    if (units[u].lines != NULL && units[u].nlines > 0)
+      {
+	nfiles += units[u].lines->files->nfiles;
+	nrows += units[u].nlines;
+      }
+  size_t nbuckets = 16;
+  while (nbuckets < 2 * nfiles)
+    nbuckets *= 2;
+
+  Dwarf_Srcfile_Index *index = libdw_typed_alloc (dbg, Dwarf_Srcfile_Index);
+  index->nbuckets = nbuckets;
+  index->buckets = libdw_alloc (dbg, struct Dwarf_Srcfile_Bucket,
+				sizeof (struct Dwarf_Srcfile_Bucket),
+				nbuckets);
+  memset (index->buckets, '\0', nbuckets * sizeof index->buckets[0]);
+  index->rows = libdw_alloc (dbg, struct Dwarf_Srcfile_Row,
+			     sizeof (struct Dwarf_Srcfile_Row), nrows ?: 1);
+
+  if (add_rows (index, units, nunits, false) != 0)
+    return -1;
+
+  size_t first = 0;
+  for (size_t i = 0; i < nbuckets; ++i)
+    {
+      index->buckets[i].first = first;
+      first += index->buckets[i].nrows;
+      index->buckets[i].nrows = 0;
+    }
+
+  if (add_rows (index, units, nunits, true) != 0)
+    return -1;
+
+  /* Only publish the index when it is complete, dwarf_getsrc_file
+     might look at it from another thread.  */
+  atomic_store_explicit (&dbg->srcfile_index, (uintptr_t) index,
+			 memory_order_release);
+  return 0;
+}
+
+int
+dwarf_index_srcfiles (Dwarf *dbg, unsigned int nthreads)
+{
+  if (dbg == NULL)
+    return -1;
+
+  if (atomic_load_explicit (&dbg->srcfile_index,
+			    memory_order_acquire) != (uintptr_t) NULL)
+    return 0;
+
+  /* Collect the unit DIEs in the order dwarf_getsrc_file visits them.  */
+  Dwarf_Die *dies;
+  size_t nunits;
+  if (__libdw_unit_dies (dbg, &dies, &nunits) != 0)
+    return -1;
+  struct unit *units = malloc ((nunits ?: 1) * sizeof units[0]);
+  if (units == NULL)
+    {
+      free (dies);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+  for (size_t i = 0; i < nunits; ++i)
+    {
+      struct unit *unit = &units[i];
+      unit->cudie = dies[i];
+      unit->decoded = false;
+      unit->error = 0;
+
+      /* Split units get their lines from the skeleton unit.  Finding
+	 that is not thread safe, so do it right away.  */
+      if (unit->cudie.cu->unit_type == DW_UT_split_compile
+	  || unit->cudie.cu->unit_type == DW_UT_split_type)
+	decode_unit (unit);
+    }
+  free (dies);
+
+  /* The DW_AT_comp_dir strings might come from the alternate debug
+     file, which is opened lazily.  Do that before there are other
+     threads.  */
+  if (nthreads > 1 && nunits > 1)
+    (void) INTUSE(dwarf_getalt) (dbg);
+
+  /* Decode all other line tables, in up to NTHREADS threads.  */
+  __libdw_decode_units (nunits, nthreads, decode_units, units);
+
+  int result = build_index (dbg, units, nunits);
+  free (units);
+  return result;
+}
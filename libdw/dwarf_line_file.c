@@ -39,13 +39,13 @@ dwarf_line_file (Dwarf_Line *line, Dwarf_Files **files, size_t *idx)
   if (line == NULL)
     return -1;
 
-  if (line->file >= line->files->nfiles)
+  if (line->file >= __libdw_line_files (line)->nfiles)
     {
       __libdw_seterrno (DWARF_E_INVALID_DWARF);
       return -1;
     }
 
-  *files = line->files;
+  *files = __libdw_line_files (line);
   *idx = line->file;
 
   return 0;
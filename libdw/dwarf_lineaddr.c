@@ -40,7 +40,7 @@ dwarf_lineaddr (Dwarf_Line *line, Dwarf_Addr *addrp)
   if (line == NULL)
     return -1;
 
-  *addrp =  line->addr;
+  *addrp =  __libdw_line_addr (line);
 
   return 0;
 }
@@ -40,17 +40,17 @@ dwarf_linesrc (Dwarf_Line *line, Dwarf_Word *mtime, Dwarf_Word *length)
   if (line == NULL)
     return NULL;
 
-  if (line->file >= line->files->nfiles)
+  if (line->file >= __libdw_line_files (line)->nfiles)
     {
       __libdw_seterrno (DWARF_E_INVALID_DWARF);
       return NULL;
     }
 
   if (mtime != NULL)
-    *mtime = line->files->info[line->file].mtime;
+    *mtime = __libdw_line_files (line)->info[line->file].mtime;
 
   if (length != NULL)
-    *length = line->files->info[line->file].length;
+    *length = __libdw_line_files (line)->info[line->file].length;
 
-  return line->files->info[line->file].name;
+  return __libdw_line_files (line)->info[line->file].name;
 }
@@ -0,0 +1,46 @@
+/* Hash table for decoded location expressions and lists.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _DWARF_LOC_HASH_H
+#define _DWARF_LOC_HASH_H	1
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdw.h"
+
+/* The entries are struct loc_s, struct loc_block_s or struct loclist_s,
+   hashed by the address of their encoding, or struct peel_s or struct
+   size_s, hashed by the address of the type DIE.  */
+#define NAME Dwarf_Loc_Hash
+#define TYPE void *
+
+#include <dynamicsizehash_concurrent.h>
+
+#endif	/* dwarf_loc_hash.h */
@@ -35,14 +35,17 @@
 #include <string.h>
 
 
-int
-dwarf_peel_type (Dwarf_Die *die, Dwarf_Die *result)
+/* A remembered dwarf_peel_type result, see dwarf_cache_types.  */
+struct peel_s
 {
-  int tag;
+  Dwarf_Die result;
+  int res;
+};
 
-  /* Ignore previous errors.  */
-  if (die == NULL)
-    return -1;
+static int
+peel_type (Dwarf_Die *die, Dwarf_Die *result)
+{
+  int tag;
 
   *result = *die;
   tag = INTUSE (dwarf_tag) (result);
@@ -77,4 +80,40 @@ dwarf_peel_type (Dwarf_Die *die, Dwarf_Die *result)
 
   return 0;
 }
+
+int
+dwarf_peel_type (Dwarf_Die *die, Dwarf_Die *result)
+{
+  /* Ignore previous errors.  */
+  if (die == NULL)
+    return -1;
+
+  Dwarf *dbg = die->cu->dbg;
+  if (! dbg->type_cache)
+    return peel_type (die, result);
+
+  /* RESULT can be the same as DIE.  */
+  uintptr_t key = (uintptr_t) die->addr;
+  struct peel_s *found = Dwarf_Loc_Hash_find (&dbg->peel_hash, key);
+  if (found != NULL)
+    {
+      *result = found->result;
+      return found->res;
+    }
+
+  int res = peel_type (die, result);
+
+  /* Errors are not remembered, so they are reported again next time.  */
+  if (res >= 0)
+    {
+      struct peel_s *newp = libdw_typed_alloc (dbg, struct peel_s);
+      newp->result = *result;
+      newp->res = res;
+      if (Dwarf_Loc_Hash_insert (&dbg->peel_hash, key, newp) != 0)
+	/* Another thread was faster.  */
+	libdw_typed_unalloc (dbg, struct peel_s);
+    }
+
+  return res;
+}
 INTDEF(dwarf_peel_type)
@@ -43,6 +43,11 @@ dwarf_setalt (Dwarf *main, Dwarf *alt)
       close (main->alt_fd);
       main->alt_fd = -1;
     }
+  else if (main->alt_shared)
+    {
+      __libdw_release_alt (main->alt_dwarf);
+      main->alt_shared = false;
+    }
 
   main->alt_dwarf = alt;
 }
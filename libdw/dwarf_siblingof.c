@@ -48,6 +48,24 @@ dwarf_siblingof (Dwarf_Die *die, Dwarf_Die *result)
   if (result != die)
     result->addr = NULL;
 
+  /* If the unit DIE index was already built, the next sibling can be
+     found there without going through the children of DIE.  An
+     invalid DIE has no unit.  */
+  Dwarf_Die_Index *index = NULL;
+  if (die->cu != NULL)
+    index = (Dwarf_Die_Index *) atomic_load_explicit (&die->cu->die_index,
+						      memory_order_acquire);
+  if (index != NULL)
+    {
+      size_t idx = __libdw_die_index_find (index, die);
+      if (idx != (size_t) -1 && index->siblings[idx] != (size_t) -1)
+	{
+	  __libdw_die_index_die (die->cu, index, index->siblings[idx],
+				 result);
+	  return 0;
+	}
+    }
+
   unsigned int level = 0;
 
   /* Copy of the current DIE.  */
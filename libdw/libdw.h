@@ -153,6 +153,16 @@ typedef struct
   Dwarf_Word offset;		/* Offset in location expression */
 } Dwarf_Op;
 
+/* One entry of a location list, the location expression for addresses
+   in [START, END).  */
+typedef struct
+{
+  Dwarf_Addr start;
+  Dwarf_Addr end;
+  Dwarf_Op *expr;
+  size_t exprlen;
+} Dwarf_Location_Entry;
+
 
 /* This describes one Common Information Entry read from a CFI section.
    Pointers here point into the DATA->d_buf block passed to dwarf_next_cfi.  */
@@ -265,6 +275,29 @@ extern Dwarf *dwarf_getalt (Dwarf *main);
    alt file itself on first use.  */
 extern void dwarf_setalt (Dwarf *main, Dwarf *alt);
 
+/* Lets dwarf_getalt share the alt file found for MAIN with the other
+   Dwarfs that called this function and refer to the same dwz file, so
+   it is only opened and has its units read once.  The shared alt Dwarf
+   still fills in its abbrev tables, line tables and indexes on first
+   use, so Dwarfs sharing it must not be used from different threads at
+   the same time.  Must be called before the alt file is used.  */
+extern void dwarf_share_alt (Dwarf *main);
+
+/* Retrieves the DWARF descriptor for the DWARF package file (.dwp)
+   with the split units of the skeleton units in MAIN.  Returns NULL if
+   there is none.  libdw will try to find the package file, named like
+   the file of MAIN with .dwp appended, on first use of a skeleton unit
+   if not yet explicitly provided by dwarf_setdwp.  */
+extern Dwarf *dwarf_getdwp (Dwarf *main);
+
+/* Provides the DWARF package file DWP with the split units for the
+   skeleton units in MAIN.  It is the responsibility of the caller to
+   ensure that DWP stays valid while it is used by MAIN, until
+   dwarf_setdwp is called on MAIN with a different descriptor, or
+   dwarf_end.  Must be called before inspecting any skeleton units.
+   Otherwise libdw will try to find the package file itself.  */
+extern void dwarf_setdwp (Dwarf *main, Dwarf *dwp);
+
 /* Release debugging handling context.  */
 extern int dwarf_end (Dwarf *dwarf);
 
@@ -420,6 +453,24 @@ extern int dwarf_child (Dwarf_Die *die, Dwarf_Die *result)
 extern int dwarf_siblingof (Dwarf_Die *die, Dwarf_Die *result)
      __nonnull_attribute__ (2);
 
+/* Locates the parent of DIE and places it in RESULT.  The first call
+   for a unit builds an index of all DIEs in the unit.  DIEs found
+   through the index, and their children and siblings, remember their
+   position in it, so their parent is found in constant time.  Other
+   DIEs are found with a binary search in the index.  Once the index
+   is built, dwarf_siblingof uses it too.  Returns 0 if a parent was
+   found, 1 if DIE is the unit DIE and -1 if something went wrong.  */
+extern int dwarf_die_parent (Dwarf_Die *die, Dwarf_Die *result)
+     __nonnull_attribute__ (2);
+
+/* Like dwarf_siblingof, but uses the same unit DIE index as
+   dwarf_die_parent, so the children of DIE don't have to be scanned
+   when it has no DW_AT_sibling attribute.  Returns 0 if a sibling was
+   found, 1 if there is no sibling (RESULT isn't changed) and -1 if
+   something went wrong.  */
+extern int dwarf_die_sibling (Dwarf_Die *die, Dwarf_Die *result)
+     __nonnull_attribute__ (2);
+
 /* For type aliases and qualifier type DIEs, which don't modify or
    change the structural layout of the underlying type, follow the
    DW_AT_type attribute (recursively) and return the underlying type
@@ -644,6 +695,18 @@ extern int dwarf_getsrc_file (Dwarf *dbg, const char *fname, int line, int col,
 			      Dwarf_Line ***srcsp, size_t *nsrcs)
      __nonnull_attribute__ (2, 5, 6);
 
+/* Build an index of the line table rows of all units by source file
+   name, so later dwarf_getsrc_file calls only look at the rows of files
+   with the requested base name.  The line tables are decoded by up to
+   NTHREADS threads.  dwarf_getsrc_file calls in other threads only use
+   the index once it is complete, and search all units themselves until
+   then.  Like other calls that read unit headers, this may only run at
+   the same time as dwarf_getsrc_file or another dwarf_index_srcfiles
+   for the same DBG if all its units were read before, for example by an
+   earlier dwarf_getsrc_file call.  Returns 0 on success, -1 on
+   error.  */
+extern int dwarf_index_srcfiles (Dwarf *dbg, unsigned int nthreads);
+
 
 /* Return line address.  */
 extern int dwarf_lineaddr (Dwarf_Line *line, Dwarf_Addr *addrp);
@@ -764,6 +827,18 @@ extern ptrdiff_t dwarf_getlocations (Dwarf_Attribute *attr,
 				     Dwarf_Addr *startp, Dwarf_Addr *endp,
 				     Dwarf_Op **expr, size_t *exprlen);
 
+/* Return all location ranges and descriptions of the given attribute
+   at once, in an array of *NENTRIES elements stored in *ENTRIES.  The
+   array belongs to libdw and stays valid until dwarf_end.  A single
+   location description is returned as one entry covering [0, -1), just
+   like dwarf_getlocations does.  The location list is decoded only
+   once, later calls for the same attribute are cheap.  Returns 0 on
+   success, -1 for errors.  */
+extern int dwarf_getlocation_entries (Dwarf_Attribute *attr,
+				      Dwarf_Location_Entry **entries,
+				      size_t *nentries)
+  __nonnull_attribute__ (2, 3);
+
 /* Return the block associated with a DW_OP_implicit_value operation.
    The OP pointer must point into an expression that dwarf_getlocation
    or dwarf_getlocation_addr has returned given the same ATTR.  */
@@ -811,6 +886,13 @@ extern int dwarf_getlocation_attr (Dwarf_Attribute *attr,
    For DW_TAG_array_type it can apply much more complex rules.  */
 extern int dwarf_aggregate_size (Dwarf_Die *die, Dwarf_Word *size);
 
+/* Remember the results of dwarf_peel_type and dwarf_aggregate_size for
+   the type DIEs of DBG, so asking again for the same type is cheap.
+   The cache can be used from multiple threads, but this function itself
+   must be called before DBG is shared between threads.  Returns 0 on
+   success, -1 on error.  */
+extern int dwarf_cache_types (Dwarf *dbg);
+
 /* Given a language code, as returned by dwarf_srclan, get the default
    lower bound for a subrange type without a lower bound attribute.
    Returns zero on success or -1 on failure when the given language
@@ -869,6 +951,15 @@ extern int dwarf_getarangeinfo (Dwarf_Arange *arange, Dwarf_Addr *addrp,
 extern Dwarf_Arange *dwarf_getarange_addr (Dwarf_Aranges *aranges,
 					   Dwarf_Addr addr);
 
+/* Add the address ranges of all compile units that have no entries in
+   .debug_aranges (or if there is no such section at all) to the ranges
+   returned by dwarf_getaranges.  The ranges are taken from the
+   DW_AT_low_pc, DW_AT_high_pc and DW_AT_ranges attributes of the unit
+   DIEs, which are decoded by up to NTHREADS threads.  Returns 0 on
+   success, -1 on error.  Aranges returned by dwarf_getaranges before
+   stay valid, but don't include the new ranges.  */
+extern int dwarf_index_aranges (Dwarf *dbg, unsigned int nthreads);
+
 
 
 /* Get functions in CUDIE.  The given callback will be called for all
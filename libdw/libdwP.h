@@ -32,6 +32,7 @@
 #include <libintl.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <string.h>
 
 #include <libdw.h>
 #include <dwarf.h>
@@ -88,6 +89,8 @@ enum
     IDX_debug_macro,
     IDX_debug_ranges,
     IDX_debug_rnglists,
+    IDX_debug_cu_index,
+    IDX_debug_tu_index,
     IDX_gnu_debugaltlink,
     IDX_last
   };
@@ -148,6 +151,7 @@ enum
 
 
 #include "dwarf_sig8_hash.h"
+#include "dwarf_loc_hash.h"
 
 /* This is the structure representing the debugging state.  */
 struct Dwarf
@@ -175,6 +179,37 @@ struct Dwarf
      close this file descriptor.  */
   int alt_fd;
 
+  /* If true, dwarf_share_alt was called and dwarf_getalt may share
+     the alt_dwarf with other Dwarfs.  */
+  bool share_alt;
+
+  /* If true, the alt_dwarf was found by dwarf_getalt and is shared
+     with the other Dwarfs using the same dwz file that called
+     dwarf_share_alt.  It must be released with __libdw_release_alt.  */
+  bool alt_shared;
+
+  /* All units in .debug_info sorted by offset, if they were read in
+     advance by __libdw_index_units.  Allocated with malloc.  */
+  struct Dwarf_CU **cu_array;
+  size_t cu_array_count;
+
+  /* The same units by the offset of their unit DIE, only initialized
+     together with cu_array.  See __libdw_findcu_die.  */
+  Dwarf_Sig8_Hash cu_die_hash;
+
+  /* DWARF package file with the split units for our skeleton units.
+     Set to -1 if not found.  Always use dwarf_getdwp to access it.  */
+  Dwarf *dwp_dwarf;
+
+  /* If >= 0, we allocated the dwp_dwarf ourselves and must end it and
+     close this file descriptor.  */
+  int dwp_fd;
+
+  /* If this is a DWARF package file, the .debug_cu_index and
+     .debug_tu_index of its units.  */
+  struct Dwarf_Package_Index_s *cu_index;
+  struct Dwarf_Package_Index_s *tu_index;
+
   /* Information for traversing the .debug_pubnames section.  This is
      an array and separately allocated with malloc.  */
   struct pubnames_s
@@ -195,18 +230,44 @@ struct Dwarf
   Dwarf_Off next_tu_offset;
   Dwarf_Sig8_Hash sig8_hash;
 
+  /* Location expressions and lists already decoded, by the address of
+     their encoding.  */
+  Dwarf_Loc_Hash loc_hash;
+  Dwarf_Loc_Hash loclist_hash;
+
+  /* Results of dwarf_peel_type and dwarf_aggregate_size, by the address
+     of the type DIE.  Only used after dwarf_cache_types was called.  */
+  bool type_cache;
+  Dwarf_Loc_Hash peel_hash;
+  Dwarf_Loc_Hash size_hash;
+
   /* Search tree for split Dwarf associated with CUs in this debug.  */
   void *split_tree;
 
+  /* Search tree for the abbreviation tables, shared between all units
+     with the same .debug_abbrev offset.  */
+  void *abbrev_tables;
+  pthread_mutex_t abbrev_tables_lock;
+
   /* Search tree for .debug_macro operator tables.  */
   void *macro_ops;
 
   /* Search tree for decoded .debug_line units.  */
   void *files_lines;
+  pthread_mutex_t files_lines_lock;
+
+  /* Index of the line table rows by source file name, a
+     Dwarf_Srcfile_Index pointer.  dwarf_index_srcfiles stores it with
+     release semantics once it is complete.  */
+  atomic_uintptr_t srcfile_index;
 
   /* Address ranges.  */
   Dwarf_Aranges *aranges;
 
+  /* True if aranges also has the ranges of the units without
+     .debug_aranges entries, added by dwarf_index_aranges.  */
+  bool aranges_indexed;
+
   /* Cached info from the CFI section.  */
   struct Dwarf_CFI_s *cfi;
 
@@ -245,11 +306,30 @@ struct Dwarf
 };
 
 
+/* Decoded attribute name/form pair of an abbreviation.  */
+typedef struct
+{
+  unsigned int name;
+  unsigned int form;
+  /* Offset of the value from the start of the DIE attribute data.
+     Only valid when all preceding forms have a fixed length.  */
+  unsigned int offset;
+  /* Offset of the DW_FORM_implicit_const value from the abbrev attrp.  */
+  unsigned int constoff;
+} Dwarf_Abbrev_Attr;
+
 /* Abbreviation representation.  */
 struct Dwarf_Abbrev
 {
   Dwarf_Off offset;	  /* Offset to start of abbrev into .debug_abbrev.  */
   unsigned char *attrp;   /* Pointer to start of attribute name/form pairs. */
+  /* The decoded attribute name/form pairs, NATTRS entries followed by
+     the terminating (0, 0) entry.  The first NFIXED entries (at least
+     one) have a known value offset.  Only set for abbrevs in an
+     abbrev table hash, NULL otherwise.  */
+  Dwarf_Abbrev_Attr *attrs;
+  unsigned int nattrs;
+  unsigned int nfixed;
   bool has_children : 1;  /* Whether or not the DIE has children. */
   unsigned int code : 31; /* The (unique) abbrev code.  */
   unsigned int tag;	  /* The tag of the DIE. */
@@ -257,6 +337,21 @@ struct Dwarf_Abbrev
 
 #include "dwarf_abbrev_hash.h"
 
+/* Abbreviation table at a .debug_abbrev offset.  Parsed abbrevs are
+   shared read-only between all units that use the same table.  */
+typedef struct
+{
+  /* Hash table for the abbreviations.  */
+  Dwarf_Abbrev_Hash hash;
+  /* Offset of the first abbreviation.  */
+  size_t offset;
+  /* Offset past last read abbreviation.  */
+  size_t last_offset;
+  /* Held while reading more abbreviations and updating LAST_OFFSET,
+     units of different threads can share the table.  */
+  pthread_mutex_t lock;
+} Dwarf_Abbrev_Table;
+
 
 /* Files in line information records.  */
 struct Dwarf_Files_s
@@ -274,15 +369,17 @@ struct Dwarf_Files_s
 typedef struct Dwarf_Fileinfo_s Dwarf_Fileinfo;
 
 
-/* Representation of a row in the line table.  */
-
+/* Representation of a row in the line table.  Rows have no pointers,
+   everything they share is in their Dwarf_Lines, which
+   __libdw_line_table finds.  */
 struct Dwarf_Line_s
 {
-  Dwarf_Files *files;
-
-  Dwarf_Addr addr;
+  /* The address relative to Dwarf_Lines.addr_base.  Unused if the
+     table has Dwarf_Lines.addrs.  */
+  uint32_t addroff;
   unsigned int file;
   int line;
+  unsigned int idx;		/* My index in the Dwarf_Lines.info table.  */
   unsigned short int column;
   unsigned int is_stmt:1;
   unsigned int basic_block:1;
@@ -300,9 +397,86 @@ struct Dwarf_Line_s
 struct Dwarf_Lines_s
 {
   size_t nlines;
+  Dwarf_Files *files;
+
+  /* The row addresses are relative to ADDR_BASE.  If that doesn't fit
+     into Dwarf_Line.addroff for some row, ADDRS has all of them.  */
+  Dwarf_Addr addr_base;
+  Dwarf_Addr *addrs;
+
   struct Dwarf_Line_s info[0];
 };
 
+/* Return the table LINE is a row of.  */
+static inline Dwarf_Lines *
+__libdw_line_table (const Dwarf_Line *line)
+{
+  return (Dwarf_Lines *) ((const char *) line
+			  - offsetof (Dwarf_Lines, info[line->idx]));
+}
+
+/* Return the address of row IDX in LINES.  */
+static inline Dwarf_Addr
+__libdw_lines_addr (const Dwarf_Lines *lines, size_t idx)
+{
+  if (unlikely (lines->addrs != NULL))
+    return lines->addrs[idx];
+  return lines->addr_base + lines->info[idx].addroff;
+}
+
+/* Return the address of LINE.  */
+static inline Dwarf_Addr
+__libdw_line_addr (const Dwarf_Line *line)
+{
+  return __libdw_lines_addr (__libdw_line_table (line), line->idx);
+}
+
+/* Return the file table of LINE.  */
+static inline Dwarf_Files *
+__libdw_line_files (const Dwarf_Line *line)
+{
+  return __libdw_line_table (line)->files;
+}
+
+/* Index of the line table rows of all units by source file base name.
+   Open addressing hash table with NBUCKETS (a power of two) buckets.  */
+typedef struct Dwarf_Srcfile_Index_s
+{
+  size_t nbuckets;
+  struct Dwarf_Srcfile_Bucket
+  {
+    /* NULL for an unused bucket.  */
+    const char *basename;
+    unsigned long int hval;
+    /* The rows of the base name are ROWS[FIRST, FIRST + NROWS).  */
+    size_t first;
+    size_t nrows;
+  } *buckets;
+
+  /* Rows in the order dwarf_getsrc_file visits them, with the number of
+     the unit they are in.  */
+  struct Dwarf_Srcfile_Row
+  {
+    Dwarf_Line *line;
+    size_t unit;
+  } *rows;
+} Dwarf_Srcfile_Index;
+
+/* Find the bucket for BASENAME with hash value HVAL in INDEX.  Returns
+   an unused bucket if the base name doesn't occur.  */
+static inline struct Dwarf_Srcfile_Bucket *
+__libdw_srcfile_bucket (Dwarf_Srcfile_Index *index, const char *basename,
+			unsigned long int hval)
+{
+  size_t mask = index->nbuckets - 1;
+  size_t idx = hval & mask;
+  while (index->buckets[idx].basename != NULL
+	 && (index->buckets[idx].hval != hval
+	     || strcmp (index->buckets[idx].basename, basename) != 0))
+    idx = (idx + 1) & mask;
+  return &index->buckets[idx];
+}
+
 /* Representation of address ranges.  */
 struct Dwarf_Aranges_s
 {
@@ -318,6 +492,21 @@ struct Dwarf_Aranges_s
 };
 
 
+/* Index of all DIEs of a unit in DIE (and so offset) order, in
+   struct-of-arrays form.  Built on demand by __libdw_die_index.  */
+typedef struct
+{
+  size_t ndies;
+  /* Offset of the DIE from the start of the unit.  */
+  Dwarf_Off *offsets;
+  unsigned int *tags;
+  Dwarf_Abbrev **abbrevs;
+  /* Index of the parent and of the next sibling DIE, or (size_t) -1
+     if there is none.  */
+  size_t *parents;
+  size_t *siblings;
+} Dwarf_Die_Index;
+
 /* CU representation.  */
 struct Dwarf_CU
 {
@@ -346,12 +535,8 @@ struct Dwarf_CU
      this field.  */
   struct Dwarf_CU *split;
 
-  /* Hash table for the abbreviations.  */
-  Dwarf_Abbrev_Hash abbrev_hash;
-  /* Offset of the first abbreviation.  */
-  size_t orig_abbrev_offset;
-  /* Offset past last read abbreviation.  */
-  size_t last_abbrev_offset;
+  /* The abbreviations, possibly shared with other units.  */
+  Dwarf_Abbrev_Table *abbrevs;
 
   /* The srcline information.  */
   Dwarf_Lines *lines;
@@ -359,8 +544,19 @@ struct Dwarf_CU
   /* The source file information.  */
   Dwarf_Files *files;
 
-  /* Known location lists.  */
-  void *locs;
+  /* Index of all DIEs in the unit, a Dwarf_Die_Index pointer.  Don't
+     access directly, call __libdw_die_index.  */
+  atomic_uintptr_t die_index;
+
+  /* Address to scope index, a struct Dwarf_Scope_Index pointer,
+     built by dwarf_getscopes.  */
+  atomic_uintptr_t scope_index;
+
+  /* The package file index and its row for this unit if it comes from
+     a DWARF package file, NULL otherwise.  Don't access directly, call
+     __libdw_cu_dwp_offset.  */
+  struct Dwarf_Package_Index_s *dwp_index;
+  uint32_t dwp_row;
 
   /* Base address for use with ranges and locs.
      Don't access directly, call __libdw_cu_base_address.  */
@@ -386,6 +582,10 @@ struct Dwarf_CU
   /* Memory boundaries of this CU.  */
   void *startp;
   void *endp;
+
+  /* Position in the cu_array of the Dwarf, once __libdw_index_units
+     has created it.  */
+  size_t cu_array_idx;
 };
 
 #define ISV4TU(cu) ((cu)->version == 4 && (cu)->sec_idx == IDX_debug_types)
@@ -647,6 +847,38 @@ extern struct Dwarf_CU *__libdw_findcu (Dwarf *dbg, Dwarf_Off offset, bool tu)
 extern struct Dwarf_CU *__libdw_findcu_addr (Dwarf *dbg, void *addr)
      __nonnull_attribute__ (1) internal_function;
 
+/* Read all units in .debug_info and create the sorted cu_array, so
+   __libdw_findcu doesn't have to search or extend the CU tree anymore.
+   Returns 0 on success, -1 on error.  */
+extern int __libdw_index_units (Dwarf *dbg)
+     __nonnull_attribute__ (1) internal_function;
+
+/* Find the unit in .debug_info with its unit DIE at DIEOFF, in constant
+   time.  __libdw_index_units must have been called successfully.
+   Returns NULL if there is no such unit.  */
+extern struct Dwarf_CU *__libdw_findcu_die (Dwarf *dbg, Dwarf_Off dieoff)
+     __nonnull_attribute__ (1) internal_function;
+
+/* Read the unit DIEs of all units in .debug_info into a malloc'd array
+   *DIES, with their abbrevs already resolved so threads decoding them
+   don't need to look those up.  Reading unit headers must not be done
+   in parallel.  Returns 0 on success, -1 on error.  */
+extern int __libdw_unit_dies (Dwarf *dbg, Dwarf_Die **dies, size_t *ndies)
+     __nonnull_attribute__ (1, 2, 3) internal_function;
+
+/* Call DECODE (ARG, IDX) once for every IDX below N, in this thread and
+   up to NTHREADS - 1 others.  If a thread cannot be created, the others
+   just do more.  */
+extern void __libdw_decode_units (size_t n, unsigned int nthreads,
+				  void (*decode) (void *arg, size_t idx),
+				  void *arg)
+     __nonnull_attribute__ (3) internal_function;
+
+/* Release an alt_dwarf shared between Dwarfs by dwarf_getalt.  The alt
+   file is ended when the last Dwarf using it releases it.  */
+extern void __libdw_release_alt (Dwarf *alt)
+     __nonnull_attribute__ (1) internal_function;
+
 /* Find split Dwarf for given DIE address.  */
 extern struct Dwarf *__libdw_find_split_dbg_addr (Dwarf *dbg, void *addr)
      __nonnull_attribute__ (1) internal_function;
@@ -698,11 +930,10 @@ extern size_t __libdw_form_val_compute_len (struct Dwarf_CU *cu,
 					    const unsigned char *valp)
      __nonnull_attribute__ (1, 3) internal_function;
 
-/* Find the length of a form attribute in DIE/info data.  */
+/* Return the length of a form that doesn't depend on the CU or the
+   value itself, or -1 if the form has no such fixed length.  */
 static inline size_t
-__nonnull_attribute__ (1, 3)
-__libdw_form_val_len (struct Dwarf_CU *cu, unsigned int form,
-		      const unsigned char *valp)
+__libdw_form_val_fixed_len (unsigned int form)
 {
   /* Small lookup table of forms with fixed lengths.  Absent indexes are
      initialized 0, so any truly desired 0 is set to 0x80 and masked.  */
@@ -729,21 +960,33 @@ __libdw_form_val_len (struct Dwarf_CU *cu, unsigned int form,
       [DW_FORM_data16] = 16,
     };
 
-  /* Return immediately for forms with fixed lengths.  */
   if (form < sizeof form_lengths / sizeof form_lengths[0])
     {
       uint8_t len = form_lengths[form];
       if (len != 0)
+	return len & 0x7f; /* Mask to allow 0x80 -> 0.  */
+    }
+
+  return -1;
+}
+
+/* Find the length of a form attribute in DIE/info data.  */
+static inline size_t
+__nonnull_attribute__ (1, 3)
+__libdw_form_val_len (struct Dwarf_CU *cu, unsigned int form,
+		      const unsigned char *valp)
+{
+  /* Return immediately for forms with fixed lengths.  */
+  size_t len = __libdw_form_val_fixed_len (form);
+  if (len != (size_t) -1)
+    {
+      const unsigned char *endp = cu->endp;
+      if (unlikely (len > (size_t) (endp - valp)))
 	{
-	  const unsigned char *endp = cu->endp;
-	  len &= 0x7f; /* Mask to allow 0x80 -> 0.  */
-	  if (unlikely (len > (size_t) (endp - valp)))
-	    {
-	      __libdw_seterrno (DWARF_E_INVALID_DWARF);
-	      return -1;
-	    }
-	  return len;
+	  __libdw_seterrno (DWARF_E_INVALID_DWARF);
+	  return -1;
 	}
+      return len;
     }
 
   /* Other forms require some computation.  */
@@ -755,6 +998,11 @@ extern int __libdw_formref (Dwarf_Attribute *attr, Dwarf_Off *return_offset)
      __nonnull_attribute__ (1, 2) internal_function;
 
 
+/* Some arbitrary attribute name not conflicting with any existing code.
+   When searched for, __libdw_find_attr returns the end of the DIE
+   attributes.  */
+#define INVALID_ATTR 0xffffe444
+
 /* Helper function to locate attribute.  */
 extern unsigned char *__libdw_find_attr (Dwarf_Die *die,
 					 unsigned int search_name,
@@ -785,8 +1033,46 @@ extern int __libdw_visit_scopes (unsigned int depth,
 				 void *arg)
   __nonnull_attribute__ (2, 4) internal_function;
 
-/* Parse a DWARF Dwarf_Block into an array of Dwarf_Op's,
-   and cache the result (via tsearch).  */
+/* Get the DIE index of the unit, building it when not yet done.
+   Returns NULL and sets libdw_errno on error.  */
+extern Dwarf_Die_Index *__libdw_die_index (struct Dwarf_CU *cu)
+  __nonnull_attribute__ (1) internal_function;
+
+/* Find the scopes containing DIE like a __libdw_visit_scopes walk from
+   the unit DIE would, but following the parents in the INDEX of the
+   unit of DIE.  On success sets *SCOPES to a malloc'd array from DIE
+   out to the unit DIE and returns its length.  Returns 0 if the walk
+   would not find DIE and -1 on error.  */
+extern int __libdw_index_scopes (Dwarf_Die_Index *index, Dwarf_Die *die,
+				 Dwarf_Die **scopes)
+  __nonnull_attribute__ (1, 2, 3) internal_function;
+
+/* Find the index of DIE in INDEX.  This takes constant time for a DIE
+   that remembers its position, see __libdw_die_index_die, and is a
+   binary search otherwise.  Returns (size_t) -1 if DIE isn't part of
+   the index.  */
+extern size_t __libdw_die_index_find (Dwarf_Die_Index *index, Dwarf_Die *die)
+  __nonnull_attribute__ (1, 2) internal_function;
+
+/* Fill in RESULT for the DIE at IDX in the INDEX of CU.  The position
+   in the index plus one is kept in the otherwise unused padding__ of
+   the DIE, dwarf_child and dwarf_siblingof pass it on.  */
+static inline void
+__libdw_die_index_die (struct Dwarf_CU *cu, Dwarf_Die_Index *index,
+		       size_t idx, Dwarf_Die *result)
+{
+  *result = (Dwarf_Die)
+    {
+      .addr = (char *) cu->startp + index->offsets[idx],
+      .cu = cu,
+      .abbrev = index->abbrevs[idx],
+      .padding__ = idx + 1
+    };
+}
+
+/* Parse a DWARF Dwarf_Block into an array of Dwarf_Op's, and cache the
+   result in the loc_hash of DBG, or when DBG is NULL (for CFI, which
+   malloc's the result) in the search tree CACHE.  */
 extern int __libdw_intern_expression (Dwarf *dbg,
 				      bool other_byte_order,
 				      unsigned int address_size,
@@ -795,7 +1081,7 @@ extern int __libdw_intern_expression (Dwarf *dbg,
 				      bool cfap, bool valuep,
 				      Dwarf_Op **llbuf, size_t *listlen,
 				      int sec_index)
-  __nonnull_attribute__ (5, 6, 9, 10) internal_function;
+  __nonnull_attribute__ (6, 9, 10) internal_function;
 
 extern Dwarf_Die *__libdw_offdie (Dwarf *dbg, Dwarf_Off offset,
 				  Dwarf_Die *result, bool debug_types)
@@ -994,6 +1280,83 @@ const char *__libdw_getcompdir (Dwarf_Die *cudie);
    This is used as initial base address for ranges and loclists.  */
 Dwarf_Addr __libdw_cu_base_address (Dwarf_CU *cu);
 
+/* The .debug_cu_index or .debug_tu_index of a DWARF package file.  */
+typedef struct Dwarf_Package_Index_s
+{
+  Dwarf *dbg;
+  uint32_t section_count;
+  uint32_t unit_count;
+  uint32_t slot_count;
+
+  /* The hash table of unit ids and the (one based) rows they are in.  */
+  const unsigned char *hash_table;
+  const unsigned char *indices;
+
+  /* Rows of section_count contribution offsets and sizes per unit.  */
+  const unsigned char *offsets;
+  const unsigned char *sizes;
+
+  /* The column of each section in the rows, or -1 if the units have no
+     contributions to it.  */
+  int columns[IDX_last];
+
+  /* The rows sorted by the offset of their unit, so we can find the row
+     of a unit while reading its header.  */
+  struct Dwarf_Package_Unit
+  {
+    Dwarf_Off offset;
+    uint32_t row;
+  } *units;
+} Dwarf_Package_Index;
+
+/* Read the DWARF package file index in section SEC_IDX of DBG.  Returns
+   NULL if there is none, or if it cannot be used.  */
+extern Dwarf_Package_Index *__libdw_read_package_index (Dwarf *dbg,
+							size_t sec_idx)
+     internal_function;
+
+/* Free an index returned by __libdw_read_package_index.  */
+extern void __libdw_free_package_index (Dwarf_Package_Index *index)
+     internal_function;
+
+/* Find the row of the unit with id ID8 in INDEX.  Returns 0 and sets
+   *ROWP if found, -1 otherwise.  */
+extern int __libdw_package_index_find (Dwarf_Package_Index *index,
+				       uint64_t id8, uint32_t *rowp)
+     internal_function;
+
+/* Find the row of the unit starting at OFFSET in INDEX.  Returns 0 and
+   sets *ROWP if found, -1 otherwise.  */
+extern int __libdw_package_index_unit (Dwarf_Package_Index *index,
+				       Dwarf_Off offset, uint32_t *rowp)
+     internal_function;
+
+/* The offset of the contribution of ROW in INDEX to section SEC_IDX.  */
+static inline Dwarf_Off
+__libdw_package_offset (Dwarf_Package_Index *index, uint32_t row,
+			size_t sec_idx)
+{
+  int column = index->columns[sec_idx];
+  if (column < 0)
+    return 0;
+
+  const unsigned char *p = (index->offsets
+			    + ((size_t) row * index->section_count
+			       + column) * 4);
+  return read_4ubyte_unaligned (index->dbg, p);
+}
+
+/* The offset of the contribution of CU to section SEC_IDX.  This is
+   always zero, unless CU comes from a DWARF package file.  */
+static inline Dwarf_Off
+__libdw_cu_dwp_offset (Dwarf_CU *cu, size_t sec_idx)
+{
+  if (cu->dwp_index == NULL)
+    return 0;
+
+  return __libdw_package_offset (cu->dwp_index, cu->dwp_row, sec_idx);
+}
+
 /* Get the address base for the CU, fetches it when not yet set.  */
 static inline Dwarf_Off
 __libdw_cu_addr_base (Dwarf_CU *cu)
@@ -1052,10 +1415,12 @@ str_offsets_base_off (Dwarf *dbg, Dwarf_CU *cu)
 		  return cu->str_off_base;
 		}
 	    }
-	  /* For older DWARF simply assume zero (no header).  */
+	  /* For older DWARF simply assume zero (no header), or the
+	     start of the unit contribution in a DWARF package file.  */
 	  if (cu->version < 5)
 	    {
-	      cu->str_off_base = 0;
+	      cu->str_off_base = __libdw_cu_dwp_offset (cu,
+						       IDX_debug_str_offsets);
 	      return cu->str_off_base;
 	    }
 
@@ -1066,20 +1431,23 @@ str_offsets_base_off (Dwarf *dbg, Dwarf_CU *cu)
 	return cu->str_off_base;
     }
 
-  /* No str_offsets_base attribute, we have to assume "zero".
+  /* No str_offsets_base attribute, we have to assume "zero", which
+     is the start of the unit contribution in a DWARF package file.
      But there could be a header first.  */
-  Dwarf_Off off = 0;
+  Dwarf_Off off = (cu != NULL
+		   ? __libdw_cu_dwp_offset (cu, IDX_debug_str_offsets) : 0);
   if (dbg == NULL)
     goto no_header;
 
   Elf_Data *data =  dbg->sectiondata[IDX_debug_str_offsets];
-  if (data == NULL)
+  if (data == NULL || off >= data->d_size)
     goto no_header;
 
   const unsigned char *start;
   const unsigned char *readp;
   const unsigned char *readendp;
-  start = readp = (const unsigned char *) data->d_buf;
+  start = (const unsigned char *) data->d_buf;
+  readp = start + off;
   readendp = (const unsigned char *) data->d_buf + data->d_size;
 
   uint64_t unit_length;
@@ -1157,12 +1525,14 @@ __libdw_cu_ranges_base (Dwarf_CU *cu)
 
 	  /* There wasn't an rnglists_base, if the Dwarf does have a
 	     .debug_rnglists section, then it might be we need the
-	     base after the first header. */
+	     base after the first header (of the unit contribution in a
+	     DWARF package file). */
 	  Elf_Data *data = cu->dbg->sectiondata[IDX_debug_rnglists];
-	  if (offset == 0 && data != NULL)
+	  Dwarf_Off dwp_off = __libdw_cu_dwp_offset (cu, IDX_debug_rnglists);
+	  if (offset == 0 && data != NULL && dwp_off < data->d_size)
 	    {
 	      Dwarf *dbg = cu->dbg;
-	      const unsigned char *readp = data->d_buf;
+	      const unsigned char *readp = data->d_buf + dwp_off;
 	      const unsigned char *const dataend
 		= (unsigned char *) data->d_buf + data->d_size;
 
@@ -1235,12 +1605,14 @@ __libdw_cu_locs_base (Dwarf_CU *cu)
 
       /* There wasn't an loclists_base, if the Dwarf does have a
 	 .debug_loclists section, then it might be we need the
-	 base after the first header. */
+	 base after the first header (of the unit contribution in a
+	 DWARF package file). */
       Elf_Data *data = cu->dbg->sectiondata[IDX_debug_loclists];
-      if (offset == 0 && data != NULL)
+      Dwarf_Off dwp_off = __libdw_cu_dwp_offset (cu, IDX_debug_loclists);
+      if (offset == 0 && data != NULL && dwp_off < data->d_size)
 	{
 	  Dwarf *dbg = cu->dbg;
-	  const unsigned char *readp = data->d_buf;
+	  const unsigned char *readp = data->d_buf + dwp_off;
 	  const unsigned char *const dataend
 	    = (unsigned char *) data->d_buf + data->d_size;
 
@@ -1314,9 +1686,14 @@ __libdw_link_skel_split (Dwarf_CU *skel, Dwarf_CU *split)
     {
       sdbg->sectiondata[IDX_debug_addr]
 	= dbg->sectiondata[IDX_debug_addr];
-      split->addr_base = __libdw_cu_addr_base (skel);
       sdbg->fake_addr_cu = dbg->fake_addr_cu;
     }
+
+  /* A DWARF package file has split units for all skeletons, each with
+     their own addr_base.  */
+  if (sdbg->sectiondata[IDX_debug_addr] == dbg->sectiondata[IDX_debug_addr]
+      && dbg->sectiondata[IDX_debug_addr] != NULL)
+    split->addr_base = __libdw_cu_addr_base (skel);
 }
 
 
@@ -1369,9 +1746,11 @@ INTDECL (dwarf_formstring)
 INTDECL (dwarf_formudata)
 INTDECL (dwarf_getabbrevattr_data)
 INTDECL (dwarf_getalt)
+INTDECL (dwarf_getdwp)
 INTDECL (dwarf_getarange_addr)
 INTDECL (dwarf_getarangeinfo)
 INTDECL (dwarf_getaranges)
+INTDECL (dwarf_index_aranges)
 INTDECL (dwarf_getlocation_die)
 INTDECL (dwarf_getsrcfiles)
 INTDECL (dwarf_getsrclines)
@@ -1386,6 +1765,7 @@ INTDECL (dwarf_offdie)
 INTDECL (dwarf_peel_type)
 INTDECL (dwarf_ranges)
 INTDECL (dwarf_setalt)
+INTDECL (dwarf_setdwp)
 INTDECL (dwarf_siblingof)
 INTDECL (dwarf_srclang)
 INTDECL (dwarf_tag)
@@ -0,0 +1,136 @@
+/* Decode all units of a Dwarf in several threads.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "libdwP.h"
+
+
+int
+internal_function
+__libdw_unit_dies (Dwarf *dbg, Dwarf_Die **dies, size_t *ndies)
+{
+  Dwarf_Die *result = NULL;
+  size_t n = 0;
+  size_t max = 0;
+  size_t cuhl;
+  Dwarf_Off noff;
+  for (Dwarf_Off off = 0;
+       INTUSE(dwarf_nextcu) (dbg, off, &noff, &cuhl, NULL, NULL, NULL) == 0;
+       off = noff)
+    {
+      if (n == max)
+	{
+	  max = max == 0 ? 64 : 2 * max;
+	  Dwarf_Die *newp = realloc (result, max * sizeof result[0]);
+	  if (newp == NULL)
+	    {
+	      free (result);
+	      __libdw_seterrno (DWARF_E_NOMEM);
+	      return -1;
+	    }
+	  result = newp;
+	}
+
+      if (INTUSE(dwarf_offdie) (dbg, off + cuhl, &result[n]) == NULL)
+	continue;
+      /* Resolve the abbrev of the unit DIE now, so the decoding
+	 threads don't need to look it up.  */
+      (void) INTUSE(dwarf_tag) (&result[n]);
+      ++n;
+    }
+
+  *dies = result;
+  *ndies = n;
+  return 0;
+}
+
+
+struct decode_args
+{
+  void (*decode) (void *arg, size_t idx);
+  void *arg;
+  size_t n;
+  size_t next;
+  pthread_mutex_t lock;
+};
+
+/* Thread function: decode the units not yet taken.  */
+static void *
+decode_units (void *arg)
+{
+  struct decode_args *args = arg;
+
+  while (1)
+    {
+      pthread_mutex_lock (&args->lock);
+      size_t i = args->next++;
+      pthread_mutex_unlock (&args->lock);
+      if (i >= args->n)
+	break;
+
+      args->decode (args->arg, i);
+    }
+
+  return NULL;
+}
+
+void
+internal_function
+__libdw_decode_units (size_t n, unsigned int nthreads,
+		      void (*decode) (void *arg, size_t idx), void *arg)
+{
+  struct decode_args args =
+    {
+      .decode = decode,
+      .arg = arg,
+      .n = n,
+      .next = 0
+    };
+  pthread_mutex_init (&args.lock, NULL);
+  pthread_t *threads = NULL;
+  unsigned int nstarted = 0;
+  if (nthreads > n)
+    nthreads = n;
+  if (nthreads > 1)
+    threads = malloc ((nthreads - 1) * sizeof threads[0]);
+  if (threads != NULL)
+    for (unsigned int i = 0; i < nthreads - 1; ++i)
+      if (pthread_create (&threads[nstarted], NULL, decode_units, &args) == 0)
+	++nstarted;
+  decode_units (&args);
+  for (unsigned int i = 0; i < nstarted; ++i)
+    pthread_join (threads[i], NULL);
+  free (threads);
+  pthread_mutex_destroy (&args.lock);
+}
@@ -0,0 +1,229 @@
+/* Build an index of all DIEs in a unit.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "libdwP.h"
+
+
+/* Temporary representation of one DIE while the index is built.  */
+struct die_info
+{
+  Dwarf_Off offset;
+  unsigned int tag;
+  Dwarf_Abbrev *abbrev;
+  size_t parent;
+  size_t sibling;
+};
+
+Dwarf_Die_Index *
+internal_function
+__libdw_die_index (Dwarf_CU *cu)
+{
+  Dwarf_Die_Index *index
+    = (Dwarf_Die_Index *) atomic_load_explicit (&cu->die_index,
+						memory_order_acquire);
+  if (index != NULL)
+    return index;
+
+  Dwarf *dbg = cu->dbg;
+  struct die_info *dies = NULL;
+  size_t ndies = 0;
+  size_t maxdies = 0;
+
+  /* The open ancestors and the last DIE seen at each level.  */
+  size_t *parents = NULL;
+  size_t *last = NULL;
+  size_t depth = 0;
+  size_t maxdepth = 0;
+
+  Dwarf_Die cudie = CUDIE (cu);
+  const unsigned char *addr = cudie.addr;
+  const unsigned char *endp = cu->endp;
+
+  /* Walk all DIEs in order until the unit DIE is closed.  Some
+     producers might skip the trailing NUL bytes, so also stop at the
+     end of the unit.  */
+  while ((ndies == 0 || depth > 0) && addr < endp)
+    {
+      const unsigned char *readp = addr;
+      unsigned int code;
+      get_uleb128 (code, readp, endp);
+      if (code == 0)
+	{
+	  /* End of a list of siblings.  */
+	  if (depth == 0)
+	    break;
+	  --depth;
+	  addr = readp;
+	  continue;
+	}
+
+      if (ndies == maxdies)
+	{
+	  maxdies = maxdies == 0 ? 64 : 2 * maxdies;
+	  struct die_info *newdies = realloc (dies, maxdies * sizeof dies[0]);
+	  if (newdies == NULL)
+	    goto nomem;
+	  dies = newdies;
+	}
+
+      /* Make room for the open parents and last DIE of this and the
+	 next level.  */
+      if (depth + 2 > maxdepth)
+	{
+	  maxdepth = maxdepth == 0 ? 16 : 2 * maxdepth;
+	  size_t *newparents = realloc (parents, maxdepth * sizeof (size_t));
+	  if (newparents == NULL)
+	    goto nomem;
+	  parents = newparents;
+	  size_t *newlast = realloc (last, maxdepth * sizeof (size_t));
+	  if (newlast == NULL)
+	    goto nomem;
+	  last = newlast;
+	  if (ndies == 0)
+	    last[0] = (size_t) -1;
+	}
+
+      Dwarf_Die die = { .addr = (void *) addr, .cu = cu };
+      Dwarf_Abbrev *abbrev = __libdw_dieabbrev (&die, NULL);
+      if (unlikely (abbrev == DWARF_END_ABBREV))
+	goto invalid;
+
+      /* Skip past the last attribute.  */
+      addr = __libdw_find_attr (&die, INVALID_ATTR, NULL, NULL);
+      if (unlikely (addr == NULL))
+	goto error;
+
+      size_t idx = ndies++;
+      dies[idx].offset = (const unsigned char *) die.addr
+			 - (const unsigned char *) cu->startp;
+      dies[idx].tag = abbrev->tag;
+      dies[idx].abbrev = abbrev;
+      dies[idx].parent = depth > 0 ? parents[depth - 1] : (size_t) -1;
+      dies[idx].sibling = (size_t) -1;
+
+      if (last[depth] != (size_t) -1)
+	dies[last[depth]].sibling = idx;
+      last[depth] = idx;
+
+      if (abbrev->has_children)
+	{
+	  parents[depth++] = idx;
+	  last[depth] = (size_t) -1;
+	}
+    }
+
+  if (unlikely (ndies == 0))
+    goto invalid;
+
+  /* Store the index in struct-of-arrays form in the Dwarf memory, all
+     in one block so it can be given back as a whole.  The arrays of
+     the larger elements come first, so all are aligned.  */
+  size_t size = (sizeof (Dwarf_Die_Index)
+		 + ndies * (sizeof (Dwarf_Off) + sizeof (Dwarf_Abbrev *)
+			    + 2 * sizeof (size_t) + sizeof (unsigned int)));
+  index = libdw_alloc (dbg, Dwarf_Die_Index, size, 1);
+  index->ndies = ndies;
+  index->offsets = (Dwarf_Off *) (index + 1);
+  index->abbrevs = (Dwarf_Abbrev **) (index->offsets + ndies);
+  index->parents = (size_t *) (index->abbrevs + ndies);
+  index->siblings = index->parents + ndies;
+  index->tags = (unsigned int *) (index->siblings + ndies);
+  for (size_t i = 0; i < ndies; ++i)
+    {
+      index->offsets[i] = dies[i].offset;
+      index->tags[i] = dies[i].tag;
+      index->abbrevs[i] = dies[i].abbrev;
+      index->parents[i] = dies[i].parent;
+      index->siblings[i] = dies[i].sibling;
+    }
+
+  free (dies);
+  free (parents);
+  free (last);
+
+  /* Publish the complete index.  If another thread was faster, use
+     that one.  */
+  uintptr_t expected = (uintptr_t) NULL;
+  if (! atomic_compare_exchange_strong_explicit (&cu->die_index, &expected,
+						 (uintptr_t) index,
+						 memory_order_release,
+						 memory_order_acquire))
+    {
+      libdw_unalloc (dbg, Dwarf_Die_Index, size, 1);
+      index = (Dwarf_Die_Index *) expected;
+    }
+  return index;
+
+ nomem:
+  __libdw_seterrno (DWARF_E_NOMEM);
+  goto error;
+ invalid:
+  __libdw_seterrno (DWARF_E_INVALID_DWARF);
+ error:
+  free (dies);
+  free (parents);
+  free (last);
+  return NULL;
+}
+
+
+size_t
+internal_function
+__libdw_die_index_find (Dwarf_Die_Index *index, Dwarf_Die *die)
+{
+  Dwarf_Off offset = ((const unsigned char *) die->addr
+		      - (const unsigned char *) die->cu->startp);
+
+  /* A DIE that came from the index remembers its position, check it
+     still matches, the DIE might have been changed since.  */
+  size_t hint = (size_t) die->padding__;
+  if (hint != 0 && hint <= index->ndies && index->offsets[hint - 1] == offset)
+    return hint - 1;
+
+  /* DIEs are stored in order, so their offsets are sorted.  */
+  size_t l = 0;
+  size_t u = index->ndies;
+  while (l < u)
+    {
+      size_t idx = (l + u) / 2;
+      if (offset < index->offsets[idx])
+	u = idx;
+      else if (offset > index->offsets[idx])
+	l = idx + 1;
+      else
+	return idx;
+    }
+
+  return (size_t) -1;
+}
@@ -86,6 +86,38 @@ try_split_file (Dwarf_CU *cu, const char *dwo_path)
     }
 }
 
+/* Find the split unit for skeleton CU in the DWARF package file DWP,
+   through the unit index by the skeleton id.  */
+static void
+try_split_dwp (Dwarf_CU *cu, Dwarf *dwp)
+{
+  uint32_t row;
+  if (dwp->cu_index == NULL
+      || __libdw_package_index_find (dwp->cu_index, cu->unit_id8,
+				     &row) != 0)
+    return;
+
+  Dwarf_Off offset = __libdw_package_offset (dwp->cu_index, row,
+					     IDX_debug_info);
+  Dwarf_CU *split = __libdw_findcu (dwp, offset, false);
+  if (split != NULL
+      && split->start == offset
+      && split->unit_type == DW_UT_split_compile
+      && cu->unit_id8 == split->unit_id8)
+    {
+      /* All split units come from the same package file, but we only
+	 add it once.  It is ended together with our Dwarf.  */
+      if (tsearch (dwp, &cu->dbg->split_tree, __libdw_finddbg_cb) == NULL)
+	{
+	  __libdw_seterrno (DWARF_E_NOMEM);
+	  return;
+	}
+
+      /* Link skeleton and split compile units.  */
+      __libdw_link_skel_split (cu, split);
+    }
+}
+
 Dwarf_CU *
 internal_function
 __libdw_find_split_unit (Dwarf_CU *cu)
@@ -96,15 +128,21 @@ __libdw_find_split_unit (Dwarf_CU *cu)
 
   /* We need a skeleton unit with a comp_dir and [GNU_]dwo_name attributes.
      The split unit will be the first in the dwo file and should have the
-     same id as the skeleton.  */
+     same id as the skeleton.  But if there is a DWARF package file all
+     split units come from there, so try that first.  */
   if (cu->unit_type == DW_UT_skeleton)
     {
+      Dwarf *dwp = INTUSE(dwarf_getdwp) (cu->dbg);
+      if (dwp != NULL)
+	try_split_dwp (cu, dwp);
+
       Dwarf_Die cudie = CUDIE (cu);
       Dwarf_Attribute dwo_name;
       /* It is fine if dwo_dir doesn't exists, but then dwo_name needs
 	 to be an absolute path.  */
-      if (dwarf_attr (&cudie, DW_AT_dwo_name, &dwo_name) != NULL
-	  || dwarf_attr (&cudie, DW_AT_GNU_dwo_name, &dwo_name) != NULL)
+      if (cu->split == (Dwarf_CU *) -1
+	  && (dwarf_attr (&cudie, DW_AT_dwo_name, &dwo_name) != NULL
+	      || dwarf_attr (&cudie, DW_AT_GNU_dwo_name, &dwo_name) != NULL))
 	{
 	  /* First try the dwo file name in the same directory
 	     as we found the skeleton file.  */
@@ -33,6 +33,7 @@
 
 #include <assert.h>
 #include <search.h>
+#include <stdlib.h>
 #include "libdwP.h"
 
 static int
@@ -95,6 +96,53 @@ __libdw_finddbg_cb (const void *arg1, const void *arg2)
   return 0;
 }
 
+static int
+abbrev_table_cb (const void *arg1, const void *arg2)
+{
+  const Dwarf_Abbrev_Table *t1 = (const Dwarf_Abbrev_Table *) arg1;
+  const Dwarf_Abbrev_Table *t2 = (const Dwarf_Abbrev_Table *) arg2;
+
+  if (t1->offset < t2->offset)
+    return -1;
+  if (t1->offset > t2->offset)
+    return 1;
+  return 0;
+}
+
+/* Get the abbreviation table at OFFSET, creating it if it isn't known
+   yet.  Units using the same table share the abbrevs parsed for it.  */
+static Dwarf_Abbrev_Table *
+intern_abbrev_table (Dwarf *dbg, Dwarf_Off offset)
+{
+  Dwarf_Abbrev_Table fake = { .offset = offset };
+  pthread_mutex_lock (&dbg->abbrev_tables_lock);
+  Dwarf_Abbrev_Table **found = tfind (&fake, &dbg->abbrev_tables,
+				      abbrev_table_cb);
+  if (found != NULL)
+    {
+      pthread_mutex_unlock (&dbg->abbrev_tables_lock);
+      return *found;
+    }
+
+  Dwarf_Abbrev_Table *newp = libdw_typed_alloc (dbg, Dwarf_Abbrev_Table);
+  newp->offset = newp->last_offset = offset;
+  Dwarf_Abbrev_Hash_init (&newp->hash, 41);
+  pthread_mutex_init (&newp->lock, NULL);
+
+  if (tsearch (newp, &dbg->abbrev_tables, abbrev_table_cb) == NULL)
+    {
+      pthread_mutex_unlock (&dbg->abbrev_tables_lock);
+      pthread_mutex_destroy (&newp->lock);
+      Dwarf_Abbrev_Hash_free (&newp->hash);
+      libdw_typed_unalloc (dbg, Dwarf_Abbrev_Table);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return NULL;
+    }
+
+  pthread_mutex_unlock (&dbg->abbrev_tables_lock);
+  return newp;
+}
+
 struct Dwarf_CU *
 internal_function
 __libdw_intern_next_unit (Dwarf *dbg, bool debug_types)
@@ -143,6 +191,30 @@ __libdw_intern_next_unit (Dwarf *dbg, bool debug_types)
   if (unlikely (*offsetp > data->d_size))
     *offsetp = data->d_size;
 
+  /* Units in a DWARF package file have their abbreviations (and other
+     section data) in their own contribution to the section, which we
+     find through the unit index.  */
+  Dwarf_Package_Index *dwp_index = ((debug_types
+				     || unit_type == DW_UT_split_type)
+				    ? dbg->tu_index : dbg->cu_index);
+  uint32_t dwp_row = 0;
+  if (dwp_index != NULL)
+    {
+      if (__libdw_package_index_unit (dwp_index, oldoff, &dwp_row) == 0)
+	abbrev_offset += __libdw_package_offset (dwp_index, dwp_row,
+						 IDX_debug_abbrev);
+      else
+	dwp_index = NULL;
+    }
+
+  /* Find the (possibly shared) abbreviation table.  */
+  Dwarf_Abbrev_Table *abbrevs = intern_abbrev_table (dbg, abbrev_offset);
+  if (unlikely (abbrevs == NULL))
+    {
+      *offsetp = oldoff;
+      return NULL;
+    }
+
   /* Create an entry for this CU.  */
   struct Dwarf_CU *newp = libdw_typed_alloc (dbg, struct Dwarf_CU);
 
@@ -155,11 +227,13 @@ __libdw_intern_next_unit (Dwarf *dbg, bool debug_types)
   newp->version = version;
   newp->unit_id8 = unit_id8;
   newp->subdie_offset = subdie_offset;
-  Dwarf_Abbrev_Hash_init (&newp->abbrev_hash, 41);
-  newp->orig_abbrev_offset = newp->last_abbrev_offset = abbrev_offset;
+  newp->abbrevs = abbrevs;
   newp->files = NULL;
   newp->lines = NULL;
-  newp->locs = NULL;
+  atomic_init (&newp->die_index, (uintptr_t) NULL);
+  atomic_init (&newp->scope_index, (uintptr_t) NULL);
+  newp->dwp_index = dwp_index;
+  newp->dwp_row = dwp_row;
   newp->split = (Dwarf_CU *) -1;
   newp->base_address = (Dwarf_Addr) -1;
   newp->addr_base = (Dwarf_Off) -1;
@@ -232,6 +306,24 @@ __libdw_findcu (Dwarf *dbg, Dwarf_Off start, bool v4_debug_types)
   Dwarf_Off *next_offset
     = v4_debug_types ? &dbg->next_tu_offset : &dbg->next_cu_offset;
 
+  /* If all units were read in advance, just do a binary search.  */
+  if (! v4_debug_types && dbg->cu_array != NULL)
+    {
+      size_t l = 0;
+      size_t u = dbg->cu_array_count;
+      while (l < u)
+	{
+	  size_t idx = (l + u) / 2;
+	  struct Dwarf_CU *cu = dbg->cu_array[idx];
+	  if (start < cu->start)
+	    u = idx;
+	  else if (start >= cu->end)
+	    l = idx + 1;
+	  else
+	    return cu;
+	}
+    }
+
   /* Maybe we already know that CU.  */
   struct Dwarf_CU fake = { .start = start, .end = 0 };
   struct Dwarf_CU **found = tfind (&fake, tree, findcu_cb);
@@ -258,6 +350,77 @@ __libdw_findcu (Dwarf *dbg, Dwarf_Off start, bool v4_debug_types)
   /* NOTREACHED */
 }
 
+int
+internal_function
+__libdw_index_units (Dwarf *dbg)
+{
+  if (dbg->cu_array != NULL)
+    return 0;
+
+  /* Read all the units we haven't seen yet.  */
+  while (__libdw_intern_next_unit (dbg, false) != NULL)
+    ;
+
+  /* Units follow each other, so walking them from the start of the
+     section gives the sorted array.  */
+  struct Dwarf_CU **array = NULL;
+  size_t n = 0;
+  size_t size = 0;
+  Dwarf_Off off = 0;
+  while (off < dbg->next_cu_offset)
+    {
+      struct Dwarf_CU fake = { .start = off, .end = 0 };
+      struct Dwarf_CU **found = tfind (&fake, &dbg->cu_tree, findcu_cb);
+      if (found == NULL || (*found)->end <= off)
+	break;
+
+      if (n == size)
+	{
+	  size = size == 0 ? 16 : 2 * size;
+	  struct Dwarf_CU **newp = realloc (array, size * sizeof (array[0]));
+	  if (newp == NULL)
+	    {
+	      free (array);
+	      __libdw_seterrno (DWARF_E_NOMEM);
+	      return -1;
+	    }
+	  array = newp;
+	}
+      array[n++] = *found;
+      off = (*found)->end;
+    }
+
+  if (array == NULL)
+    return 0;
+
+  if (Dwarf_Sig8_Hash_init (&dbg->cu_die_hash, n) != 0)
+    {
+      free (array);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+  for (size_t i = 0; i < n; ++i)
+    {
+      array[i]->cu_array_idx = i;
+      Dwarf_Sig8_Hash_insert (&dbg->cu_die_hash,
+			      __libdw_first_die_off_from_cu (array[i]),
+			      array[i]);
+    }
+
+  dbg->cu_array = array;
+  dbg->cu_array_count = n;
+  return 0;
+}
+
+struct Dwarf_CU *
+internal_function
+__libdw_findcu_die (Dwarf *dbg, Dwarf_Off dieoff)
+{
+  if (dbg->cu_array == NULL || dieoff == 0)
+    return NULL;
+  return Dwarf_Sig8_Hash_find (&dbg->cu_die_hash, dieoff);
+}
+
 struct Dwarf_CU *
 internal_function
 __libdw_findcu_addr (Dwarf *dbg, void *addr)
@@ -0,0 +1,260 @@
+/* Read the unit indexes of DWARF package files.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include <stdlib.h>
+#include "libdwP.h"
+
+/* The section identifiers of the GNU pre-standard version 2 package
+   file format, used with DWARF 4 split units, that differ from the
+   DWARF 5 DW_SECT values.  */
+#define DW_SECT_GNU_TYPES	2
+#define DW_SECT_GNU_LOC		5
+#define DW_SECT_GNU_MACINFO	7
+#define DW_SECT_GNU_MACRO	8
+
+/* There are only a handful of sections a unit can contribute to.  */
+#define MAX_SECTION_COUNT	255
+
+static int
+section_index (unsigned int version, uint32_t id)
+{
+  switch (id)
+    {
+    case DW_SECT_INFO:
+      return IDX_debug_info;
+    case DW_SECT_ABBREV:
+      return IDX_debug_abbrev;
+    case DW_SECT_LINE:
+      return IDX_debug_line;
+    case DW_SECT_STR_OFFSETS:
+      return IDX_debug_str_offsets;
+    }
+
+  if (version == 5)
+    switch (id)
+      {
+      case DW_SECT_LOCLISTS:
+	return IDX_debug_loclists;
+      case DW_SECT_MACRO:
+	return IDX_debug_macro;
+      case DW_SECT_RNGLISTS:
+	return IDX_debug_rnglists;
+      }
+  else
+    switch (id)
+      {
+      case DW_SECT_GNU_TYPES:
+	return IDX_debug_types;
+      case DW_SECT_GNU_LOC:
+	return IDX_debug_loc;
+      case DW_SECT_GNU_MACINFO:
+	return IDX_debug_macinfo;
+      case DW_SECT_GNU_MACRO:
+	return IDX_debug_macro;
+      }
+
+  return -1;
+}
+
+static int
+compare_units (const void *a, const void *b)
+{
+  const struct Dwarf_Package_Unit *u1 = a;
+  const struct Dwarf_Package_Unit *u2 = b;
+
+  if (u1->offset < u2->offset)
+    return -1;
+  if (u1->offset > u2->offset)
+    return 1;
+  return 0;
+}
+
+Dwarf_Package_Index *
+internal_function
+__libdw_read_package_index (Dwarf *dbg, size_t sec_idx)
+{
+  Elf_Data *data = dbg->sectiondata[sec_idx];
+  if (data == NULL || data->d_size < 16)
+    return NULL;
+
+  /* The header starts with a 4 byte version in the GNU format, or a
+     2 byte version plus 2 bytes padding for DWARF 5.  Then there are
+     the number of sections (columns), units (rows) and hash slots.  */
+  const unsigned char *datap = data->d_buf;
+  unsigned int version = read_4ubyte_unaligned (dbg, datap);
+  if (version != 2)
+    {
+      version = read_2ubyte_unaligned (dbg, datap);
+      if (version != 5)
+	return NULL;
+    }
+
+  uint32_t section_count = read_4ubyte_unaligned (dbg, datap + 4);
+  uint32_t unit_count = read_4ubyte_unaligned (dbg, datap + 8);
+  uint32_t slot_count = read_4ubyte_unaligned (dbg, datap + 12);
+
+  /* The hash table must have room for all units and we probe it with
+     a mask, so the number of slots must be a power of two.  */
+  if (section_count == 0 || section_count > MAX_SECTION_COUNT
+      || unit_count == 0 || unit_count > slot_count
+      || (slot_count & (slot_count - 1)) != 0)
+    return NULL;
+
+  /* After the header come the hash table of 8 byte ids, the 4 byte
+     row numbers for each slot, the 4 byte section ids and then tables
+     of 4 byte offsets and sizes per unit and section.  */
+  uint64_t size = (16 + (uint64_t) slot_count * 12
+		   + (uint64_t) section_count * 4
+		   + (uint64_t) unit_count * section_count * 8);
+  if (size > data->d_size)
+    return NULL;
+
+  Dwarf_Package_Index *index = malloc (sizeof *index);
+  if (index == NULL)
+    return NULL;
+  index->units = malloc (unit_count * sizeof index->units[0]);
+  if (index->units == NULL)
+    {
+      free (index);
+      return NULL;
+    }
+
+  index->dbg = dbg;
+  index->section_count = section_count;
+  index->unit_count = unit_count;
+  index->slot_count = slot_count;
+  index->hash_table = datap + 16;
+  index->indices = index->hash_table + (size_t) slot_count * 8;
+  const unsigned char *ids = index->indices + (size_t) slot_count * 4;
+  index->offsets = ids + (size_t) section_count * 4;
+  index->sizes = index->offsets + (size_t) unit_count * section_count * 4;
+
+  for (size_t i = 0; i < IDX_last; ++i)
+    index->columns[i] = -1;
+  for (uint32_t c = 0; c < section_count; ++c)
+    {
+      int idx = section_index (version,
+			       read_4ubyte_unaligned (dbg, ids + c * 4));
+      if (idx >= 0)
+	index->columns[idx] = c;
+    }
+
+  /* We need to know where the units themselves and their abbreviations
+     are, everything else is optional.  GNU type units are in
+     .debug_types, all others in .debug_info.  */
+  size_t unit_idx = (version == 2 && sec_idx == IDX_debug_tu_index
+		     ? IDX_debug_types : IDX_debug_info);
+  if (index->columns[unit_idx] < 0 || index->columns[IDX_debug_abbrev] < 0)
+    {
+      __libdw_free_package_index (index);
+      return NULL;
+    }
+
+  for (uint32_t row = 0; row < unit_count; ++row)
+    {
+      index->units[row].offset = __libdw_package_offset (index, row,
+							 unit_idx);
+      index->units[row].row = row;
+    }
+  qsort (index->units, unit_count, sizeof index->units[0], compare_units);
+
+  return index;
+}
+
+void
+internal_function
+__libdw_free_package_index (Dwarf_Package_Index *index)
+{
+  if (index != NULL)
+    {
+      free (index->units);
+      free (index);
+    }
+}
+
+int
+internal_function
+__libdw_package_index_find (Dwarf_Package_Index *index, uint64_t id8,
+			    uint32_t *rowp)
+{
+  /* Open addressing with double hashing, as described in the DWARF 5
+     standard section 7.3.5.3.  */
+  uint32_t mask = index->slot_count - 1;
+  uint32_t slot = id8 & mask;
+  uint32_t step = ((id8 >> 32) & mask) | 1;
+  for (uint32_t n = 0; n < index->slot_count; ++n)
+    {
+      uint32_t row = read_4ubyte_unaligned (index->dbg,
+					    index->indices + slot * 4);
+      if (row == 0)
+	/* An empty slot, the id isn't in the table.  */
+	break;
+
+      if (read_8ubyte_unaligned (index->dbg,
+				 index->hash_table + slot * 8) == id8)
+	{
+	  if (row > index->unit_count)
+	    break;
+	  *rowp = row - 1;
+	  return 0;
+	}
+
+      slot = (slot + step) & mask;
+    }
+
+  return -1;
+}
+
+int
+internal_function
+__libdw_package_index_unit (Dwarf_Package_Index *index, Dwarf_Off offset,
+			    uint32_t *rowp)
+{
+  size_t l = 0;
+  size_t u = index->unit_count;
+  while (l < u)
+    {
+      size_t idx = (l + u) / 2;
+      if (offset < index->units[idx].offset)
+	u = idx;
+      else if (offset > index->units[idx].offset)
+	l = idx + 1;
+      else
+	{
+	  *rowp = index->units[idx].row;
+	  return 0;
+	}
+    }
+
+  return -1;
+}
@@ -32,12 +32,13 @@
 
 #include "libdwP.h"
 #include <dwarf.h>
+#include <stdlib.h>
 
 
 static bool
-may_have_scopes (Dwarf_Die *die)
+may_have_scopes (unsigned int tag)
 {
-  switch (INTUSE(dwarf_tag) (die))
+  switch (tag)
     {
       /* DIEs with addresses we can try to match.  */
     case DW_TAG_compile_unit:
@@ -166,7 +167,8 @@ walk_children (struct walk_children_state *state)
 	if (result != DWARF_CB_OK)
 	  return result;
 
-	if (!state->child.prune && may_have_scopes (&state->child.die)
+	if (!state->child.prune
+	    && may_have_scopes (INTUSE(dwarf_tag) (&state->child.die))
 	    && INTUSE(dwarf_haschildren) (&state->child.die))
 	  {
 	    result = __libdw_visit_scopes (state->depth + 1, &state->child, state->imports,
@@ -186,3 +188,41 @@ walk_children (struct walk_children_state *state)
 
   return ret < 0 ? -1 : 0;
 }
+
+int
+internal_function
+__libdw_index_scopes (Dwarf_Die_Index *index, Dwarf_Die *die,
+		      Dwarf_Die **scopes)
+{
+  size_t idx = __libdw_die_index_find (index, die);
+
+  /* The walk never matches the unit DIE it starts from.  */
+  if (idx == (size_t) -1 || index->parents[idx] == (size_t) -1)
+    return 0;
+
+  /* The walk only descends into the DIEs that may have scopes, but
+     always into the unit DIE.  */
+  unsigned int nscopes = 1;
+  for (size_t p = index->parents[idx]; p != (size_t) -1;
+       p = index->parents[p])
+    {
+      if (index->parents[p] != (size_t) -1
+	  && ! may_have_scopes (index->tags[p]))
+	return 0;
+      ++nscopes;
+    }
+
+  Dwarf_Die *result = malloc (nscopes * sizeof result[0]);
+  if (result == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return -1;
+    }
+
+  unsigned int i = 0;
+  for (size_t p = idx; p != (size_t) -1; p = index->parents[p])
+    __libdw_die_index_die (die->cu, index, p, &result[i++]);
+
+  *scopes = result;
+  return nscopes;
+}
@@ -290,7 +290,7 @@ parse_opt (int key, char *arg, struct argp_state *state)
 	      }
 
 	    Elf *core;
-	    Dwfl_Error error = __libdw_open_file (&fd, &core, true, false);
+	    Dwfl_Error error = __libdw_open_file (&fd, &core, true, false, 1);
 	    if (error != DWFL_E_NOERROR)
 	      {
 		argp_failure (state, EXIT_FAILURE, 0,
@@ -33,13 +33,12 @@
 #include "libdwflP.h"
 #include "../libdw/libdwP.h"
 #include "../libdw/memory-access.h"
-#include <search.h>
 
 
 static inline Dwarf_Arange *
 dwar (Dwfl_Module *mod, unsigned int idx)
 {
-  return &mod->dw->aranges->info[mod->aranges[idx].arange];
+  return &mod->dwaranges->info[mod->aranges[idx].arange];
 }
 
 
@@ -51,8 +50,15 @@ addrarange (Dwfl_Module *mod, Dwarf_Addr addr, struct dwfl_arange **arange)
       struct dwfl_arange *aranges = NULL;
       Dwarf_Aranges *dwaranges = NULL;
       size_t naranges;
+
+      /* Not all units might be covered by .debug_aranges, add the ranges
+	 of the others from their unit DIEs.  If that fails we can still
+	 use whatever .debug_aranges has.  */
+      (void) INTUSE(dwarf_index_aranges) (mod->dw,
+					  __libdwfl_nthreads (mod->dwfl));
       if (INTUSE(dwarf_getaranges) (mod->dw, &dwaranges, &naranges) != 0)
 	return DWFL_E_LIBDW;
+      mod->dwaranges = dwaranges;
 
       /* If the module has no aranges (when no code is included) we
 	 allocate nothing.  */
@@ -88,7 +94,6 @@ addrarange (Dwfl_Module *mod, Dwarf_Addr addr, struct dwfl_arange **arange)
 			?: aranges);
       else if (aranges != NULL)
 	free (aranges);
-      mod->lazycu += naranges;
     }
 
   /* The address must be inside the module to begin with.  */
@@ -119,7 +124,7 @@ addrarange (Dwfl_Module *mod, Dwarf_Addr addr, struct dwfl_arange **arange)
 	    {
 	      /* It might be in the last range.  */
 	      const Dwarf_Arange *last
-		= &mod->dw->aranges->info[mod->dw->aranges->naranges - 1];
+		= &mod->dwaranges->info[mod->dwaranges->naranges - 1];
 	      if (addr > last->addr + last->length)
 		break;
 	    }
@@ -133,107 +138,52 @@ addrarange (Dwfl_Module *mod, Dwarf_Addr addr, struct dwfl_arange **arange)
 }
 
 
-static void
-nofree (void *arg)
-{
-  struct dwfl_cu *cu = arg;
-  if (cu == (void *) -1l)
-    return;
-
-  assert (cu->mod->lazycu == 0);
-}
-
-/* One reason fewer to keep the lazy lookup table for CUs.  */
-static inline void
-less_lazy (Dwfl_Module *mod)
-{
-  if (--mod->lazycu > 0)
-    return;
-
-  /* We know about all the CUs now, we don't need this table.  */
-  tdestroy (mod->lazy_cu_root, nofree);
-  mod->lazy_cu_root = NULL;
-}
-
-static inline Dwarf_Off
-cudie_offset (const struct dwfl_cu *cu)
-{
-  return __libdw_first_die_off_from_cu (cu->die.cu);
-}
-
-static int
-compare_cukey (const void *a, const void *b)
-{
-  Dwarf_Off a_off = cudie_offset (a);
-  Dwarf_Off b_off = cudie_offset (b);
-  return (a_off < b_off) ? -1 : ((a_off > b_off) ? 1 : 0);
-}
-
-/* Intern the CU if necessary.  */
+/* Create the table of all CUs in the module, if we don't have it yet.
+   It has the same order (and indexes) as the units in libdw's
+   cu_array.  */
 static Dwfl_Error
-intern_cu (Dwfl_Module *mod, Dwarf_Off cuoff, struct dwfl_cu **result)
+index_cus (Dwfl_Module *mod)
 {
-  if (unlikely (cuoff + 4 >= mod->dw->sectiondata[IDX_debug_info]->d_size))
-    {
-      if (likely (mod->lazycu == 1))
-	{
-	  /* This is the EOF marker.  Now we have interned all the CUs.
-	     One increment in MOD->lazycu counts not having hit EOF yet.  */
-	  *result = (void *) -1;
-	  less_lazy (mod);
-	  return DWFL_E_NOERROR;
-	}
-      else
-	{
-	  /* Unexpected EOF, most likely a bogus aranges.  */
-	  return (DWFL_E (LIBDW, DWARF_E_INVALID_DWARF));
-	}
-    }
+  if (mod->cu != NULL)
+    return DWFL_E_NOERROR;
 
-  /* Make sure the cuoff points to a real DIE.  */
-  Dwarf_Die cudie;
-  Dwarf_Die *die = INTUSE(dwarf_offdie) (mod->dw, cuoff, &cudie);
-  if (die == NULL)
+  if (__libdw_index_units (mod->dw) != 0)
     return DWFL_E_LIBDW;
 
-  struct dwfl_cu key;
-  key.die.cu = die->cu;
-  struct dwfl_cu **found = tsearch (&key, &mod->lazy_cu_root, &compare_cukey);
-  if (unlikely (found == NULL))
+  size_t ncu = mod->dw->cu_array_count;
+  if (ncu == 0)
+    return DWFL_E_NOERROR;
+
+  struct dwfl_cu *cus = calloc (ncu, sizeof cus[0]);
+  if (unlikely (cus == NULL))
     return DWFL_E_NOMEM;
 
-  if (*found == &key || *found == NULL)
+  for (size_t i = 0; i < ncu; ++i)
     {
-      /* This is a new entry, meaning we haven't looked at this CU.  */
-
-      *found = NULL;
-
-      struct dwfl_cu *cu = malloc (sizeof *cu);
-      if (unlikely (cu == NULL))
-	return DWFL_E_NOMEM;
-
-      cu->mod = mod;
-      cu->next = NULL;
-      cu->lines = NULL;
-      cu->die = cudie;
+      cus[i].die = CUDIE (mod->dw->cu_array[i]);
+      cus[i].mod = mod;
+    }
 
-      struct dwfl_cu **newvec = realloc (mod->cu, ((mod->ncu + 1)
-						   * sizeof (mod->cu[0])));
-      if (newvec == NULL)
-	{
-	  free (cu);
-	  return DWFL_E_NOMEM;
-	}
-      mod->cu = newvec;
+  mod->cu = cus;
+  mod->ncu = ncu;
+  return DWFL_E_NOERROR;
+}
 
-      mod->cu[mod->ncu++] = cu;
-      if (cu->die.cu->start == 0)
-	mod->first_cu = cu;
+/* Find the CU with its CU DIE at CUOFF.  The CU table is in the order
+   of libdw's cu_array, so the libdw unit's position there is ours.  */
+static Dwfl_Error
+find_cu (Dwfl_Module *mod, Dwarf_Off cuoff, struct dwfl_cu **result)
+{
+  Dwfl_Error error = index_cus (mod);
+  if (error != DWFL_E_NOERROR)
+    return error;
 
-      *found = cu;
-    }
+  Dwarf_CU *cu = __libdw_findcu_die (mod->dw, cuoff);
+  if (unlikely (cu == NULL) || unlikely (cu->cu_array_idx >= mod->ncu))
+    /* Most likely a bogus aranges.  */
+    return DWFL_E (LIBDW, DWARF_E_INVALID_DWARF);
 
-  *result = *found;
+  *result = &mod->cu[cu->cu_array_idx];
   return DWFL_E_NOERROR;
 }
 
@@ -245,46 +195,12 @@ internal_function
 __libdwfl_nextcu (Dwfl_Module *mod, struct dwfl_cu *lastcu,
 		  struct dwfl_cu **cu)
 {
-  Dwarf_Off cuoff;
-  struct dwfl_cu **nextp;
-
-  if (lastcu == NULL)
-    {
-      /* Start the traversal.  */
-      cuoff = 0;
-      nextp = &mod->first_cu;
-    }
-  else
-    {
-      /* Continue following LASTCU.  */
-      cuoff = lastcu->die.cu->end;
-      nextp = &lastcu->next;
-    }
-
-  if (*nextp == NULL)
-    {
-      size_t cuhdrsz;
-      Dwarf_Off nextoff;
-      int end = INTUSE(dwarf_nextcu) (mod->dw, cuoff, &nextoff, &cuhdrsz,
-				      NULL, NULL, NULL);
-      if (end < 0)
-	return DWFL_E_LIBDW;
-      if (end > 0)
-	{
-	  *cu = NULL;
-	  return DWFL_E_NOERROR;
-	}
-
-      Dwfl_Error result = intern_cu (mod, cuoff + cuhdrsz, nextp);
-      if (result != DWFL_E_NOERROR)
-	return result;
-
-      if (*nextp != (void *) -1
-	  && (*nextp)->next == NULL && nextoff == (Dwarf_Off) -1l)
-	(*nextp)->next = (void *) -1l;
-    }
+  Dwfl_Error error = index_cus (mod);
+  if (error != DWFL_E_NOERROR)
+    return error;
 
-  *cu = *nextp == (void *) -1l ? NULL : *nextp;
+  size_t next = lastcu == NULL ? 0 : (size_t) (lastcu - mod->cu) + 1;
+  *cu = next < mod->ncu ? &mod->cu[next] : NULL;
   return DWFL_E_NOERROR;
 }
 
@@ -296,12 +212,10 @@ arangecu (Dwfl_Module *mod, struct dwfl_arange *arange, struct dwfl_cu **cu)
 {
   if (arange->cu == NULL)
     {
-      const Dwarf_Arange *dwarange = &mod->dw->aranges->info[arange->arange];
-      Dwfl_Error result = intern_cu (mod, dwarange->offset, &arange->cu);
+      const Dwarf_Arange *dwarange = &mod->dwaranges->info[arange->arange];
+      Dwfl_Error result = find_cu (mod, dwarange->offset, &arange->cu);
       if (result != DWFL_E_NOERROR)
 	return result;
-      assert (arange->cu != NULL && arange->cu != (void *) -1l);
-      less_lazy (mod);		/* Each arange with null ->cu counts once.  */
     }
 
   *cu = arange->cu;
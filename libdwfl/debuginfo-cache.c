@@ -0,0 +1,259 @@
+/* Cache of the directories searched for debuginfo files.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwflP.h"
+#include <fcntl.h>
+#include <search.h>
+#include <unistd.h>
+#include "system.h"
+
+/* The entries of one directory, or why we could not read them.  */
+struct probe_dir
+{
+  char *name;
+  /* Zero if ENTRIES is the directory listing, otherwise the errno of
+     opendir.  */
+  int error;
+  size_t nentries;
+  char **entries;		/* Sorted, strings follow the array.  */
+};
+
+static int
+probe_dir_compare (const void *a, const void *b)
+{
+  const struct probe_dir *da = a;
+  const struct probe_dir *db = b;
+  return strcmp (da->name, db->name);
+}
+
+static int
+entry_compare (const void *a, const void *b)
+{
+  return strcmp (*(const char **) a, *(const char **) b);
+}
+
+static void
+probe_dir_free (void *arg)
+{
+  struct probe_dir *pd = arg;
+  free (pd->name);
+  free (pd->entries);
+  free (pd);
+}
+
+/* Read the directory DIRNAME of DIRLEN chars.  Returns NULL only when
+   out of memory.  */
+static struct probe_dir *
+read_probe_dir (const char *dirname, size_t dirlen)
+{
+  struct probe_dir *pd = calloc (1, sizeof *pd);
+  if (unlikely (pd == NULL))
+    return NULL;
+  pd->name = strndup (dirname, dirlen);
+  if (unlikely (pd->name == NULL))
+    {
+      free (pd);
+      return NULL;
+    }
+
+  DIR *dir = opendir (pd->name);
+  if (dir == NULL)
+    {
+      pd->error = errno;
+      return pd;
+    }
+
+  /* Collect the names first, then put the pointer array and the
+     strings in one block.  */
+  size_t nentries = 0;
+  size_t strsize = 0;
+  size_t bufsize = 0;
+  char *buf = NULL;
+  struct dirent *d;
+  while ((d = readdir (dir)) != NULL)
+    {
+      if (strcmp (d->d_name, ".") == 0 || strcmp (d->d_name, "..") == 0)
+	continue;
+      size_t len = strlen (d->d_name) + 1;
+      if (strsize + len > bufsize)
+	{
+	  bufsize = 2 * (strsize + len) + 256;
+	  char *newbuf = realloc (buf, bufsize);
+	  if (unlikely (newbuf == NULL))
+	    goto nomem;
+	  buf = newbuf;
+	}
+      memcpy (&buf[strsize], d->d_name, len);
+      strsize += len;
+      ++nentries;
+    }
+  closedir (dir);
+  dir = NULL;
+
+  pd->entries = malloc (nentries * sizeof (char *) + strsize);
+  if (unlikely (pd->entries == NULL))
+    goto nomem;
+  char *strings = (char *) &pd->entries[nentries];
+  if (strsize > 0)
+    memcpy (strings, buf, strsize);
+  free (buf);
+  for (size_t i = 0; i < nentries; ++i)
+    {
+      pd->entries[i] = strings;
+      strings = rawmemchr (strings, '\0') + 1;
+    }
+  pd->nentries = nentries;
+  qsort (pd->entries, nentries, sizeof (char *), entry_compare);
+  return pd;
+
+ nomem:
+  if (dir != NULL)
+    closedir (dir);
+  free (buf);
+  probe_dir_free (pd);
+  return NULL;
+}
+
+/* Check whether PD says BASE is missing.  Returns the errno to fail
+   with, or zero if the file should be opened.  */
+static int
+probe_dir_check (const struct probe_dir *pd, const char *base)
+{
+  if (pd->error == ENOENT || pd->error == ENOTDIR)
+    return pd->error;
+
+  /* Other errors, like a directory we may search but not read,
+     don't tell us anything.  Just try to open the file.  */
+  if (pd->error == 0
+      && bsearch (&base, pd->entries, pd->nentries, sizeof (char *),
+		  entry_compare) == NULL)
+    return ENOENT;
+
+  return 0;
+}
+
+/* Look up BASE in the cached listing of the directory DIRNAME of
+   DIRLEN chars, reading the directory first if necessary.  The listing
+   might be flushed by another thread, so it is only used with the lock
+   held.  */
+static int
+probe_lookup (Dwfl *dwfl, const char *dirname, size_t dirlen,
+	      const char *base)
+{
+  struct probe_dir key = { .name = strndup (dirname, dirlen) };
+  if (unlikely (key.name == NULL))
+    return 0;
+
+  int error = 0;
+  pthread_mutex_lock (&dwfl->probe_lock);
+  struct probe_dir **found = tfind (&key, &dwfl->probe_dirs,
+				    probe_dir_compare);
+  if (found != NULL)
+    error = probe_dir_check (*found, base);
+  pthread_mutex_unlock (&dwfl->probe_lock);
+  free (key.name);
+  if (found != NULL)
+    return error;
+
+  /* Don't hold the lock while reading the directory, prefetch threads
+     might want other directories in the meantime.  */
+  struct probe_dir *pd = read_probe_dir (dirname, dirlen);
+  if (pd == NULL)
+    return 0;
+
+  pthread_mutex_lock (&dwfl->probe_lock);
+  found = tsearch (pd, &dwfl->probe_dirs, probe_dir_compare);
+  bool inserted = found != NULL && *found == pd;
+  error = probe_dir_check (found != NULL ? *found : pd, base);
+  pthread_mutex_unlock (&dwfl->probe_lock);
+
+  /* Unless we couldn't insert it, or another thread was quicker.  */
+  if (! inserted)
+    probe_dir_free (pd);
+
+  return error;
+}
+
+int
+internal_function
+__libdwfl_open_probe (Dwfl *dwfl, const char *fname)
+{
+  /* Relative names depend on the current directory, which might
+     change between calls, so only absolute directories are cached.  */
+  const char *slash = strrchr (fname, '/');
+  if (dwfl->probe_cache && fname[0] == '/' && slash[1] != '\0')
+    {
+      int error = probe_lookup (dwfl, fname,
+				slash == fname ? 1 : (size_t) (slash - fname),
+				slash + 1);
+      if (error != 0)
+	{
+	  errno = error;
+	  return -1;
+	}
+    }
+
+  return TEMP_FAILURE_RETRY (open (fname, O_RDONLY));
+}
+
+void
+internal_function
+__libdwfl_probe_cache_free (Dwfl *dwfl)
+{
+  tdestroy (dwfl->probe_dirs, probe_dir_free);
+  dwfl->probe_dirs = NULL;
+}
+
+int
+dwfl_set_debuginfo_cache (Dwfl *dwfl, bool cache)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  pthread_mutex_lock (&dwfl->probe_lock);
+  dwfl->probe_cache = cache;
+  if (! cache)
+    __libdwfl_probe_cache_free (dwfl);
+  pthread_mutex_unlock (&dwfl->probe_lock);
+  return 0;
+}
+
+void
+dwfl_flush_debuginfo_cache (Dwfl *dwfl)
+{
+  if (dwfl == NULL)
+    return;
+
+  pthread_mutex_lock (&dwfl->probe_lock);
+  __libdwfl_probe_cache_free (dwfl);
+  pthread_mutex_unlock (&dwfl->probe_lock);
+}
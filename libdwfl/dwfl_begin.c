@@ -44,6 +44,12 @@ dwfl_begin (const Dwfl_Callbacks *callbacks)
   Dwfl *dwfl = calloc (1, sizeof *dwfl);
   if (dwfl == NULL)
     __libdwfl_seterrno (DWFL_E_NOMEM);
+  else if (pthread_mutex_init (&dwfl->probe_lock, NULL) != 0)
+    {
+      free (dwfl);
+      dwfl = NULL;
+      __libdwfl_seterrno (DWFL_E_NOMEM);
+    }
   else
     {
       dwfl->callbacks = callbacks;
@@ -66,7 +66,8 @@ dwfl_build_id_find_debuginfo (Dwfl_Module *mod,
 	     build ID note for validation.  Backdoor the handle into the
 	     module data structure since we had to open it early anyway.  */
 	  Dwfl_Error error = __libdw_open_file (&fd, &mod->alt_elf,
-						true, false);
+						true, false,
+						__libdwfl_nthreads (mod->dwfl));
 	  if (error != DWFL_E_NOERROR)
 	    __libdwfl_seterrno (error);
 	  else
@@ -105,7 +106,8 @@ dwfl_build_id_find_debuginfo (Dwfl_Module *mod,
       /* We need to open an Elf handle on the file so we can check its
 	 build ID note for validation.  Backdoor the handle into the
 	 module data structure since we had to open it early anyway.  */
-      Dwfl_Error error = __libdw_open_file (&fd, &mod->debug.elf, true, false);
+      Dwfl_Error error = __libdw_open_file (&fd, &mod->debug.elf, true, false,
+					    __libdwfl_nthreads (mod->dwfl));
       if (error != DWFL_E_NOERROR)
 	__libdwfl_seterrno (error);
       else if (likely (__libdwfl_find_build_id (mod, false,
@@ -94,7 +94,7 @@ __libdwfl_open_by_build_id (Dwfl_Module *mod, bool debug, char **file_name,
 	break;
       memcpy (mempcpy (name, dir, dirlen), id_name, sizeof id_name);
 
-      fd = TEMP_FAILURE_RETRY (open (name, O_RDONLY));
+      fd = __libdwfl_open_probe (mod->dwfl, name);
       if (fd >= 0)
 	{
 	  if (*file_name != NULL)
@@ -167,7 +167,8 @@ dwfl_build_id_find_elf (Dwfl_Module *mod,
   int fd = __libdwfl_open_mod_by_build_id (mod, false, file_name);
   if (fd >= 0)
     {
-      Dwfl_Error error = __libdw_open_file (&fd, elfp, true, false);
+      Dwfl_Error error = __libdw_open_file (&fd, elfp, true, false,
+					    __libdwfl_nthreads (mod->dwfl));
       if (error != DWFL_E_NOERROR)
 	__libdwfl_seterrno (error);
       else if (__libdwfl_find_build_id (mod, false, *elfp) == 2)
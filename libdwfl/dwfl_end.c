@@ -39,6 +39,8 @@ dwfl_end (Dwfl *dwfl)
   if (dwfl == NULL)
     return;
 
+  __libdwfl_prefetch_end (dwfl);
+
   if (dwfl->process)
     __libdwfl_process_free (dwfl->process);
 
@@ -62,5 +64,9 @@ dwfl_end (Dwfl *dwfl)
 	close (dwfl->user_core->fd);
       free (dwfl->user_core);
     }
+
+  __libdwfl_probe_cache_free (dwfl);
+  pthread_mutex_destroy (&dwfl->probe_lock);
+  free (dwfl->reloc_cache_dir);
   free (dwfl);
 }
@@ -44,19 +44,19 @@ dwfl_lineinfo (Dwfl_Line *line, Dwarf_Addr *addr, int *linep, int *colp,
   const Dwarf_Line *info = &cu->die.cu->lines->info[line->idx];
 
   if (addr != NULL)
-    *addr = dwfl_adjusted_dwarf_addr (cu->mod, info->addr);
+    *addr = dwfl_adjusted_dwarf_addr (cu->mod, __libdw_line_addr (info));
   if (linep != NULL)
     *linep = info->line;
   if (colp != NULL)
     *colp = info->column;
 
-  if (unlikely (info->file >= info->files->nfiles))
+  if (unlikely (info->file >= __libdw_line_files (info)->nfiles))
     {
       __libdwfl_seterrno (DWFL_E (LIBDW, DWARF_E_INVALID_DWARF));
       return NULL;
     }
 
-  struct Dwarf_Fileinfo_s *file = &info->files->info[info->file];
+  struct Dwarf_Fileinfo_s *file = &__libdw_line_files (info)->info[info->file];
   if (mtime != NULL)
     *mtime = file->mtime;
   if (length != NULL)
@@ -32,22 +32,8 @@
 
 #include "libdwflP.h"
 #include "../libdw/cfi.h"
-#include <search.h>
 #include <unistd.h>
 
-static void
-free_cu (struct dwfl_cu *cu)
-{
-  if (cu->lines != NULL)
-    free (cu->lines);
-  free (cu);
-}
-
-static void
-nofree (void *arg __attribute__ ((unused)))
-{
-}
-
 static void
 free_file (struct dwfl_file *file)
 {
@@ -62,16 +48,13 @@ void
 internal_function
 __libdwfl_module_free (Dwfl_Module *mod)
 {
-  if (mod->lazy_cu_root != NULL)
-    tdestroy (mod->lazy_cu_root, nofree);
-
   if (mod->aranges != NULL)
     free (mod->aranges);
 
   if (mod->cu != NULL)
     {
       for (size_t i = 0; i < mod->ncu; ++i)
-	free_cu (mod->cu[i]);
+	free (mod->cu[i].lines);
       free (mod->cu);
     }
 
@@ -119,22 +102,31 @@ __libdwfl_module_free (Dwfl_Module *mod)
   if (mod->reloc_info != NULL)
     free (mod->reloc_info);
 
+  free (mod->symnames);
   free (mod->name);
   free (mod->elfdir);
   free (mod);
 }
 
 void
-dwfl_report_begin_add (Dwfl *dwfl __attribute__ ((unused)))
+dwfl_report_begin_add (Dwfl *dwfl)
 {
   /* The lookup table will be cleared on demand, there is nothing we need
-     to do here.  */
+     to do here but stop loading the modules in the background.  */
+  __libdwfl_prefetch_end (dwfl);
 }
 INTDEF (dwfl_report_begin_add)
 
 void
 dwfl_report_begin (Dwfl *dwfl)
 {
+  /* Modules might be removed, stop loading them in the background.  */
+  __libdwfl_prefetch_end (dwfl);
+
+  /* Debuginfo files might have been installed since the last time,
+     look at the directories again.  */
+  __libdwfl_probe_cache_free (dwfl);
+
   /* Clear the segment lookup table.  */
   dwfl->lookup_elts = 0;
 
@@ -84,6 +84,8 @@ dwfl_module_build_id (Dwfl_Module *mod,
   if (mod == NULL)
     return -1;
 
+  __libdwfl_prefetch_wait (mod);
+
   if (mod->build_id_len == 0 && mod->main.elf != NULL)
     {
       /* We have the file, but have not examined it yet.  */
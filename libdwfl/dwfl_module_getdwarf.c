@@ -40,7 +40,7 @@
 #include "system.h"
 
 static inline Dwfl_Error
-open_elf_file (Elf **elf, int *fd, char **name)
+open_elf_file (Elf **elf, int *fd, char **name, unsigned int nthreads)
 {
   if (*elf == NULL)
     {
@@ -56,7 +56,7 @@ open_elf_file (Elf **elf, int *fd, char **name)
       if (*fd < 0)
 	return CBFAIL;
 
-      return __libdw_open_file (fd, elf, true, false);
+      return __libdw_open_file (fd, elf, true, false, nthreads);
     }
   else if (unlikely (elf_kind (*elf) != ELF_K_ELF))
     {
@@ -76,7 +76,8 @@ open_elf_file (Elf **elf, int *fd, char **name)
 static inline Dwfl_Error
 open_elf (Dwfl_Module *mod, struct dwfl_file *file)
 {
-  Dwfl_Error error = open_elf_file (&file->elf, &file->fd, &file->name);
+  Dwfl_Error error = open_elf_file (&file->elf, &file->fd, &file->name,
+				    __libdwfl_nthreads (mod->dwfl));
   if (error != DWFL_E_NOERROR)
     return error;
 
@@ -210,6 +211,8 @@ void
 internal_function
 __libdwfl_getelf (Dwfl_Module *mod)
 {
+  __libdwfl_prefetch_wait (mod);
+
   if (mod->main.elf != NULL	/* Already done.  */
       || mod->elferr != DWFL_E_NOERROR)	/* Cached failure.  */
     return;
@@ -577,7 +580,8 @@ find_debug_altlink (Dwfl_Module *mod, const char *filename)
 	 Otherwise open either the given file name or use the fd
 	 returned.  */
       Dwfl_Error error = open_elf_file (&mod->alt_elf, &mod->alt_fd,
-					&altfile);
+					&altfile,
+					__libdwfl_nthreads (mod->dwfl));
       if (error == DWFL_E_NOERROR)
 	{
 	  mod->alt = INTUSE(dwarf_begin_elf) (mod->alt_elf,
@@ -695,6 +699,99 @@ enum
   i_max
 };
 
+/* Get the hash table for the dynamic symbols found through the dynamic
+   segment, at file offset HASH_OFF or GNU_HASH_OFF.  The GNU style
+   table is preferred, but only used if it covers MOD->syments.  */
+static void
+find_dynsym_hash (Dwfl_Module *mod, GElf_Off hash_off, GElf_Off gnu_hash_off,
+		  GElf_Ehdr *ehdr)
+{
+  if (gnu_hash_off != 0)
+    {
+      Elf_Data *data = elf_getdata_rawchunk (mod->main.elf, gnu_hash_off,
+					     4 * sizeof (Elf32_Word),
+					     ELF_T_WORD);
+      if (data != NULL)
+	{
+	  const Elf32_Word *header = data->d_buf;
+	  Elf32_Word nbuckets = header[0];
+	  Elf32_Word symndx = header[1];
+	  Elf32_Word maskwords = header[2];
+	  GElf_Off size = (4 * sizeof (Elf32_Word)
+			   + (gelf_getclass (mod->main.elf)
+			      * sizeof (Elf32_Word) * (GElf_Off) maskwords)
+			   + nbuckets * sizeof (Elf32_Word)
+			   + (GElf_Off) (mod->syments - symndx)
+			   * sizeof (Elf32_Word));
+	  // elf_getdata_rawchunk takes a size_t, make sure it
+	  // doesn't overflow.
+#if SIZE_MAX <= UINT32_MAX
+	  if (size > SIZE_MAX)
+	    symndx = mod->syments + 1;
+#endif
+	  if (symndx <= mod->syments)
+	    {
+	      mod->symhashdata = elf_getdata_rawchunk (mod->main.elf,
+						       gnu_hash_off, size,
+						       ELF_T_GNUHASH);
+	      if (mod->symhashdata != NULL)
+		return;
+	    }
+	}
+    }
+
+  if (hash_off != 0)
+    {
+      size_t entsz = SH_ENTSIZE_HASH (ehdr);
+      Elf_Type type = entsz == 4 ? ELF_T_WORD : ELF_T_XWORD;
+      Elf_Data *data = elf_getdata_rawchunk (mod->main.elf, hash_off,
+					     2 * entsz, type);
+      if (data != NULL)
+	{
+	  GElf_Xword nbucket = (entsz == 4
+				? ((const GElf_Word *) data->d_buf)[0]
+				: ((const GElf_Xword *) data->d_buf)[0]);
+	  // elf_getdata_rawchunk takes a size_t, make sure it
+	  // doesn't overflow.
+#if SIZE_MAX <= UINT32_MAX
+	  if (nbucket < SIZE_MAX / 2 / entsz
+	      && mod->syments < SIZE_MAX / 2 / entsz)
+#endif
+	    mod->symhashdata = elf_getdata_rawchunk (mod->main.elf, hash_off,
+						     (2 + nbucket
+						      + mod->syments) * entsz,
+						     type);
+	}
+    }
+}
+
+/* Find the hash table section for the dynamic symbol table SYMSCN.
+   The GNU style table is preferred.  */
+static void
+find_symhash (Dwfl_Module *mod, Elf_Scn *symscn)
+{
+  size_t symndx = elf_ndxscn (symscn);
+  Elf_Scn *hashscn = NULL;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (mod->symfile->elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL || shdr->sh_link != symndx
+	  || (shdr->sh_flags & SHF_COMPRESSED) != 0)
+	continue;
+      if (shdr->sh_type == SHT_GNU_HASH)
+	{
+	  hashscn = scn;
+	  break;
+	}
+      if (shdr->sh_type == SHT_HASH)
+	hashscn = scn;
+    }
+
+  if (hashscn != NULL)
+    mod->symhashdata = elf_getdata (hashscn, NULL);
+}
+
 /* Translate pointers into file offsets.  ADJUST is either zero
    in case the dynamic segment wasn't adjusted or mod->main_bias.
    Will set mod->symfile if the translated offsets can be used as
@@ -816,6 +913,7 @@ translate_offs (GElf_Addr adjust,
 	{
 	  mod->symfile = &mod->main;
 	  mod->symerr = DWFL_E_NOERROR;
+	  find_dynsym_hash (mod, offs[i_hash], offs[i_gnu_hash], ehdr);
 	}
     }
 }
@@ -974,7 +1072,7 @@ find_aux_sym (Dwfl_Module *mod __attribute__ ((unused)),
   void *buffer = NULL;
   size_t size = 0;
   error = __libdw_unlzma (-1, 0, rawdata->d_buf, rawdata->d_size,
-			  &buffer, &size);
+			  &buffer, &size, __libdwfl_nthreads (mod->dwfl));
   if (error == DWFL_E_NOERROR)
     {
       if (unlikely (size == 0))
@@ -1052,6 +1150,8 @@ find_aux_sym (Dwfl_Module *mod __attribute__ ((unused)),
 static void
 find_symtab (Dwfl_Module *mod)
 {
+  __libdwfl_prefetch_wait (mod);
+
   if (mod->symdata != NULL || mod->aux_symdata != NULL	/* Already done.  */
       || mod->symerr != DWFL_E_NOERROR) /* Cached previous failure.  */
     return;
@@ -1133,6 +1233,7 @@ find_symtab (Dwfl_Module *mod)
     {
     elferr:
       mod->symdata = NULL;
+      mod->symhashdata = NULL;
       mod->syments = 0;
       mod->first_global = 0;
       mod->symerr = DWFL_E (LIBELF, elf_errno ());
@@ -1211,6 +1312,10 @@ find_symtab (Dwfl_Module *mod)
       || (size_t) mod->first_global > mod->syments)
     goto elferr;
 
+  /* A dynamic symbol table can be searched by name with its hash table.  */
+  if (shdr->sh_type == SHT_DYNSYM)
+    find_symhash (mod, symscn);
+
   /* Cache any auxiliary symbol info, when it fails, just ignore aux_sym.  */
   if (aux_symscn != NULL)
     {
@@ -1302,6 +1407,8 @@ Dwfl_Error
 internal_function
 __libdwfl_module_getebl (Dwfl_Module *mod)
 {
+  __libdwfl_prefetch_wait (mod);
+
   if (mod->ebl == NULL)
     {
       __libdwfl_getelf (mod);
@@ -1369,9 +1476,6 @@ load_dw (Dwfl_Module *mod, struct dwfl_file *debugfile)
       && debugfile == &mod->main)
     mod->dw->debugdir = strdup (mod->elfdir);
 
-  /* Until we have iterated through all CU's, we might do lazy lookups.  */
-  mod->lazycu = 1;
-
   return DWFL_E_NOERROR;
 }
 
@@ -1379,6 +1483,8 @@ load_dw (Dwfl_Module *mod, struct dwfl_file *debugfile)
 static void
 find_dw (Dwfl_Module *mod)
 {
+  __libdwfl_prefetch_wait (mod);
+
   if (mod->dw != NULL		/* Already done.  */
       || mod->dwerr != DWFL_E_NOERROR) /* Cached previous failure.  */
     return;
@@ -61,8 +61,7 @@ dwfl_module_getsrc (Dwfl_Module *mod, Dwarf_Addr addr)
 	  while (l < u)
 	    {
 	      size_t idx = u - (u - l) / 2;
-	      Dwarf_Line *line = &lines->info[idx];
-	      if (addr < line->addr)
+	      if (addr < __libdw_lines_addr (lines, idx))
 		u = idx - 1;
 	      else
 		l = idx;
@@ -72,7 +71,7 @@ dwfl_module_getsrc (Dwfl_Module *mod, Dwarf_Addr addr)
 	     we want, unless it is the end_sequence which is after the
 	     current line sequence.  */
 	  Dwarf_Line *line = &lines->info[l];
-	  if (! line->end_sequence && line->addr <= addr)
+	  if (! line->end_sequence && __libdw_lines_addr (lines, l) <= addr)
 	    return &cu->lines->idx[l];
 	}
 
@@ -37,7 +37,7 @@
 static inline const char *
 dwfl_dwarf_line_file (const Dwarf_Line *line)
 {
-  return line->files->info[line->file].name;
+  return __libdw_line_files (line)->info[line->file].name;
 }
 
 static inline Dwarf_Line *
@@ -89,7 +89,7 @@ dwfl_module_getsrc_file (Dwfl_Module *mod,
 	{
 	  Dwarf_Line *line = &cu->die.cu->lines->info[cnt];
 
-	  if (unlikely (line->file >= line->files->nfiles))
+	  if (unlikely (line->file >= __libdw_line_files (line)->nfiles))
 	    {
 	      if (*nsrcs == 0)
 		free (match);
@@ -32,71 +32,93 @@
 
 #include "libdwflP.h"
 
-const char *
-internal_function
-__libdwfl_getsym (Dwfl_Module *mod, int ndx, GElf_Sym *sym, GElf_Addr *addr,
-		  GElf_Word *shndxp, Elf **elfp, Dwarf_Addr *biasp,
-		  bool *resolved, bool adjust_st_value)
+/* Get the raw symbol NDX from the main or the auxiliary symbol table.
+   Also returns the Elf and string table data it comes from.  */
+static GElf_Sym *
+getsym_raw (Dwfl_Module *mod, int ndx, GElf_Sym *sym, GElf_Word *shndx,
+	    Elf **elfp, Elf_Data **symstrdatap)
 {
-  if (unlikely (mod == NULL))
-    return NULL;
-
-  if (unlikely (mod->symdata == NULL))
-    {
-      int result = INTUSE(dwfl_module_getsymtab) (mod);
-      if (result < 0)
-	return NULL;
-    }
-
   /* All local symbols should come before all global symbols.  If we
      have an auxiliary table make sure all the main locals come first,
      then all aux locals, then all main globals and finally all aux globals.
      And skip the auxiliary table zero undefined entry.  */
-  GElf_Word shndx;
   int tndx = ndx;
   int skip_aux_zero = (mod->syments > 0 && mod->aux_syments > 0) ? 1 : 0;
-  Elf *elf;
   Elf_Data *symdata;
   Elf_Data *symxndxdata;
-  Elf_Data *symstrdata;
   if (mod->aux_symdata == NULL
       || ndx < mod->first_global)
     {
       /* main symbol table (locals).  */
       tndx = ndx;
-      elf = mod->symfile->elf;
+      *elfp = mod->symfile->elf;
       symdata = mod->symdata;
       symxndxdata = mod->symxndxdata;
-      symstrdata = mod->symstrdata;
+      *symstrdatap = mod->symstrdata;
     }
   else if (ndx < mod->first_global + mod->aux_first_global - skip_aux_zero)
     {
       /* aux symbol table (locals).  */
       tndx = ndx - mod->first_global + skip_aux_zero;
-      elf = mod->aux_sym.elf;
+      *elfp = mod->aux_sym.elf;
       symdata = mod->aux_symdata;
       symxndxdata = mod->aux_symxndxdata;
-      symstrdata = mod->aux_symstrdata;
+      *symstrdatap = mod->aux_symstrdata;
     }
   else if ((size_t) ndx < mod->syments + mod->aux_first_global - skip_aux_zero)
     {
       /* main symbol table (globals).  */
       tndx = ndx - mod->aux_first_global + skip_aux_zero;
-      elf = mod->symfile->elf;
+      *elfp = mod->symfile->elf;
       symdata = mod->symdata;
       symxndxdata = mod->symxndxdata;
-      symstrdata = mod->symstrdata;
+      *symstrdatap = mod->symstrdata;
     }
   else
     {
       /* aux symbol table (globals).  */
       tndx = ndx - mod->syments + skip_aux_zero;
-      elf = mod->aux_sym.elf;
+      *elfp = mod->aux_sym.elf;
       symdata = mod->aux_symdata;
       symxndxdata = mod->aux_symxndxdata;
-      symstrdata = mod->aux_symstrdata;
+      *symstrdatap = mod->aux_symstrdata;
     }
-  sym = gelf_getsymshndx (symdata, symxndxdata, tndx, sym, &shndx);
+  return gelf_getsymshndx (symdata, symxndxdata, tndx, sym, shndx);
+}
+
+const char *
+internal_function
+__libdwfl_getsym_name (Dwfl_Module *mod, int ndx, GElf_Sym *sym)
+{
+  GElf_Word shndx;
+  Elf *elf;
+  Elf_Data *symstrdata;
+  if (getsym_raw (mod, ndx, sym, &shndx, &elf, &symstrdata) == NULL
+      || sym->st_name >= symstrdata->d_size)
+    return NULL;
+  return (const char *) symstrdata->d_buf + sym->st_name;
+}
+
+const char *
+internal_function
+__libdwfl_getsym (Dwfl_Module *mod, int ndx, GElf_Sym *sym, GElf_Addr *addr,
+		  GElf_Word *shndxp, Elf **elfp, Dwarf_Addr *biasp,
+		  bool *resolved, bool adjust_st_value)
+{
+  if (unlikely (mod == NULL))
+    return NULL;
+
+  if (unlikely (mod->symdata == NULL))
+    {
+      int result = INTUSE(dwfl_module_getsymtab) (mod);
+      if (result < 0)
+	return NULL;
+    }
+
+  GElf_Word shndx;
+  Elf *elf;
+  Elf_Data *symstrdata;
+  sym = getsym_raw (mod, ndx, sym, &shndx, &elf, &symstrdata);
 
   if (unlikely (sym == NULL))
     {
@@ -41,6 +41,8 @@ dwfl_module_info (Dwfl_Module *mod, void ***userdata,
   if (mod == NULL)
     return NULL;
 
+  __libdwfl_prefetch_wait (mod);
+
   if (userdata)
     *userdata = &mod->userdata;
   if (start)
@@ -0,0 +1,281 @@
+/* Find a symbol in a module by name.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwflP.h"
+#include "../libelf/elf-knowledge.h"
+
+/* An entry in Dwfl_Module.symnames.  NDX zero means the entry is free,
+   symbol zero is always undefined and never looked up.  */
+struct dwfl_symname
+{
+  Elf32_Word hash;
+  int ndx;
+};
+
+/* Whether the symbol should be found by name at all.  */
+static bool
+lookup_symbol (const GElf_Sym *sym, const char *name)
+{
+  return (name != NULL && name[0] != '\0'
+	  && sym->st_shndx != SHN_UNDEF
+	  && GELF_ST_TYPE (sym->st_info) != STT_SECTION
+	  && GELF_ST_TYPE (sym->st_info) != STT_FILE);
+}
+
+/* Global symbols are preferred over weak ones, and those over locals.  */
+static int
+binding_rank (const GElf_Sym *sym)
+{
+  switch (GELF_ST_BIND (sym->st_info))
+    {
+    case STB_GLOBAL:
+      return 2;
+    case STB_WEAK:
+      return 1;
+    default:
+      return 0;
+    }
+}
+
+/* Consider symbol NDX for NAME.  If it is better than *BEST, of rank
+   *BEST_RANK, make it the new *BEST.  Versioned symbols of the same name
+   are ranked like any others.  */
+static void
+rank_symbol (Dwfl_Module *mod, const char *name, int ndx,
+	     int *best, int *best_rank)
+{
+  GElf_Sym sym;
+  const char *symname = __libdwfl_getsym_name (mod, ndx, &sym);
+  if (symname == NULL || strcmp (symname, name) != 0
+      || ! lookup_symbol (&sym, symname))
+    return;
+
+  /* Of equally good symbols the first one wins.  */
+  int rank = binding_rank (&sym);
+  if (rank > *best_rank || (rank == *best_rank && ndx < *best))
+    {
+      *best = ndx;
+      *best_rank = rank;
+    }
+}
+
+/* Look up NAME with HASH in the .gnu.hash table of the dynamic symbols.
+   Returns the best symbol index, zero if NAME isn't there or -1 if the
+   table cannot be used.  */
+static int
+lookup_gnu_hash (Dwfl_Module *mod, const char *name, Elf32_Word hash)
+{
+  Elf_Data *data = mod->symhashdata;
+  const Elf32_Word *words = data->d_buf;
+  if (data->d_size < 4 * sizeof (Elf32_Word))
+    return -1;
+
+  Elf32_Word nbuckets = words[0];
+  Elf32_Word symndx = words[1];
+  Elf32_Word maskwords = words[2];
+  Elf32_Word shift2 = words[3];
+  unsigned int bits = (gelf_getclass (mod->symfile->elf) == ELFCLASS64
+		       ? 64 : 32);
+  size_t bloom_words = maskwords * (bits / 32);
+  size_t nwords = data->d_size / sizeof (Elf32_Word);
+  if (nbuckets == 0 || maskwords == 0 || (maskwords & (maskwords - 1)) != 0
+      || bloom_words > nwords - 4 || nbuckets > nwords - 4 - bloom_words)
+    return -1;
+
+  /* The bloom filter rejects most names that aren't there.  */
+  const void *bloom = &words[4];
+  size_t bloom_ndx = (hash / bits) & (maskwords - 1);
+  uint64_t mask = ((UINT64_C (1) << (hash % bits))
+		   | (UINT64_C (1) << ((hash >> shift2) % bits)));
+  uint64_t word = (bits == 64
+		   ? ((const Elf64_Xword *) bloom)[bloom_ndx]
+		   : ((const Elf32_Word *) bloom)[bloom_ndx]);
+  if ((word & mask) != mask)
+    return 0;
+
+  const Elf32_Word *buckets = &words[4 + bloom_words];
+  const Elf32_Word *chain = &buckets[nbuckets];
+  size_t nchain = nwords - 4 - bloom_words - nbuckets;
+  Elf32_Word ndx = buckets[hash % nbuckets];
+  if (ndx == 0)
+    return 0;
+  if (ndx < symndx)
+    return -1;
+
+  /* The whole chain has to be searched, there might be several
+     symbols of that name with different bindings or versions.  */
+  int best = 0;
+  int best_rank = -1;
+  for (; ndx - symndx < nchain && ndx < mod->syments; ++ndx)
+    {
+      Elf32_Word h = chain[ndx - symndx];
+      if ((h | 1) == (hash | 1))
+	rank_symbol (mod, name, ndx, &best, &best_rank);
+      if ((h & 1) != 0)
+	return best;
+    }
+
+  return -1;
+}
+
+/* Look up NAME in the SysV .hash table of the dynamic symbols.  Returns
+   the best symbol index, zero if NAME isn't there or -1 if the table
+   cannot be used.  */
+static int
+lookup_sysv_hash (Dwfl_Module *mod, const char *name)
+{
+  /* Only tables of 4 byte words, the 8 byte variant of some
+     architectures isn't worth the trouble.  */
+  Elf_Data *data = mod->symhashdata;
+  GElf_Ehdr ehdr_mem;
+  GElf_Ehdr *ehdr = gelf_getehdr (mod->symfile->elf, &ehdr_mem);
+  if (ehdr == NULL || SH_ENTSIZE_HASH (ehdr) != sizeof (Elf32_Word)
+      || data->d_size < 2 * sizeof (Elf32_Word))
+    return -1;
+
+  const Elf32_Word *words = data->d_buf;
+  Elf32_Word nbucket = words[0];
+  Elf32_Word nchain = words[1];
+  size_t nwords = data->d_size / sizeof (Elf32_Word);
+  if (nbucket == 0 || nbucket > nwords - 2 || nchain > nwords - 2 - nbucket)
+    return -1;
+
+  const Elf32_Word *buckets = &words[2];
+  const Elf32_Word *chain = &buckets[nbucket];
+  Elf32_Word ndx = buckets[elf_hash (name) % nbucket];
+  int best = 0;
+  int best_rank = -1;
+  for (Elf32_Word n = 0; ndx != STN_UNDEF && n < nchain; ++n)
+    {
+      if (ndx >= nchain || ndx >= mod->syments)
+	return -1;
+
+      rank_symbol (mod, name, ndx, &best, &best_rank);
+      ndx = chain[ndx];
+    }
+
+  return ndx == STN_UNDEF ? best : -1;
+}
+
+/* Build the hash table of all symbols in the module, NSYMS of them.  */
+static bool
+index_symnames (Dwfl_Module *mod, int nsyms)
+{
+  size_t size = 16;
+  while (size < 2 * (size_t) nsyms)
+    size *= 2;
+  struct dwfl_symname *symnames = calloc (size, sizeof *symnames);
+  if (unlikely (symnames == NULL))
+    return false;
+
+  for (int ndx = 1; ndx < nsyms; ++ndx)
+    {
+      GElf_Sym sym;
+      const char *name = __libdwfl_getsym_name (mod, ndx, &sym);
+      if (! lookup_symbol (&sym, name))
+	continue;
+
+      Elf32_Word hash = elf_gnu_hash (name);
+      size_t i = hash & (size - 1);
+      while (symnames[i].ndx != 0)
+	i = (i + 1) & (size - 1);
+      symnames[i].hash = hash;
+      symnames[i].ndx = ndx;
+    }
+
+  mod->symnames = symnames;
+  mod->nsymnames = size;
+  return true;
+}
+
+/* Look up NAME with HASH in the index of all symbols.  Returns the
+   symbol index or zero if there is no such symbol.  */
+static int
+lookup_symnames (Dwfl_Module *mod, const char *name, Elf32_Word hash)
+{
+  int best = 0;
+  int best_rank = -1;
+  size_t mask = mod->nsymnames - 1;
+  for (size_t i = hash & mask; mod->symnames[i].ndx != 0; i = (i + 1) & mask)
+    if (mod->symnames[i].hash == hash)
+      rank_symbol (mod, name, mod->symnames[i].ndx, &best, &best_rank);
+
+  return best;
+}
+
+int
+dwfl_module_namesym (Dwfl_Module *mod, const char *name, GElf_Sym *sym,
+		     GElf_Addr *addr, GElf_Word *shndxp,
+		     Elf **elfp, Dwarf_Addr *bias)
+{
+  if (unlikely (mod == NULL))
+    return -1;
+
+  int nsyms = INTUSE(dwfl_module_getsymtab) (mod);
+  if (nsyms < 0)
+    return -1;
+
+  Elf32_Word hash = elf_gnu_hash (name);
+  int ndx = -1;
+
+  /* The dynamic symbol table comes with its own hash table, unless
+     the auxiliary symbol table is merged in.  */
+  if (mod->symhashdata != NULL && mod->aux_symdata == NULL)
+    {
+      if (mod->symhashdata->d_type == ELF_T_GNUHASH)
+	ndx = lookup_gnu_hash (mod, name, hash);
+      else
+	ndx = lookup_sysv_hash (mod, name);
+    }
+
+  if (ndx < 0)
+    {
+      if (mod->symnames == NULL && ! index_symnames (mod, nsyms))
+	{
+	  __libdwfl_seterrno (DWFL_E_NOMEM);
+	  return -1;
+	}
+      ndx = lookup_symnames (mod, name, hash);
+    }
+
+  if (ndx == 0)
+    {
+      __libdwfl_seterrno (DWFL_E_NOERROR);
+      return -1;
+    }
+
+  bool resolved;
+  if (__libdwfl_getsym (mod, ndx, sym, addr, shndxp, elfp, bias,
+			&resolved, false) == NULL)
+    return -1;
+  return ndx;
+}
@@ -41,6 +41,8 @@ dwfl_module_report_build_id (Dwfl_Module *mod,
   if (mod == NULL)
     return -1;
 
+  __libdwfl_prefetch_wait (mod);
+
   if (mod->main.elf != NULL)
     {
       /* Once we know about a file, we won't take any lies about
@@ -0,0 +1,202 @@
+/* Open debuginfo of all modules in background threads.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwflP.h"
+#include <pthread.h>
+
+/* The states of a module in Dwfl_Module.prefetch.  */
+enum
+  {
+    prefetch_none = 0,		/* Not prefetched, or already done.  */
+    prefetch_queued,		/* Waiting for a thread.  */
+    prefetch_running,		/* A thread is loading the module.  */
+  };
+
+struct dwfl_prefetch
+{
+  pthread_mutex_t lock;
+  pthread_cond_t done;
+
+  /* The modules reported when the prefetch was started.  */
+  Dwfl_Module **mods;
+  size_t nmods;
+  size_t next;
+
+  pthread_t *threads;
+  unsigned int nthreads;
+};
+
+/* Load everything the first lookups in MOD would load.  Relocatable
+   modules need the symbol tables of other modules to be relocated, so
+   for those we just open the main ELF file.  */
+static void
+prefetch_module (Dwfl_Module *mod)
+{
+  __libdwfl_getelf (mod);
+  if (mod->elferr != DWFL_E_NOERROR || mod->e_type == ET_REL)
+    return;
+
+  Dwarf_Addr bias;
+  (void) INTUSE(dwfl_module_getdwarf) (mod, &bias);
+  (void) INTUSE(dwfl_module_getsymtab) (mod);
+}
+
+static void *
+prefetch_thread (void *arg)
+{
+  struct dwfl_prefetch *pf = arg;
+
+  pthread_mutex_lock (&pf->lock);
+  while (pf->next < pf->nmods)
+    {
+      Dwfl_Module *mod = pf->mods[pf->next++];
+      if (mod->prefetch != prefetch_queued)
+	continue;
+
+      mod->prefetch = prefetch_running;
+      mod->prefetch_owner = pthread_self ();
+      pthread_mutex_unlock (&pf->lock);
+
+      prefetch_module (mod);
+
+      pthread_mutex_lock (&pf->lock);
+      mod->prefetch = prefetch_none;
+      pthread_cond_broadcast (&pf->done);
+    }
+  pthread_mutex_unlock (&pf->lock);
+
+  return NULL;
+}
+
+void
+internal_function
+__libdwfl_prefetch_wait (Dwfl_Module *mod)
+{
+  struct dwfl_prefetch *pf = mod->dwfl->prefetch;
+  if (pf == NULL)
+    return;
+
+  pthread_mutex_lock (&pf->lock);
+  if (mod->prefetch == prefetch_queued)
+    /* No thread got to it yet, the caller will load it itself.  */
+    mod->prefetch = prefetch_none;
+  else if (mod->prefetch == prefetch_running
+	   && ! pthread_equal (mod->prefetch_owner, pthread_self ()))
+    while (mod->prefetch != prefetch_none)
+      pthread_cond_wait (&pf->done, &pf->lock);
+  pthread_mutex_unlock (&pf->lock);
+}
+
+void
+internal_function
+__libdwfl_prefetch_end (Dwfl *dwfl)
+{
+  struct dwfl_prefetch *pf = dwfl->prefetch;
+  if (pf == NULL)
+    return;
+
+  /* Don't start any new modules, but let the running ones finish.  */
+  pthread_mutex_lock (&pf->lock);
+  for (size_t i = 0; i < pf->nmods; ++i)
+    if (pf->mods[i]->prefetch == prefetch_queued)
+      pf->mods[i]->prefetch = prefetch_none;
+  pf->next = pf->nmods;
+  pthread_mutex_unlock (&pf->lock);
+
+  for (unsigned int i = 0; i < pf->nthreads; ++i)
+    pthread_join (pf->threads[i], NULL);
+
+  pthread_cond_destroy (&pf->done);
+  pthread_mutex_destroy (&pf->lock);
+  free (pf->threads);
+  free (pf->mods);
+  free (pf);
+  dwfl->prefetch = NULL;
+}
+
+int
+dwfl_prefetch_debuginfo (Dwfl *dwfl, unsigned int nthreads)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  __libdwfl_prefetch_end (dwfl);
+
+  size_t nmods = 0;
+  for (Dwfl_Module *mod = dwfl->modulelist; mod != NULL; mod = mod->next)
+    if (! mod->gc)
+      ++nmods;
+  if (nmods == 0 || nthreads == 0)
+    return 0;
+  if (nthreads > nmods)
+    nthreads = nmods;
+
+  struct dwfl_prefetch *pf = calloc (1, sizeof *pf);
+  if (pf == NULL)
+    goto nomem;
+  pf->mods = malloc (nmods * sizeof pf->mods[0]);
+  pf->threads = malloc (nthreads * sizeof pf->threads[0]);
+  if (pf->mods == NULL || pf->threads == NULL)
+    {
+      free (pf->mods);
+      free (pf->threads);
+      free (pf);
+      goto nomem;
+    }
+
+  for (Dwfl_Module *mod = dwfl->modulelist; mod != NULL; mod = mod->next)
+    if (! mod->gc)
+      {
+	mod->prefetch = prefetch_queued;
+	pf->mods[pf->nmods++] = mod;
+      }
+
+  pthread_mutex_init (&pf->lock, NULL);
+  pthread_cond_init (&pf->done, NULL);
+  dwfl->prefetch = pf;
+
+  for (unsigned int i = 0; i < nthreads; ++i)
+    if (pthread_create (&pf->threads[pf->nthreads], NULL,
+			prefetch_thread, pf) == 0)
+      ++pf->nthreads;
+
+  /* If no thread could be started, nothing gets prefetched, but all
+     modules are still loaded on demand as usual.  */
+  if (pf->nthreads == 0)
+    __libdwfl_prefetch_end (dwfl);
+
+  return 0;
+
+ nomem:
+  __libdwfl_seterrno (DWFL_E_NOMEM);
+  return -1;
+}
@@ -304,7 +304,8 @@ dwfl_report_elf (Dwfl *dwfl, const char *name, const char *file_name, int fd,
     }
 
   Elf *elf;
-  Dwfl_Error error = __libdw_open_file (&fd, &elf, closefd, false);
+  Dwfl_Error error = __libdw_open_file (&fd, &elf, closefd, false,
+					__libdwfl_nthreads (dwfl));
   if (error != DWFL_E_NOERROR)
     {
       __libdwfl_seterrno (error);
@@ -724,7 +724,8 @@ dwfl_segment_report_module (Dwfl *dwfl, int ndx, const char *name,
       fd = open (name, O_RDONLY);
       if (fd >= 0)
 	{
-	  Dwfl_Error error = __libdw_open_file (&fd, &elf, true, false);
+	  Dwfl_Error error = __libdw_open_file (&fd, &elf, true, false,
+						__libdwfl_nthreads (dwfl));
 	  if (error == DWFL_E_NOERROR)
 	    invalid = invalid_elf (elf, true /* disk_file_has_build_id */,
 				   build_id, build_id_len);
@@ -0,0 +1,59 @@
+/* Set how many threads libdwfl may use for one module.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <unistd.h>
+
+#include "libdwflP.h"
+
+int
+dwfl_set_threads (Dwfl *dwfl, unsigned int nthreads)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  dwfl->nthreads = nthreads;
+  return 0;
+}
+
+unsigned int
+internal_function
+__libdwfl_nthreads (Dwfl *dwfl)
+{
+  unsigned int nthreads = dwfl->nthreads;
+  if (nthreads > 1)
+    {
+      long int ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+      if (ncpus > 0 && nthreads > (unsigned long int) ncpus)
+	nthreads = ncpus;
+    }
+  return nthreads ?: 1;
+}
@@ -41,7 +41,7 @@
 /* Try to open [DIR/][SUBDIR/]DEBUGLINK, return file descriptor or -1.
    On success, *DEBUGINFO_FILE_NAME has the malloc'd name of the open file.  */
 static int
-try_open (const struct stat *main_stat,
+try_open (Dwfl *dwfl, const struct stat *main_stat,
 	  const char *dir, const char *subdir, const char *debuglink,
 	  char **debuginfo_file_name)
 {
@@ -58,7 +58,7 @@ try_open (const struct stat *main_stat,
     return -1;
 
   struct stat st;
-  int fd = TEMP_FAILURE_RETRY (open (fname, O_RDONLY));
+  int fd = __libdwfl_open_probe (dwfl, fname);
   if (fd < 0)
     free (fname);
   else if (fstat (fd, &st) == 0
@@ -104,7 +104,8 @@ validate (Dwfl_Module *mod, int fd, bool check, GElf_Word debuglink_crc)
 	     build ID note for validation.  Backdoor the handle into the
 	     module data structure since we had to open it early anyway.  */
 	  Dwfl_Error error = __libdw_open_file (&fd, &mod->alt_elf,
-						false, false);
+						false, false,
+						__libdwfl_nthreads (mod->dwfl));
 	  if (error != DWFL_E_NOERROR)
 	    __libdwfl_seterrno (error);
 	  else
@@ -136,7 +137,8 @@ validate (Dwfl_Module *mod, int fd, bool check, GElf_Word debuglink_crc)
 	 module data structure since we had to open it early anyway.  */
 
       mod->debug.valid = false;
-      Dwfl_Error error = __libdw_open_file (&fd, &mod->debug.elf, false, false);
+      Dwfl_Error error = __libdw_open_file (&fd, &mod->debug.elf, false, false,
+					    __libdwfl_nthreads (mod->dwfl));
       if (error != DWFL_E_NOERROR)
 	__libdwfl_seterrno (error);
       else if (likely (__libdwfl_find_build_id (mod, false,
@@ -294,9 +296,10 @@ find_debuginfo_in_path (Dwfl_Module *mod, const char *file_name,
 	}
 
       char *fname = NULL;
-      int fd = try_open (&main_stat, dir, subdir, file, &fname);
+      int fd = try_open (mod->dwfl, &main_stat, dir, subdir, file, &fname);
       if (fd < 0 && try_file_basename)
-	fd = try_open (&main_stat, dir, subdir, file_basename, &fname);
+	fd = try_open (mod->dwfl, &main_stat, dir, subdir, file_basename,
+		       &fname);
       if (fd < 0)
 	switch (errno)
 	  {
@@ -306,7 +309,7 @@ find_debuginfo_in_path (Dwfl_Module *mod, const char *file_name,
 	       But only if this is the empty or absolute path.  */
 	    if (mod->dw != NULL && (p[0] == '\0' || p[0] == '/'))
 	      {
-		fd = try_open (&main_stat, dir, ".dwz",
+		fd = try_open (mod->dwfl, &main_stat, dir, ".dwz",
 			       basename (file), &fname);
 		if (fd < 0)
 		  {
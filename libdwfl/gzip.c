@@ -45,7 +45,7 @@
 # define Z(what)	LZMA_##what
 # define LZMA_ERRNO	LZMA_PROG_ERROR
 # define z_stream	lzma_stream
-# define inflateInit(z)	lzma_auto_decoder (z, 1 << 30, 0)
+# define inflateInit(z, n)	lzma_decoder (z, n)
 # define do_inflate(z)	lzma_code (z, LZMA_RUN)
 # define inflateEnd(z)	lzma_end (z)
 #elif defined BZLIB
@@ -57,7 +57,7 @@
 # define Z(what)	BZ_##what
 # define BZ_ERRNO	BZ_IO_ERROR
 # define z_stream	bz_stream
-# define inflateInit(z)	BZ2_bzDecompressInit (z, 0, 0)
+# define inflateInit(z, n)	BZ2_bzDecompressInit (z, 0, 0)
 # define do_inflate(z)	BZ2_bzDecompress (z)
 # define inflateEnd(z)	BZ2_bzDecompressEnd (z)
 #else
@@ -71,6 +71,11 @@
 
 #define READ_SIZE		(1 << 20)
 
+/* Don't believe an uncompressed size from the container that is more
+   than this many times the compressed size.  This is the most deflate
+   can do, it's only a hint for the others.  */
+#define MAX_SIZE_HINT_RATIO	1032
+
 struct unzip_state {
 #if !USE_INFLATE
   gzFile zf;
@@ -83,6 +88,134 @@ struct unzip_state {
   off_t input_pos;
 };
 
+#ifdef LZMA
+/* XZ streams with several blocks, like xz -T writes them, can be
+   decoded in up to NTHREADS threads.  The threaded decoder falls back
+   to a single thread for blocks that don't fit in its memory limit.
+   It always starts a thread, so it is only used for more than one.  */
+static lzma_ret
+lzma_decoder (lzma_stream *z, unsigned int nthreads __attribute__ ((unused)))
+{
+#ifdef HAVE_LZMA_STREAM_DECODER_MT
+  if (nthreads > 1 && z->avail_in >= sizeof MAGIC - 1
+      && memcmp (z->next_in, MAGIC, sizeof MAGIC - 1) == 0)
+    {
+      lzma_mt mt =
+	{
+	  .threads = nthreads,
+	  .memlimit_threading = 1 << 30,
+	  .memlimit_stop = 1 << 30,
+	};
+      return lzma_stream_decoder_mt (z, &mt);
+    }
+#endif
+  return lzma_auto_decoder (z, 1 << 30, 0);
+}
+#endif
+
+#ifdef BZLIB
+/* bzip2 doesn't record the uncompressed size.  */
+# define size_hint(fd, start_offset, mapped, mapped_size)	0
+#else
+/* Copy SIZE bytes at OFFSET from the start of the compressed image,
+   which is MAPPED in memory or else read from FD.  */
+static bool
+read_image (int fd, off_t start_offset, const void *mapped,
+	    size_t mapped_size, size_t offset, void *buf, size_t size)
+{
+  if (offset > mapped_size || mapped_size - offset < size)
+    return false;
+  if (mapped != NULL)
+    {
+      memcpy (buf, mapped + offset, size);
+      return true;
+    }
+  return (fd >= 0
+	  && pread_retry (fd, buf, size, start_offset + offset) == (ssize_t) size);
+}
+
+/* Return the uncompressed size the container records, or zero if it
+   doesn't or we can't read it.  The image of MAPPED_SIZE bytes is in
+   MAPPED, or else in FD.  Either way, this is only a hint.  */
+static size_t
+size_hint (int fd, off_t start_offset, const void *mapped,
+	   size_t mapped_size)
+{
+  uint64_t size = 0;
+
+#ifdef LZMA
+  unsigned char footer[LZMA_STREAM_HEADER_SIZE];
+  lzma_stream_flags flags;
+  if (mapped_size > sizeof footer
+      && read_image (fd, start_offset, mapped, mapped_size,
+		     mapped_size - sizeof footer, footer, sizeof footer)
+      && lzma_stream_footer_decode (&flags, footer) == LZMA_OK)
+    {
+      /* The index just before the footer has the sizes of all blocks.
+	 This only finds the last stream if there are several.  */
+      size_t index_size = flags.backward_size;
+      unsigned char *index = NULL;
+      if (index_size <= mapped_size - sizeof footer
+	  && (index = malloc (index_size)) != NULL
+	  && read_image (fd, start_offset, mapped, mapped_size,
+			 mapped_size - sizeof footer - index_size,
+			 index, index_size))
+	{
+	  lzma_index *idx;
+	  uint64_t memlimit = UINT64_MAX;
+	  size_t pos = 0;
+	  if (lzma_index_buffer_decode (&idx, &memlimit, NULL,
+					index, &pos, index_size) == LZMA_OK)
+	    {
+	      size = lzma_index_uncompressed_size (idx);
+	      lzma_index_end (idx, NULL);
+	    }
+	}
+      free (index);
+    }
+  else
+    {
+      /* The raw LZMA format has it in the header, if it's known.  */
+      unsigned char header[13];
+      if (read_image (fd, start_offset, mapped, mapped_size,
+		      0, header, sizeof header)
+	  && memcmp (header, MAGIC2, sizeof MAGIC2 - 1) == 0)
+	{
+	  for (int i = 12; i >= 5; --i)
+	    size = (size << 8) | header[i];
+	  if (size == UINT64_MAX)
+	    size = 0;
+	}
+    }
+#else
+  /* The gzip trailer has the size modulo 2^32 of the last member.  */
+  unsigned char isize[4];
+  if (read_image (fd, start_offset, mapped, mapped_size,
+		  mapped_size - sizeof isize, isize, sizeof isize))
+    size = (isize[0] | isize[1] << 8 | isize[2] << 16
+	    | (uint32_t) isize[3] << 24);
+#endif
+
+  if (size / MAX_SIZE_HINT_RATIO > mapped_size || size >= SIZE_MAX)
+    return 0;
+  return size;
+}
+#endif
+
+/* Allocate the buffer for HINT bytes.  One more byte lets us see the
+   end of the stream without growing the buffer when the hint is right.
+   If we can't get that much, we just grow the buffer as needed.  */
+static inline void
+hinted_buffer (struct unzip_state *state, size_t hint)
+{
+  if (hint != 0)
+    {
+      state->buffer = malloc (hint + 1);
+      if (state->buffer != NULL)
+	state->size = hint + 1;
+    }
+}
+
 static inline bool
 bigger_buffer (struct unzip_state *state, size_t start)
 {
@@ -172,7 +305,8 @@ open_stream (int fd, off_t start_offset, struct unzip_state *state)
 Dwfl_Error internal_function
 unzip (int fd, off_t start_offset,
        void *mapped, size_t _mapped_size,
-       void **_whole, size_t *whole_size)
+       void **_whole, size_t *whole_size,
+       unsigned int nthreads __attribute__ ((unused)))
 {
   struct unzip_state state =
     {
@@ -223,6 +357,12 @@ unzip (int fd, off_t start_offset,
     /* Not a compressed file.  */
     return DWFL_E_BADELF;
 
+  /* Decompress into one buffer of the right size if we can tell it.  */
+  hinted_buffer (&state, size_hint (fd, start_offset,
+				    (mapped == state.input_buffer
+				     ? NULL : mapped),
+				    _mapped_size));
+
 #if USE_INFLATE
 
   /* This style actually only works with bzlib and liblzma.
@@ -230,12 +370,14 @@ unzip (int fd, off_t start_offset,
      gzip file headers except the slow gzFile interface.  */
 
   z_stream z = { .next_in = mapped, .avail_in = state.mapped_size };
-  int result = inflateInit (&z);
+  int result = inflateInit (&z, nthreads);
   if (result != Z (OK))
     {
       inflateEnd (&z);
       return zlib_fail (&state, result);
     }
+  z.next_out = state.buffer;
+  z.avail_out = state.size;
 
   do
     {
@@ -298,7 +440,7 @@ unzip (int fd, off_t start_offset,
   ptrdiff_t pos = 0;
   while (1)
     {
-      if (!bigger_buffer (&state, 1024))
+      if ((size_t) pos == state.size && !bigger_buffer (&state, 1024))
 	{
 	  gzclose (state.zf);
 	  return zlib_fail (&state, Z (MEM_ERROR));
@@ -182,6 +182,16 @@ extern int dwfl_report_end (Dwfl *dwfl,
 					    void *arg),
 			    void *arg);
 
+/* Start opening the ELF and debuginfo files of all reported modules in
+   the background, using up to NTHREADS threads.  This finds and
+   validates the files and loads their DWARF and symbol table data, so
+   the first lookups in each module don't have to wait for that.  Calls
+   that need a module that is still being loaded wait for it.  The
+   Dwfl_Callbacks functions must be thread safe when this is used.
+   Prefetching stops at the next dwfl_report_begin, dwfl_report_begin_add
+   or dwfl_end.  Returns 0 on success, -1 on error.  */
+extern int dwfl_prefetch_debuginfo (Dwfl *dwfl, unsigned int nthreads);
+
 /* Start reporting additional modules to the library.  No calls but
    dwfl_report_* can be made on DWFL until dwfl_report_end is called.
    This is like dwfl_report_begin, but all the old modules are kept on.
@@ -310,6 +320,20 @@ extern int dwfl_standard_find_debuginfo (Dwfl_Module *, void **,
 					 const char *, const char *,
 					 GElf_Word, char **);
 
+/* When CACHE is true, the standard find_debuginfo and build ID callbacks
+   read each absolute directory they look in once, and don't try to
+   open files that were not there.  This saves many failing opens when
+   there are many modules, but files created later are not seen until
+   the listings are flushed.  The listings are kept until the next
+   dwfl_report_begin, until dwfl_flush_debuginfo_cache is called, or
+   until this is called with CACHE false.  The cache is off by default.
+   Returns 0 on success, -1 on error.  */
+extern int dwfl_set_debuginfo_cache (Dwfl *dwfl, bool cache);
+
+/* Forget the directory listings of dwfl_set_debuginfo_cache, e.g. after
+   new debuginfo files have been installed.  */
+extern void dwfl_flush_debuginfo_cache (Dwfl *dwfl);
+
 
 /* This callback must be used when using dwfl_offline_* to report modules,
    if ET_REL is to be supported.  */
@@ -319,6 +343,26 @@ extern int dwfl_offline_section_address (Dwfl_Module *, void **,
 					 const GElf_Shdr *,
 					 Dwarf_Addr *addr);
 
+/* Keep the relocated debugging sections of ET_REL modules, like Linux
+   kernel modules, as files in the existing directory DIR.  The next
+   session with the same file, by build ID, and the same section
+   addresses reads them back instead of applying all relocations again.
+   To compute the cache key the section_address callback is called for
+   all SHF_ALLOC sections.  Modules without a build ID, and those with
+   relocations against other modules' symbols, are not cached.  DIR NULL
+   turns the cache off again.  Returns 0 on success, -1 on error.  */
+extern int dwfl_set_reloc_cache (Dwfl *dwfl, const char *dir);
+
+/* Let libdwfl use up to NTHREADS threads, but not more than there are
+   CPUs, for the work on a single large module, like applying the
+   relocations of a big ET_REL file, decoding the address ranges of
+   units missing from .debug_aranges or decompressing an xz file made of
+   several blocks.  By default, and when NTHREADS is
+   0 or 1, libdwfl doesn't start any threads of its own, apart from
+   those requested with dwfl_prefetch_debuginfo.  Returns 0 on success,
+   -1 on error.  */
+extern int dwfl_set_threads (Dwfl *dwfl, unsigned int nthreads);
+
 
 /* Callbacks for working with kernel modules in the running Linux kernel.  */
 extern int dwfl_linux_kernel_find_elf (Dwfl_Module *, void **,
@@ -481,6 +525,21 @@ extern const char *dwfl_module_getsym_info (Dwfl_Module *mod, int ndx,
 /* Find the symbol that ADDRESS lies inside, and return its name.  */
 extern const char *dwfl_module_addrname (Dwfl_Module *mod, GElf_Addr address);
 
+/* Find the defined symbol called NAME, and return its index in the
+   module's symbol table.  Fills in *SYM, *ADDR, *SHNDXP, *ELFP and *BIAS
+   as dwfl_module_getsym_info does for that index.  If there are several
+   symbols called NAME a global symbol is preferred over a weak one, and
+   those over local symbols.  A module with only dynamic symbols is
+   searched with its .gnu.hash or .hash table, which don't contain local
+   symbols.  Other symbol tables are indexed by name on first use.
+   Returns -1 and dwfl_errno () is zero if there is no such symbol.
+   Returns -1 with dwfl_errno () nonzero on errors.  */
+extern int dwfl_module_namesym (Dwfl_Module *mod, const char *name,
+				GElf_Sym *sym, GElf_Addr *addr,
+				GElf_Word *shndxp, Elf **elfp,
+				Dwarf_Addr *bias)
+  __nonnull_attribute__ (2, 3, 4);
+
 /* Find the symbol associated with ADDRESS.  Return its name or NULL
    when nothing was found.  If the architecture uses function
    descriptors, and symbol st_value points to one, ADDRESS wil be
@@ -138,6 +138,24 @@ struct Dwfl
   int lookup_tail_ndx;
 
   struct Dwfl_User_Core *user_core;
+
+  /* Background loading of the modules, see dwfl_prefetch_debuginfo.  */
+  struct dwfl_prefetch *prefetch;
+
+  /* tsearch tree of the directories searched for debuginfo files and
+     their contents, see __libdwfl_open_probe.  Only used when
+     dwfl_set_debuginfo_cache turned on PROBE_CACHE.  */
+  pthread_mutex_t probe_lock;
+  void *probe_dirs;
+  bool probe_cache;
+
+  /* Directory for relocated ET_REL debugging sections, see
+     dwfl_set_reloc_cache.  */
+  char *reloc_cache_dir;
+
+  /* Most threads to use for work on one module, see dwfl_set_threads.
+     Zero or one means libdwfl doesn't start any.  */
+  unsigned int nthreads;
 };
 
 #define OFFLINE_REDZONE		0x10000
@@ -167,6 +185,11 @@ struct Dwfl_Module
 
   void *userdata;
 
+  /* State of a dwfl_prefetch_debuginfo of this module and the thread
+     doing it.  Protected by the lock of the Dwfl.prefetch.  */
+  int prefetch;
+  pthread_t prefetch_owner;
+
   char *name;			/* Iterator name for this module.  */
   GElf_Addr low_addr, high_addr;
 
@@ -189,6 +212,11 @@ struct Dwfl_Module
   Elf_Data *aux_symstrdata;	/* Data for aux_sym string table.  */
   Elf_Data *symxndxdata;	/* Data in the extended section index table. */
   Elf_Data *aux_symxndxdata;	/* Data in the extended auxiliary table. */
+  Elf_Data *symhashdata;	/* .gnu.hash or .hash of a dynamic symdata.  */
+
+  /* Hash table of symbol indexes by name, see dwfl_module_namesym.  */
+  struct dwfl_symname *symnames;
+  size_t nsymnames;		/* Size of the table, a power of two.  */
 
   char *elfdir;			/* The dir where we found the main Elf.  */
 
@@ -200,19 +228,17 @@ struct Dwfl_Module
   Dwfl_Error symerr;		/* Previous failure to load symbols.  */
   Dwfl_Error dwerr;		/* Previous failure to load DWARF.  */
 
-  /* Known CU's in this module.  */
-  struct dwfl_cu *first_cu, **cu;
-
-  void *lazy_cu_root;		/* Table indexed by Dwarf_Off of CU.  */
+  /* All CU's in this module, in the order of libdw's cu_array.  */
+  struct dwfl_cu *cu;
 
   struct dwfl_arange *aranges;	/* Mapping of addresses in module to CUs.  */
+  Dwarf_Aranges *dwaranges;	/* The libdw aranges indexed by aranges.  */
 
   void *build_id_bits;		/* malloc'd copy of build ID bits.  */
   GElf_Addr build_id_vaddr;	/* Address where they reside, 0 if unknown.  */
   int build_id_len;		/* -1 for prior failure, 0 if unset.  */
 
-  unsigned int ncu;
-  unsigned int lazycu;		/* Possible users, deleted when none left.  */
+  size_t ncu;
   unsigned int naranges;
 
   Dwarf_CFI *dwarf_cfi;		/* Cached DWARF CFI for this module.  */
@@ -299,8 +325,6 @@ struct dwfl_cu
 
   Dwfl_Module *mod;		/* Pointer back to containing module.  */
 
-  struct dwfl_cu *next;		/* CU immediately following in the file.  */
-
   struct Dwfl_Lines *lines;
 };
 
@@ -462,11 +486,61 @@ extern const char *__libdwfl_getsym (Dwfl_Module *mod, int ndx, GElf_Sym *sym,
 				     bool *resolved, bool adjust_st_value)
   internal_function;
 
+/* Get the raw symbol NDX and return its name, without looking at its
+   value.  The module symbol tables must be loaded.  Returns NULL if the
+   symbol cannot be read.  */
+extern const char *__libdwfl_getsym_name (Dwfl_Module *mod, int ndx,
+					  GElf_Sym *sym) internal_function;
+
 extern void __libdwfl_module_free (Dwfl_Module *mod) internal_function;
 
 /* Find the main ELF file, update MOD->elferr and/or MOD->main.elf.  */
 extern void __libdwfl_getelf (Dwfl_Module *mod) internal_function;
 
+/* Wait until a running dwfl_prefetch_debuginfo thread is done with MOD,
+   or take MOD away from the prefetch threads if none started on it.  */
+extern void __libdwfl_prefetch_wait (Dwfl_Module *mod) internal_function;
+
+/* Stop the dwfl_prefetch_debuginfo threads, if any.  Modules some
+   thread is loading are finished first.  */
+extern void __libdwfl_prefetch_end (Dwfl *dwfl) internal_function;
+
+/* Open FNAME with O_RDONLY.  If dwfl_set_debuginfo_cache turned the
+   cache on, fails with ENOENT without trying if FNAME's directory
+   didn't have it when DWFL first looked there, or with ENOENT or
+   ENOTDIR if the directory itself didn't exist.  The directory
+   listings are kept until dwfl_flush_debuginfo_cache.  */
+extern int __libdwfl_open_probe (Dwfl *dwfl, const char *fname)
+  internal_function;
+
+/* Forget the directory listings of __libdwfl_open_probe.  */
+extern void __libdwfl_probe_cache_free (Dwfl *dwfl) internal_function;
+
+/* On-disk cache of the debugging sections __libdwfl_relocate relocates.
+   __libdwfl_reloc_cache_begin figures out the cache file for DEBUGFILE
+   with the current section addresses, or returns NULL if it cannot be
+   cached.  __libdwfl_reloc_cache_load applies the cached relocated
+   sections, it returns false and changes nothing when there is no
+   usable cache file.  __libdwfl_reloc_cache_store writes the cache file
+   after all relocations were applied.  */
+struct dwfl_reloc_cache;
+extern struct dwfl_reloc_cache *__libdwfl_reloc_cache_begin (Dwfl_Module *mod,
+							     Elf *debugfile)
+  internal_function;
+extern bool __libdwfl_reloc_cache_load (Dwfl_Module *mod, Elf *debugfile,
+					struct dwfl_reloc_cache *cache)
+  internal_function;
+extern void __libdwfl_reloc_cache_store (Dwfl_Module *mod, Elf *debugfile,
+					 struct dwfl_reloc_cache *cache)
+  internal_function;
+extern void __libdwfl_reloc_cache_end (struct dwfl_reloc_cache *cache)
+  internal_function;
+
+/* How many threads DWFL may use for the work on one module: what
+   dwfl_set_threads allowed, but not more than there are CPUs, and at
+   least one.  */
+extern unsigned int __libdwfl_nthreads (Dwfl *dwfl) internal_function;
+
 /* Process relocations in debugging sections in an ET_REL file.
    FILE must be opened with ELF_C_READ_MMAP_PRIVATE or ELF_C_READ,
    to make it possible to relocate the data in place (or ELF_C_RDWR or
@@ -598,18 +672,22 @@ extern GElf_Addr __libdwfl_segment_start (Dwfl *dwfl, GElf_Addr start)
 extern GElf_Addr __libdwfl_segment_end (Dwfl *dwfl, GElf_Addr end)
   internal_function;
 
-/* Decompression wrappers: decompress whole file into memory.  */
+/* Decompression wrappers: decompress whole file into memory.  Up to
+   NTHREADS threads are used where the format allows it.  */
 extern Dwfl_Error __libdw_gunzip  (int fd, off_t start_offset,
 				   void *mapped, size_t mapped_size,
-				   void **whole, size_t *whole_size)
+				   void **whole, size_t *whole_size,
+				   unsigned int nthreads)
   internal_function;
 extern Dwfl_Error __libdw_bunzip2 (int fd, off_t start_offset,
 				   void *mapped, size_t mapped_size,
-				   void **whole, size_t *whole_size)
+				   void **whole, size_t *whole_size,
+				   unsigned int nthreads)
   internal_function;
 extern Dwfl_Error __libdw_unlzma (int fd, off_t start_offset,
 				  void *mapped, size_t mapped_size,
-				  void **whole, size_t *whole_size)
+				  void **whole, size_t *whole_size,
+				  unsigned int nthreads)
   internal_function;
 
 /* Skip the image header before a file image: updates *START_OFFSET.  */
@@ -620,9 +698,11 @@ extern Dwfl_Error __libdw_image_header (int fd, off_t *start_offset,
 /* Open Elf handle on *FDP.  This handles decompression and checks
    elf_kind.  Succeed only for ELF_K_ELF, or also ELF_K_AR if ARCHIVE_OK.
    Returns DWFL_E_NOERROR and sets *ELFP on success, resets *FDP to -1 if
-   it's no longer used.  Resets *FDP on failure too iff CLOSE_ON_FAIL.  */
+   it's no longer used.  Resets *FDP on failure too iff CLOSE_ON_FAIL.
+   A compressed file is decompressed in up to NTHREADS threads.  */
 extern Dwfl_Error __libdw_open_file (int *fdp, Elf **elfp,
-				     bool close_on_fail, bool archive_ok)
+				     bool close_on_fail, bool archive_ok,
+				     unsigned int nthreads)
   internal_function;
 
 /* Same as __libdw_open_file, but never closes the given file
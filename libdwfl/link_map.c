@@ -393,7 +393,8 @@ report_r_debug (uint_fast8_t elfclass, uint_fast8_t elfdata,
 	  if (fd >= 0)
 	    {
 	      Elf *elf;
-	      Dwfl_Error error = __libdw_open_file (&fd, &elf, true, false);
+	      Dwfl_Error error = __libdw_open_file (&fd, &elf, true, false,
+						    __libdwfl_nthreads (dwfl));
 	      GElf_Addr elf_dynamic_vaddr;
 	      if (error == DWFL_E_NOERROR
 		  && __libdwfl_dynamic_vaddr_get (elf, &elf_dynamic_vaddr))
@@ -812,7 +813,8 @@ dwfl_link_map_report (Dwfl *dwfl, const void *auxv, size_t auxv_size,
 	      Elf *elf;
 	      Dwfl_Error error = DWFL_E_ERRNO;
 	      if (fd != -1)
-		error = __libdw_open_file (&fd, &elf, true, false);
+		error = __libdw_open_file (&fd, &elf, true, false,
+					   __libdwfl_nthreads (dwfl));
 	      if (error != DWFL_E_NOERROR)
 		{
 		  __libdwfl_seterrno (error);
@@ -31,6 +31,7 @@
 #endif
 
 #include "libdwflP.h"
+#include "../libelf/libelfP.h"
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -147,13 +148,19 @@ process_elf (Dwfl *dwfl, const char *name, const char *file_name, int fd,
 	  && dwfl->offline_next_address < mod->high_addr + OFFLINE_REDZONE)
 	dwfl->offline_next_address = mod->high_addr + OFFLINE_REDZONE;
 
-      /* Don't keep the file descriptor around.  */
-      if (mod->main.fd != -1 && elf_cntl (mod->main.elf, ELF_C_FDREAD) == 0)
+      /* Don't keep the file descriptor around.  Archive members share
+	 it with the archive, process_archive closes it.  Closing it
+	 for every member as well could close some other file opened
+	 in another thread in the meantime.  */
+      bool member = mod->main.elf->parent != NULL;
+      if (mod->main.fd != -1
+	  && (elf_cntl (mod->main.elf, ELF_C_FDREAD) == 0 || member))
 	{
 	  /* Grab the dir path in case we want to report this file as
 	     Dwarf later.  */
 	  mod->elfdir = __libdw_debugdir (mod->main.fd);
-	  close (mod->main.fd);
+	  if (! member)
+	    close (mod->main.fd);
 	  mod->main.fd = -1;
 	}
     }
@@ -278,7 +285,8 @@ __libdwfl_report_offline (Dwfl *dwfl, const char *name,
 					    const char *file))
 {
   Elf *elf;
-  Dwfl_Error error = __libdw_open_file (&fd, &elf, closefd, true);
+  Dwfl_Error error = __libdw_open_file (&fd, &elf, closefd, true,
+					__libdwfl_nthreads (dwfl));
   if (error != DWFL_E_NOERROR)
     {
       __libdwfl_seterrno (error);
@@ -46,7 +46,8 @@
 
 /* Consumes and replaces *ELF only on success.  */
 static Dwfl_Error
-decompress (int fd __attribute__ ((unused)), Elf **elf)
+decompress (int fd __attribute__ ((unused)), Elf **elf,
+	    unsigned int nthreads)
 {
   Dwfl_Error error = DWFL_E_BADELF;
   void *buffer = NULL;
@@ -59,11 +60,14 @@ decompress (int fd __attribute__ ((unused)), Elf **elf)
   if (mapped_size == 0)
     return error;
 
-  error = __libdw_gunzip (fd, offset, mapped, mapped_size, &buffer, &size);
+  error = __libdw_gunzip (fd, offset, mapped, mapped_size, &buffer, &size,
+			  nthreads);
   if (error == DWFL_E_BADELF)
-    error = __libdw_bunzip2 (fd, offset, mapped, mapped_size, &buffer, &size);
+    error = __libdw_bunzip2 (fd, offset, mapped, mapped_size, &buffer, &size,
+			     nthreads);
   if (error == DWFL_E_BADELF)
-    error = __libdw_unlzma (fd, offset, mapped, mapped_size, &buffer, &size);
+    error = __libdw_unlzma (fd, offset, mapped, mapped_size, &buffer, &size,
+			    nthreads);
 
   if (error == DWFL_E_NOERROR)
     {
@@ -95,7 +99,8 @@ decompress (int fd __attribute__ ((unused)), Elf **elf)
 }
 
 static Dwfl_Error
-what_kind (int fd, Elf **elfp, Elf_Kind *kind, bool *may_close_fd)
+what_kind (int fd, Elf **elfp, Elf_Kind *kind, bool *may_close_fd,
+	   unsigned int nthreads)
 {
   Dwfl_Error error = DWFL_E_NOERROR;
   *kind = elf_kind (*elfp);
@@ -105,7 +110,7 @@ what_kind (int fd, Elf **elfp, Elf_Kind *kind, bool *may_close_fd)
 	error = DWFL_E_LIBELF;
       else
 	{
-	  error = decompress (fd, elfp);
+	  error = decompress (fd, elfp, nthreads);
 	  if (error == DWFL_E_NOERROR)
 	    {
 	      *may_close_fd = true;
@@ -118,14 +123,15 @@ what_kind (int fd, Elf **elfp, Elf_Kind *kind, bool *may_close_fd)
 
 static Dwfl_Error
 libdw_open_elf (int *fdp, Elf **elfp, bool close_on_fail, bool archive_ok,
-		bool never_close_fd, bool bad_elf_ok)
+		bool never_close_fd, bool bad_elf_ok, unsigned int nthreads)
 {
   bool may_close_fd = false;
 
   Elf *elf = elf_begin (*fdp, ELF_C_READ_MMAP_PRIVATE, NULL);
 
   Elf_Kind kind;
-  Dwfl_Error error = what_kind (*fdp, &elf, &kind, &may_close_fd);
+  Dwfl_Error error = what_kind (*fdp, &elf, &kind, &may_close_fd,
+				nthreads);
   if (error == DWFL_E_BADELF)
     {
       /* It's not an ELF file or a compressed file.
@@ -154,7 +160,7 @@ libdw_open_elf (int *fdp, Elf **elfp, bool close_on_fail, bool archive_ok,
 	      elf->flags &= ~(ELF_F_MMAPPED | ELF_F_MALLOCED);
 	      elf_end (elf);
 	      elf = subelf;
-	      error = what_kind (*fdp, &elf, &kind, &may_close_fd);
+	      error = what_kind (*fdp, &elf, &kind, &may_close_fd, nthreads);
 	    }
 	}
     }
@@ -186,13 +192,15 @@ libdw_open_elf (int *fdp, Elf **elfp, bool close_on_fail, bool archive_ok,
 }
 
 Dwfl_Error internal_function
-__libdw_open_file (int *fdp, Elf **elfp, bool close_on_fail, bool archive_ok)
+__libdw_open_file (int *fdp, Elf **elfp, bool close_on_fail, bool archive_ok,
+		   unsigned int nthreads)
 {
-  return libdw_open_elf (fdp, elfp, close_on_fail, archive_ok, false, false);
+  return libdw_open_elf (fdp, elfp, close_on_fail, archive_ok, false, false,
+			 nthreads);
 }
 
 Dwfl_Error internal_function
 __libdw_open_elf (int fd, Elf **elfp)
 {
-  return libdw_open_elf (&fd, elfp, false, true, true, true);
+  return libdw_open_elf (&fd, elfp, false, true, true, true, 1);
 }
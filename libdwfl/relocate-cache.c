@@ -0,0 +1,432 @@
+/* On-disk cache of relocated ET_REL debugging sections.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwflP.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "system.h"
+
+/* A cache file starts with the magic, the size of the key and the key
+   itself.  Then for each relocation section applied to a debugging
+   section there are its index, the target section index and size, and
+   the relocated contents of the target section.  All in host byte
+   order, padded to 8 bytes.  */
+static const char reloc_cache_magic[8] = "EUREL\0\0\1";
+
+struct reloc_cache_sect
+{
+  uint32_t relndx;
+  uint32_t tndx;
+  uint64_t size;
+};
+
+struct dwfl_reloc_cache
+{
+  unsigned char *key;
+  size_t keylen;
+  size_t keyalloc;
+  char *path;
+  size_t nsects;
+  struct reloc_cache_sect *sects;
+};
+
+#define PAD8(n)	(((n) + 7) & -(size_t) 8)
+
+static bool
+key_add (struct dwfl_reloc_cache *cache, const void *data, size_t len)
+{
+  if (cache->keylen + len > cache->keyalloc)
+    {
+      size_t newalloc = 2 * (cache->keylen + len) + 64;
+      unsigned char *newkey = realloc (cache->key, newalloc);
+      if (unlikely (newkey == NULL))
+	return false;
+      cache->key = newkey;
+      cache->keyalloc = newalloc;
+    }
+  memcpy (&cache->key[cache->keylen], data, len);
+  cache->keylen += len;
+  return true;
+}
+
+/* Add the load address of every SHF_ALLOC section of ELF to the key.
+   These are all the relocated values can depend on.  */
+static bool
+key_add_addresses (Dwfl_Module *mod, Elf *elf, struct dwfl_reloc_cache *cache)
+{
+  size_t shstrndx = SHN_UNDEF;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	return false;
+      if ((shdr->sh_flags & SHF_ALLOC) == 0)
+	continue;
+
+      uint64_t entry[2] = { elf_ndxscn (scn), 0 };
+      GElf_Addr addr = 0;
+      if (__libdwfl_relocate_value (mod, elf, &shstrndx, entry[0], &addr)
+	  != DWFL_E_NOERROR)
+	return false;
+      entry[1] = addr;
+      if (! key_add (cache, entry, sizeof entry))
+	return false;
+    }
+  return true;
+}
+
+/* Whether ELF has its own symbol table, see relocate_getsym.  */
+static bool
+has_symtab (Elf *elf)
+{
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr != NULL && shdr->sh_type == SHT_SYMTAB)
+	return true;
+    }
+  return false;
+}
+
+void
+internal_function
+__libdwfl_reloc_cache_end (struct dwfl_reloc_cache *cache)
+{
+  free (cache->key);
+  free (cache->path);
+  free (cache->sects);
+  free (cache);
+}
+
+struct dwfl_reloc_cache *
+internal_function
+__libdwfl_reloc_cache_begin (Dwfl_Module *mod, Elf *debugfile)
+{
+  /* Without a build ID we don't know whether the file is the same.  */
+  if (mod->build_id_len == 0 && mod->main.elf != NULL
+      && __libdwfl_find_build_id (mod, true, mod->main.elf) <= 0)
+    mod->build_id_len = -1;	/* Cache negative result.  */
+  if (mod->build_id_len <= 0 || mod->ebl == NULL)
+    return NULL;
+
+  size_t shstrndx;
+  if (elf_getshdrstrndx (debugfile, &shstrndx) < 0)
+    return NULL;
+
+  struct dwfl_reloc_cache *cache = calloc (1, sizeof *cache);
+  if (unlikely (cache == NULL))
+    return NULL;
+
+  /* Find the relocation sections __libdwfl_relocate will apply.  */
+  size_t nalloc = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (debugfile, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	goto fail;
+      if ((shdr->sh_type != SHT_REL && shdr->sh_type != SHT_RELA)
+	  || shdr->sh_size == 0)
+	continue;
+
+      GElf_Shdr tshdr_mem;
+      GElf_Shdr *tshdr = gelf_getshdr (elf_getscn (debugfile, shdr->sh_info),
+				       &tshdr_mem);
+      if (tshdr == NULL)
+	goto fail;
+      const char *tname = elf_strptr (debugfile, shstrndx, tshdr->sh_name);
+      if (! ebl_debugscn_p (mod->ebl, tname))
+	continue;
+
+      if (cache->nsects == nalloc)
+	{
+	  nalloc = 2 * nalloc + 8;
+	  struct reloc_cache_sect *sects = realloc (cache->sects,
+						    nalloc * sizeof *sects);
+	  if (unlikely (sects == NULL))
+	    goto fail;
+	  cache->sects = sects;
+	}
+      cache->sects[cache->nsects++] = (struct reloc_cache_sect)
+	{
+	  .relndx = elf_ndxscn (scn),
+	  .tndx = shdr->sh_info,
+	  .size = tshdr->sh_size,
+	};
+    }
+  if (cache->nsects == 0)
+    goto fail;
+
+  /* The key is the build ID, the file, the sections and their addresses.  */
+  GElf_Ehdr ehdr_mem, *ehdr = gelf_getehdr (debugfile, &ehdr_mem);
+  if (ehdr == NULL)
+    goto fail;
+  unsigned char what[4] = { debugfile == mod->main.elf,
+			    ehdr->e_ident[EI_CLASS],
+			    ehdr->e_ident[EI_DATA], 0 };
+  uint32_t machine = ehdr->e_machine;
+  Elf *symelf = (has_symtab (debugfile) || mod->symfile == NULL
+		 ? debugfile : mod->symfile->elf);
+  if (! key_add (cache, mod->build_id_bits, mod->build_id_len)
+      || ! key_add (cache, what, sizeof what)
+      || ! key_add (cache, &machine, sizeof machine)
+      || ! key_add (cache, cache->sects, cache->nsects * sizeof *cache->sects)
+      || ! key_add_addresses (mod, symelf, cache))
+    goto fail;
+
+  /* The file name is the build ID and a hash of the rest of the key.  */
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < cache->keylen; ++i)
+    hash = (hash ^ cache->key[i]) * 1099511628211ULL;
+  char *id = malloc (2 * mod->build_id_len + 1);
+  if (unlikely (id == NULL))
+    goto fail;
+  const uint8_t *bits = mod->build_id_bits;
+  for (int i = 0; i < mod->build_id_len; ++i)
+    sprintf (&id[2 * i], "%02" PRIx8, bits[i]);
+  if (asprintf (&cache->path, "%s/%s-%016" PRIx64 ".reloc",
+		mod->dwfl->reloc_cache_dir, id, hash) < 0)
+    cache->path = NULL;
+  free (id);
+  if (cache->path == NULL)
+    goto fail;
+
+  return cache;
+
+ fail:
+  __libdwfl_reloc_cache_end (cache);
+  return NULL;
+}
+
+/* Get the target section of relocation section SECT ready to be
+   overwritten, like relocate_section does.  */
+static Elf_Data *
+prepare_target (Elf *debugfile, size_t shstrndx,
+		const struct reloc_cache_sect *sect)
+{
+  Elf_Scn *tscn = elf_getscn (debugfile, sect->tndx);
+  GElf_Shdr tshdr_mem, *tshdr = gelf_getshdr (tscn, &tshdr_mem);
+  if (tshdr == NULL)
+    return NULL;
+  const char *tname = elf_strptr (debugfile, shstrndx, tshdr->sh_name);
+  if (tname == NULL)
+    return NULL;
+
+  if (strncmp (tname, ".zdebug", strlen ("zdebug")) == 0)
+    elf_compress_gnu (tscn, 0, 0);
+  if ((tshdr->sh_flags & SHF_COMPRESSED) != 0)
+    if (elf_compress (tscn, 0, 0) < 0)
+      return NULL;
+
+  return elf_rawdata (tscn, NULL);
+}
+
+bool
+internal_function
+__libdwfl_reloc_cache_load (Dwfl_Module *mod __attribute__ ((unused)),
+			    Elf *debugfile, struct dwfl_reloc_cache *cache)
+{
+  int fd = open (cache->path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  bool result = false;
+  struct stat st;
+  void *map = MAP_FAILED;
+  if (fstat (fd, &st) == 0 && st.st_size > 0)
+    map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  const unsigned char **contents = NULL;
+  Elf_Data **tdata = NULL;
+  const unsigned char *p = map;
+  const unsigned char *end = p + st.st_size;
+  uint64_t keylen;
+  if ((size_t) (end - p) < sizeof reloc_cache_magic + sizeof keylen
+      || memcmp (p, reloc_cache_magic, sizeof reloc_cache_magic) != 0)
+    goto out;
+  p += sizeof reloc_cache_magic;
+  memcpy (&keylen, p, sizeof keylen);
+  p += sizeof keylen;
+  if (keylen != cache->keylen || (size_t) (end - p) < PAD8 (keylen)
+      || memcmp (p, cache->key, keylen) != 0)
+    goto out;
+  p += PAD8 (keylen);
+
+  size_t shstrndx;
+  if (elf_getshdrstrndx (debugfile, &shstrndx) < 0)
+    goto out;
+
+  /* First check everything, nothing may be changed before we know
+     the whole cache file can be used.  Otherwise the relocations
+     would be applied twice when we fall back to doing them.  */
+  contents = malloc (cache->nsects * sizeof *contents);
+  tdata = malloc (cache->nsects * sizeof *tdata);
+  if (unlikely (contents == NULL) || unlikely (tdata == NULL))
+    goto out;
+  for (size_t i = 0; i < cache->nsects; ++i)
+    {
+      struct reloc_cache_sect sect;
+      if ((size_t) (end - p) < sizeof sect)
+	goto out;
+      memcpy (&sect, p, sizeof sect);
+      p += sizeof sect;
+      if (sect.relndx != cache->sects[i].relndx
+	  || sect.tndx != cache->sects[i].tndx
+	  || (uint64_t) (end - p) < PAD8 (sect.size))
+	goto out;
+
+      tdata[i] = prepare_target (debugfile, shstrndx, &sect);
+      if (tdata[i] == NULL || tdata[i]->d_size != sect.size)
+	goto out;
+      contents[i] = p;
+      p += PAD8 (sect.size);
+    }
+
+  for (size_t i = 0; i < cache->nsects; ++i)
+    {
+      Elf_Scn *scn = elf_getscn (debugfile, cache->sects[i].relndx);
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL)
+	goto out;
+      if ((shdr->sh_flags & SHF_COMPRESSED) != 0)
+	if (elf_compress (scn, 0, 0) < 0)
+	  goto out;
+      shdr = gelf_getshdr (scn, &shdr_mem);
+      Elf_Data *reldata = elf_getdata (scn, NULL);
+      if (shdr == NULL || reldata == NULL)
+	goto out;
+
+      memcpy (tdata[i]->d_buf, contents[i], tdata[i]->d_size);
+
+      /* All relocations are done, as in relocate_section.  */
+      shdr->sh_size = reldata->d_size = 0;
+      if (unlikely (gelf_update_shdr (scn, shdr) == 0))
+	goto out;
+    }
+  result = true;
+
+ out:
+  free (contents);
+  free (tdata);
+  munmap (map, st.st_size);
+  return result;
+}
+
+void
+internal_function
+__libdwfl_reloc_cache_store (Dwfl_Module *mod __attribute__ ((unused)),
+			     Elf *debugfile, struct dwfl_reloc_cache *cache)
+{
+  /* Only fully relocated sections can be cached.  */
+  for (size_t i = 0; i < cache->nsects; ++i)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (elf_getscn (debugfile,
+						  cache->sects[i].relndx),
+				      &shdr_mem);
+      if (shdr == NULL || shdr->sh_size != 0)
+	return;
+    }
+
+  /* Write a new file and rename it over the old one, so readers never
+     see half a cache file.  */
+  char *tmp;
+  if (asprintf (&tmp, "%s.XXXXXX", cache->path) < 0)
+    return;
+  int fd = mkstemp (tmp);
+  if (fd < 0)
+    {
+      free (tmp);
+      return;
+    }
+
+  static const unsigned char zeros[8];
+  uint64_t keylen = cache->keylen;
+  bool ok = (write_retry (fd, reloc_cache_magic, sizeof reloc_cache_magic)
+	     == sizeof reloc_cache_magic
+	     && write_retry (fd, &keylen, sizeof keylen) == sizeof keylen
+	     && write_retry (fd, cache->key, keylen) == (ssize_t) keylen
+	     && write_retry (fd, zeros, PAD8 (keylen) - keylen)
+		== (ssize_t) (PAD8 (keylen) - keylen));
+  for (size_t i = 0; ok && i < cache->nsects; ++i)
+    {
+      Elf_Data *tdata = elf_rawdata (elf_getscn (debugfile,
+						 cache->sects[i].tndx), NULL);
+      if (tdata == NULL || tdata->d_buf == NULL)
+	{
+	  ok = false;
+	  break;
+	}
+      struct reloc_cache_sect sect = cache->sects[i];
+      sect.size = tdata->d_size;
+      size_t pad = PAD8 (sect.size) - sect.size;
+      ok = (write_retry (fd, &sect, sizeof sect) == sizeof sect
+	    && write_retry (fd, tdata->d_buf, sect.size)
+	       == (ssize_t) sect.size
+	    && write_retry (fd, zeros, pad) == (ssize_t) pad);
+    }
+
+  if (close (fd) != 0 || ! ok || rename (tmp, cache->path) != 0)
+    unlink (tmp);
+  free (tmp);
+}
+
+int
+dwfl_set_reloc_cache (Dwfl *dwfl, const char *dir)
+{
+  if (dwfl == NULL)
+    return -1;
+
+  char *copy = NULL;
+  if (dir != NULL)
+    {
+      copy = strdup (dir);
+      if (copy == NULL)
+	{
+	  __libdwfl_seterrno (DWFL_E_NOMEM);
+	  return -1;
+	}
+    }
+
+  free (dwfl->reloc_cache_dir);
+  dwfl->reloc_cache_dir = copy;
+  return 0;
+}
@@ -32,6 +32,8 @@
 
 #include "libelfP.h"
 #include "libdwflP.h"
+#include <pthread.h>
+#include "system.h"
 
 typedef uint8_t GElf_Byte;
 
@@ -93,6 +95,14 @@ __libdwfl_relocate_value (Dwfl_Module *mod, Elf *elf, size_t *shstrndx,
 }
 
 
+/* A symbol value resolved by one of the relocating threads.  */
+struct reloc_symval
+{
+  GElf_Addr value;
+  Dwfl_Error error;
+  atomic_bool resolved;
+};
+
 /* Cache used by relocate_getsym.  */
 struct reloc_symtab_cache
 {
@@ -102,17 +112,22 @@ struct reloc_symtab_cache
   Elf_Data *symstrdata;
   size_t symshstrndx;
   size_t strtabndx;
+  bool external;	/* Some symbol was looked up in other modules.  */
+
+  /* When relocating in several threads, each symbol is resolved once
+     into SYMVALS, and everything above is only used with LOCK held.  */
+  struct reloc_symval *symvals;
+  size_t nsymvals;
+  pthread_mutex_t *lock;
 };
 #define RELOC_SYMTAB_CACHE(cache)	\
   struct reloc_symtab_cache cache =	\
-    { NULL, NULL, NULL, NULL, SHN_UNDEF, SHN_UNDEF }
+    { NULL, NULL, NULL, NULL, SHN_UNDEF, SHN_UNDEF, false, NULL, 0, NULL }
 
-/* This is just doing dwfl_module_getsym, except that we must always use
-   the symbol table in RELOCATED itself when it has one, not MOD->symfile.  */
+/* Find the symbol table the relocations in RELOCATED refer to.  */
 static Dwfl_Error
-relocate_getsym (Dwfl_Module *mod,
-		 Elf *relocated, struct reloc_symtab_cache *cache,
-		 int symndx, GElf_Sym *sym, GElf_Word *shndx)
+reloc_symtab_init (Dwfl_Module *mod,
+		   Elf *relocated, struct reloc_symtab_cache *cache)
 {
   if (cache->symdata == NULL)
     {
@@ -177,6 +192,20 @@ relocate_getsym (Dwfl_Module *mod,
 	}
     }
 
+  return DWFL_E_NOERROR;
+}
+
+/* This is just doing dwfl_module_getsym, except that we must always use
+   the symbol table in RELOCATED itself when it has one, not MOD->symfile.  */
+static Dwfl_Error
+relocate_getsym (Dwfl_Module *mod,
+		 Elf *relocated, struct reloc_symtab_cache *cache,
+		 int symndx, GElf_Sym *sym, GElf_Word *shndx)
+{
+  Dwfl_Error error = reloc_symtab_init (mod, relocated, cache);
+  if (unlikely (error != DWFL_E_NOERROR))
+    return error;
+
   if (unlikely (gelf_getsymshndx (cache->symdata, cache->symxndxdata,
 				  symndx, sym, shndx) == NULL))
     return DWFL_E_LIBELF;
@@ -316,6 +345,72 @@ resolve_symbol (Dwfl_Module *referer, struct reloc_symtab_cache *symtab,
   return DWFL_E_RELUNDEF;
 }
 
+/* Resolve symbol SYMNDX to the absolute value a relocation uses.  */
+static Dwfl_Error
+resolve_symndx (Dwfl_Module *mod, Elf *relocated,
+		struct reloc_symtab_cache *reloc_symtab, int symndx,
+		GElf_Addr *value)
+{
+  GElf_Sym sym;
+  GElf_Word shndx;
+  Dwfl_Error error = relocate_getsym (mod, relocated, reloc_symtab,
+				      symndx, &sym, &shndx);
+  if (unlikely (error != DWFL_E_NOERROR))
+    return error;
+
+  if (shndx == SHN_UNDEF || shndx == SHN_COMMON)
+    {
+      /* Maybe we can figure it out anyway.  */
+      reloc_symtab->external = true;
+      error = resolve_symbol (mod, reloc_symtab, &sym, shndx);
+      if (error != DWFL_E_NOERROR
+	  && !(error == DWFL_E_RELUNDEF && shndx == SHN_COMMON))
+	return error;
+    }
+
+  *value = sym.st_value;
+  return DWFL_E_NOERROR;
+}
+
+/* Same, but when several threads are relocating, use the value one of
+   them resolved before.  The first one to need it resolves it while
+   holding the lock, because that touches MOD and the ELF files.  */
+static Dwfl_Error
+relocate_symval (Dwfl_Module *mod, Elf *relocated,
+		 struct reloc_symtab_cache *reloc_symtab, int symndx,
+		 GElf_Addr *value)
+{
+  if (reloc_symtab->symvals == NULL)
+    return resolve_symndx (mod, relocated, reloc_symtab, symndx, value);
+
+  if (unlikely ((size_t) symndx >= reloc_symtab->nsymvals))
+    {
+      /* This just fails, let resolve_symndx say how.  */
+      pthread_mutex_lock (reloc_symtab->lock);
+      Dwfl_Error error = resolve_symndx (mod, relocated, reloc_symtab,
+					 symndx, value);
+      pthread_mutex_unlock (reloc_symtab->lock);
+      return error;
+    }
+
+  struct reloc_symval *sv = &reloc_symtab->symvals[symndx];
+  if (! atomic_load_explicit (&sv->resolved, memory_order_acquire))
+    {
+      pthread_mutex_lock (reloc_symtab->lock);
+      if (! atomic_load_explicit (&sv->resolved, memory_order_relaxed))
+	{
+	  sv->value = 0;
+	  sv->error = resolve_symndx (mod, relocated, reloc_symtab,
+				      symndx, &sv->value);
+	  atomic_store_explicit (&sv->resolved, true, memory_order_release);
+	}
+      pthread_mutex_unlock (reloc_symtab->lock);
+    }
+
+  *value = sv->value;
+  return sv->error;
+}
+
 /* Apply one relocation.  Returns true for any invalid data.  */
 static Dwfl_Error
 relocate (Dwfl_Module * const mod,
@@ -357,23 +452,10 @@ relocate (Dwfl_Module * const mod,
       value = 0;
     else
       {
-	GElf_Sym sym;
-	GElf_Word shndx;
-	Dwfl_Error error = relocate_getsym (mod, relocated, reloc_symtab,
-					    symndx, &sym, &shndx);
+	Dwfl_Error error = relocate_symval (mod, relocated, reloc_symtab,
+					    symndx, &value);
 	if (unlikely (error != DWFL_E_NOERROR))
 	  return error;
-
-	if (shndx == SHN_UNDEF || shndx == SHN_COMMON)
-	  {
-	    /* Maybe we can figure it out anyway.  */
-	    error = resolve_symbol (mod, reloc_symtab, &sym, shndx);
-	    if (error != DWFL_E_NOERROR
-		&& !(error == DWFL_E_RELUNDEF && shndx == SHN_COMMON))
-	      return error;
-	  }
-
-	value = sym.st_value;
       }
 
     /* These are the types we can relocate.  */
@@ -496,12 +578,32 @@ check_badreltype (bool *first_badreltype,
      }
 }
 
+/* A relocation section ready to be applied.  Everything for which
+   libelf changes the file has already been done.  */
+struct reloc_job
+{
+  Elf_Scn *scn;
+  GElf_Shdr shdr;
+  Elf_Data *tdata;
+  Elf_Data *reldata;
+  size_t entsize;
+  size_t nrels;
+  size_t complete;
+  Dwfl_Error result;
+  bool applied;			/* apply_section has run.  */
+  struct reloc_job *next;	/* Next job for the same target section.  */
+};
+
+/* Decompress the relocation section SCN and its target TSCN, and fetch
+   their data into JOB.  Leaves JOB->reldata NULL if there is nothing
+   to relocate.  */
 static Dwfl_Error
-relocate_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
-		  size_t shstrndx, struct reloc_symtab_cache *reloc_symtab,
-		  Elf_Scn *scn, GElf_Shdr *shdr,
-		  Elf_Scn *tscn, bool debugscn, bool partial)
+prepare_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
+		 size_t shstrndx, Elf_Scn *scn, GElf_Shdr *shdr,
+		 Elf_Scn *tscn, bool debugscn, struct reloc_job *job)
 {
+  job->reldata = NULL;
+
   /* First, fetch the name of the section these relocations apply to.
      Then try to decompress both relocation and target section.  */
   GElf_Shdr tshdr_mem;
@@ -612,20 +714,40 @@ relocate_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
 	}
     }
 
-  /* Fetch the relocation section and apply each reloc in it.  */
+  /* Fetch the relocation section.  */
   Elf_Data *reldata = elf_getdata (scn, NULL);
   if (reldata == NULL)
     return DWFL_E_LIBELF;
 
+  job->scn = scn;
+  job->shdr = *shdr;
+  job->tdata = tdata;
+  job->reldata = reldata;
+  job->entsize = gelf_fsize (relocated, (shdr->sh_type == SHT_REL
+					 ? ELF_T_REL : ELF_T_RELA),
+			     1, EV_CURRENT);
+  job->nrels = shdr->sh_size / job->entsize;
+  job->complete = 0;
+  job->result = DWFL_E_NOERROR;
+  job->applied = false;
+  job->next = NULL;
+
+  return DWFL_E_NOERROR;
+}
+
+/* Apply each reloc in JOB.  */
+static Dwfl_Error
+apply_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
+	       struct reloc_symtab_cache *reloc_symtab,
+	       struct reloc_job *job, bool partial)
+{
   Dwfl_Error result = DWFL_E_NOERROR;
   bool first_badreltype = true;
 
-  size_t sh_entsize
-    = gelf_fsize (relocated, shdr->sh_type == SHT_REL ? ELF_T_REL : ELF_T_RELA,
-		  1, EV_CURRENT);
-  size_t nrels = shdr->sh_size / sh_entsize;
-  size_t complete = 0;
-  if (shdr->sh_type == SHT_REL)
+  Elf_Data *tdata = job->tdata;
+  Elf_Data *reldata = job->reldata;
+  size_t nrels = job->nrels;
+  if (job->shdr.sh_type == SHT_REL)
     for (size_t relidx = 0; !result && relidx < nrels; ++relidx)
       {
 	GElf_Rel rel_mem, *r = gelf_getrel (reldata, relidx, &rel_mem);
@@ -644,7 +766,7 @@ relocate_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
 	      memset (&rel_mem, 0, sizeof rel_mem);
 	      if (unlikely (gelf_update_rel (reldata, relidx, &rel_mem) == 0))
 		return DWFL_E_LIBELF;
-	      ++complete;
+	      ++job->complete;
 	      break;
 	    case DWFL_E_BADRELTYPE:
 	    case DWFL_E_RELUNDEF:
@@ -676,7 +798,7 @@ relocate_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
 	      if (unlikely (gelf_update_rela (reldata, relidx,
 					      &rela_mem) == 0))
 		return DWFL_E_LIBELF;
-	      ++complete;
+	      ++job->complete;
 	      break;
 	    case DWFL_E_BADRELTYPE:
 	    case DWFL_E_RELUNDEF:
@@ -688,59 +810,322 @@ relocate_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
 	    }
       }
 
-  if (likely (result == DWFL_E_NOERROR))
+  return result;
+}
+
+/* Remove the relocations JOB has applied from its section.  */
+static Dwfl_Error
+finish_section (struct reloc_job *job, bool partial)
+{
+  GElf_Shdr *shdr = &job->shdr;
+  Elf_Data *reldata = job->reldata;
+  size_t nrels = job->nrels;
+
+  if (!partial || job->complete == nrels)
+    /* Mark this relocation section as being empty now that we have
+       done its work.  This affects unstrip -R, so e.g. it emits an
+       empty .rela.debug_info along with a .debug_info that has
+       already been fully relocated.  */
+    nrels = 0;
+  else if (job->complete != 0)
     {
-      if (!partial || complete == nrels)
-	/* Mark this relocation section as being empty now that we have
-	   done its work.  This affects unstrip -R, so e.g. it emits an
-	   empty .rela.debug_info along with a .debug_info that has
-	   already been fully relocated.  */
-	nrels = 0;
-      else if (complete != 0)
-	{
-	  /* We handled some of the relocations but not all.
-	     We've zeroed out the ones we processed.
-	     Now remove them from the section.  */
+      /* We handled some of the relocations but not all.
+	 We've zeroed out the ones we processed.
+	 Now remove them from the section.  */
 
-	  size_t next = 0;
-	  if (shdr->sh_type == SHT_REL)
-	    for (size_t relidx = 0; relidx < nrels; ++relidx)
+      size_t next = 0;
+      if (shdr->sh_type == SHT_REL)
+	for (size_t relidx = 0; relidx < nrels; ++relidx)
+	  {
+	    GElf_Rel rel_mem;
+	    GElf_Rel *r = gelf_getrel (reldata, relidx, &rel_mem);
+	    if (unlikely (r == NULL))
+	      return DWFL_E_LIBELF;
+	    if (r->r_info != 0 || r->r_offset != 0)
 	      {
-		GElf_Rel rel_mem;
-		GElf_Rel *r = gelf_getrel (reldata, relidx, &rel_mem);
-		if (unlikely (r == NULL))
-		  return DWFL_E_LIBELF;
-		if (r->r_info != 0 || r->r_offset != 0)
-		  {
-		    if (next != relidx)
-		      if (unlikely (gelf_update_rel (reldata, next, r) == 0))
-			return DWFL_E_LIBELF;
-		    ++next;
-		  }
+		if (next != relidx)
+		  if (unlikely (gelf_update_rel (reldata, next, r) == 0))
+		    return DWFL_E_LIBELF;
+		++next;
 	      }
-	  else
-	    for (size_t relidx = 0; relidx < nrels; ++relidx)
+	  }
+      else
+	for (size_t relidx = 0; relidx < nrels; ++relidx)
+	  {
+	    GElf_Rela rela_mem;
+	    GElf_Rela *r = gelf_getrela (reldata, relidx, &rela_mem);
+	    if (unlikely (r == NULL))
+	      return DWFL_E_LIBELF;
+	    if (r->r_info != 0 || r->r_offset != 0 || r->r_addend != 0)
 	      {
-		GElf_Rela rela_mem;
-		GElf_Rela *r = gelf_getrela (reldata, relidx, &rela_mem);
-		if (unlikely (r == NULL))
-		  return DWFL_E_LIBELF;
-		if (r->r_info != 0 || r->r_offset != 0 || r->r_addend != 0)
-		  {
-		    if (next != relidx)
-		      if (unlikely (gelf_update_rela (reldata, next, r) == 0))
-			return DWFL_E_LIBELF;
-		    ++next;
-		  }
+		if (next != relidx)
+		  if (unlikely (gelf_update_rela (reldata, next, r) == 0))
+		    return DWFL_E_LIBELF;
+		++next;
 	      }
-	  nrels = next;
+	  }
+      nrels = next;
+    }
+
+  shdr->sh_size = reldata->d_size = nrels * job->entsize;
+  if (unlikely (gelf_update_shdr (job->scn, shdr) == 0))
+    return DWFL_E_LIBELF;
+
+  return DWFL_E_NOERROR;
+}
+
+static Dwfl_Error
+relocate_section (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
+		  size_t shstrndx, struct reloc_symtab_cache *reloc_symtab,
+		  Elf_Scn *scn, GElf_Shdr *shdr,
+		  Elf_Scn *tscn, bool debugscn, bool partial)
+{
+  struct reloc_job job;
+  Dwfl_Error result = prepare_section (mod, relocated, ehdr, shstrndx,
+				       scn, shdr, tscn, debugscn, &job);
+  if (result != DWFL_E_NOERROR || job.reldata == NULL)
+    return result;
+
+  result = apply_section (mod, relocated, ehdr, reloc_symtab, &job, partial);
+  if (likely (result == DWFL_E_NOERROR))
+    result = finish_section (&job, partial);
+  return result;
+}
+
+/* Don't start a thread for fewer relocations than this.  */
+#define RELOC_THREAD_MIN	(64 * 1024)
+
+/* Return how many threads are worth using to apply the relocation
+   sections __libdwfl_relocate would apply to RELOCATED.  That is never
+   more than __libdwfl_nthreads allows.  */
+static unsigned int
+relocate_nthreads (Dwfl_Module *mod, Elf *relocated, size_t shstrndx,
+		   bool debug)
+{
+  unsigned int maxthreads = __libdwfl_nthreads (mod->dwfl);
+  if (maxthreads <= 1)
+    return 1;
+
+  size_t nsects = 0;
+  size_t nrels = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (relocated, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr == NULL
+	  || (shdr->sh_type != SHT_REL && shdr->sh_type != SHT_RELA)
+	  || shdr->sh_size == 0)
+	continue;
+
+      if (debug)
+	{
+	  GElf_Shdr tshdr_mem;
+	  GElf_Shdr *tshdr = gelf_getshdr (elf_getscn (relocated,
+						       shdr->sh_info),
+					   &tshdr_mem);
+	  const char *tname = (tshdr == NULL ? NULL
+			       : elf_strptr (relocated, shstrndx,
+					     tshdr->sh_name));
+	  if (tname == NULL || ! ebl_debugscn_p (mod->ebl, tname))
+	    continue;
+	}
+
+      ++nsects;
+      nrels += shdr->sh_size / gelf_fsize (relocated,
+					   (shdr->sh_type == SHT_REL
+					    ? ELF_T_REL : ELF_T_RELA),
+					   1, EV_CURRENT);
+    }
+
+  return MIN (MIN (nrels / RELOC_THREAD_MIN, nsects), maxthreads);
+}
+
+/* The relocation sections being applied by several threads.  */
+struct reloc_threads
+{
+  Dwfl_Module *mod;
+  Elf *relocated;
+  const GElf_Ehdr *ehdr;
+  struct reloc_symtab_cache *reloc_symtab;
+
+  /* The first job for each target section.  Different target sections
+     can be relocated independently.  Protected by LOCK.  */
+  struct reloc_job **groups;
+  size_t ngroups;
+  size_t next;
+  bool failed;
+  pthread_mutex_t lock;
+};
+
+static void *
+relocate_thread (void *arg)
+{
+  struct reloc_threads *rt = arg;
+
+  pthread_mutex_lock (&rt->lock);
+  while (! rt->failed && rt->next < rt->ngroups)
+    {
+      struct reloc_job *job = rt->groups[rt->next++];
+      pthread_mutex_unlock (&rt->lock);
+
+      /* Stop at the first error, like the serial loop does.  No new
+	 groups are started after that either.  */
+      bool failed = false;
+      for (; job != NULL && ! failed; job = job->next)
+	{
+	  job->result = apply_section (rt->mod, rt->relocated, rt->ehdr,
+				       rt->reloc_symtab, job, true);
+	  job->applied = true;
+	  failed = job->result != DWFL_E_NOERROR;
 	}
 
-      shdr->sh_size = reldata->d_size = nrels * sh_entsize;
-      if (unlikely (gelf_update_shdr (scn, shdr) == 0))
+      pthread_mutex_lock (&rt->lock);
+      if (failed)
+	rt->failed = true;
+    }
+  pthread_mutex_unlock (&rt->lock);
+
+  return NULL;
+}
+
+/* Do what the loop in __libdwfl_relocate does, but in NTHREADS threads.
+   Everything that changes the ELF file is done here first, then the
+   threads only write the section data and symbol values.  */
+static Dwfl_Error
+relocate_threaded (Dwfl_Module *mod, Elf *relocated, const GElf_Ehdr *ehdr,
+		   size_t shstrndx, struct reloc_symtab_cache *reloc_symtab,
+		   bool debug, unsigned int nthreads)
+{
+  size_t shnum;
+  if (elf_getshdrnum (relocated, &shnum) < 0)
+    return DWFL_E_LIBELF;
+
+  size_t njobs = 0;
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (relocated, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (unlikely (shdr == NULL))
 	return DWFL_E_LIBELF;
+      if ((shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
+	  && shdr->sh_size != 0)
+	++njobs;
+    }
+
+  struct reloc_threads rt =
+    {
+      .mod = mod,
+      .relocated = relocated,
+      .ehdr = ehdr,
+      .reloc_symtab = reloc_symtab,
+    };
+  struct reloc_job *jobs = malloc (njobs * sizeof jobs[0]);
+  struct reloc_job **last = calloc (shnum, sizeof last[0]);
+  rt.groups = malloc (njobs * sizeof rt.groups[0]);
+  pthread_t *threads = malloc (nthreads * sizeof threads[0]);
+  if (unlikely (jobs == NULL || last == NULL || rt.groups == NULL
+		|| threads == NULL))
+    {
+      free (jobs);
+      free (last);
+      free (rt.groups);
+      free (threads);
+      return DWFL_E_NOMEM;
     }
 
+  /* Prepare the sections in order, chaining the jobs that have the
+     same target section.  */
+  Dwfl_Error result = DWFL_E_NOERROR;
+  njobs = 0;
+  scn = NULL;
+  while (result == DWFL_E_NOERROR
+	 && (scn = elf_nextscn (relocated, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (unlikely (shdr == NULL))
+	{
+	  result = DWFL_E_LIBELF;
+	  break;
+	}
+      if ((shdr->sh_type != SHT_REL && shdr->sh_type != SHT_RELA)
+	  || shdr->sh_size == 0)
+	continue;
+
+      Elf_Scn *tscn = elf_getscn (relocated, shdr->sh_info);
+      if (unlikely (tscn == NULL))
+	{
+	  result = DWFL_E_LIBELF;
+	  break;
+	}
+
+      struct reloc_job *job = &jobs[njobs];
+      result = prepare_section (mod, relocated, ehdr, shstrndx,
+				scn, shdr, tscn, debug, job);
+      if (result != DWFL_E_NOERROR || job->reldata == NULL)
+	continue;
+
+      ++njobs;
+      if (last[shdr->sh_info] != NULL)
+	last[shdr->sh_info]->next = job;
+      else
+	rt.groups[rt.ngroups++] = job;
+      last[shdr->sh_info] = job;
+    }
+  free (last);
+
+  /* Give the threads a table for the symbol values.  If we cannot find
+     the symbol table now, relocate_getsym reports that when a symbol
+     is actually needed, and only this thread runs.  */
+  if (reloc_symtab_init (mod, relocated, reloc_symtab) == DWFL_E_NOERROR)
+    {
+      size_t syment = gelf_fsize (reloc_symtab->symelf, ELF_T_SYM, 1,
+				  EV_CURRENT);
+      reloc_symtab->nsymvals = reloc_symtab->symdata->d_size / syment;
+      reloc_symtab->symvals = calloc (reloc_symtab->nsymvals,
+				      sizeof reloc_symtab->symvals[0]);
+    }
+  if (reloc_symtab->symvals == NULL)
+    nthreads = 1;
+
+  pthread_mutex_init (&rt.lock, NULL);
+  reloc_symtab->lock = &rt.lock;
+
+  unsigned int started = 0;
+  while (started < nthreads - 1 && started < rt.ngroups
+	 && pthread_create (&threads[started], NULL,
+			    relocate_thread, &rt) == 0)
+    ++started;
+  relocate_thread (&rt);
+  for (unsigned int i = 0; i < started; ++i)
+    pthread_join (threads[i], NULL);
+
+  pthread_mutex_destroy (&rt.lock);
+  free (reloc_symtab->symvals);
+  reloc_symtab->symvals = NULL;
+  reloc_symtab->nsymvals = 0;
+  reloc_symtab->lock = NULL;
+
+  /* Finish every section that was applied successfully, also those
+     after one that failed, since their relocations have already been
+     zeroed out.  A failed section is left as the serial loop leaves it.
+     Report the first error in section order.  All these sections come
+     before one that failed to be prepared.  */
+  Dwfl_Error first = DWFL_E_NOERROR;
+  for (size_t i = 0; i < njobs; ++i)
+    {
+      Dwfl_Error applied = jobs[i].result;
+      if (jobs[i].applied && applied == DWFL_E_NOERROR)
+	applied = finish_section (&jobs[i], true);
+      if (first == DWFL_E_NOERROR)
+	first = applied;
+    }
+  if (first != DWFL_E_NOERROR)
+    result = first;
+
+  free (threads);
+  free (rt.groups);
+  free (jobs);
   return result;
 }
 
@@ -761,33 +1146,65 @@ __libdwfl_relocate (Dwfl_Module *mod, Elf *debugfile, bool debug)
 
   RELOC_SYMTAB_CACHE (reloc_symtab);
 
+  /* The relocated debugging sections might be cached from an earlier
+     session with the same load addresses.  */
+  struct dwfl_reloc_cache *cache = NULL;
+  if (debug && mod->dwfl->reloc_cache_dir != NULL)
+    {
+      cache = __libdwfl_reloc_cache_begin (mod, debugfile);
+      if (cache != NULL && __libdwfl_reloc_cache_load (mod, debugfile, cache))
+	{
+	  __libdwfl_reloc_cache_end (cache);
+	  return DWFL_E_NOERROR;
+	}
+    }
+
   /* Look at each section in the debuginfo file, and process the
      relocation sections for debugging sections.  */
   Dwfl_Error result = DWFL_E_NOERROR;
-  Elf_Scn *scn = NULL;
-  while (result == DWFL_E_NOERROR
-	 && (scn = elf_nextscn (debugfile, scn)) != NULL)
+  unsigned int nthreads = relocate_nthreads (mod, debugfile, d_shstrndx,
+					     debug);
+  if (nthreads > 1)
+    result = relocate_threaded (mod, debugfile, ehdr, d_shstrndx,
+				&reloc_symtab, debug, nthreads);
+  else
     {
-      GElf_Shdr shdr_mem;
-      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
-      if (unlikely (shdr == NULL))
-	return DWFL_E_LIBELF;
-
-      if ((shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
-	  && shdr->sh_size != 0)
+      Elf_Scn *scn = NULL;
+      while (result == DWFL_E_NOERROR
+	     && (scn = elf_nextscn (debugfile, scn)) != NULL)
 	{
-	  /* It's a relocation section.  */
-
-	  Elf_Scn *tscn = elf_getscn (debugfile, shdr->sh_info);
-	  if (unlikely (tscn == NULL))
-	    result = DWFL_E_LIBELF;
-	  else
-	    result = relocate_section (mod, debugfile, ehdr, d_shstrndx,
-				       &reloc_symtab, scn, shdr, tscn,
-				       debug, true /* partial always OK. */);
+	  GElf_Shdr shdr_mem;
+	  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+	  if (unlikely (shdr == NULL))
+	    {
+	      result = DWFL_E_LIBELF;
+	      break;
+	    }
+
+	  if ((shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
+	      && shdr->sh_size != 0)
+	    {
+	      /* It's a relocation section.  */
+
+	      Elf_Scn *tscn = elf_getscn (debugfile, shdr->sh_info);
+	      if (unlikely (tscn == NULL))
+		result = DWFL_E_LIBELF;
+	      else
+		result = relocate_section (mod, debugfile, ehdr, d_shstrndx,
+					   &reloc_symtab, scn, shdr, tscn,
+					   debug, true /* partial always OK. */);
+	    }
 	}
     }
 
+  /* Relocations that needed other modules' symbols can't be reused.  */
+  if (cache != NULL)
+    {
+      if (result == DWFL_E_NOERROR && ! reloc_symtab.external)
+	__libdwfl_reloc_cache_store (mod, debugfile, cache);
+      __libdwfl_reloc_cache_end (cache);
+    }
+
   return result;
 }
 
@@ -29,6 +29,7 @@
 #include <dwarf.h>
 #include <libintl.h>
 #include <locale.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdio_ext.h>
@@ -37,7 +38,9 @@
 #include <unistd.h>
 
 #include <system.h>
+#include <libeu.h>
 #include <printversion.h>
+#include <demangle.h>
 
 
 /* Name and version of program.  */
@@ -50,6 +53,8 @@ ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 /* Values for the parameters which have no short form.  */
 #define OPT_DEMANGLER 0x100
 #define OPT_PRETTY 0x101  /* 'p' is already used to select the process.  */
+#define OPT_SERVER 0x102
+#define OPT_BATCH 0x103
 
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
@@ -76,6 +81,14 @@ static const struct argp_option options[] =
     N_("Print all information on one line, and indent inlines"), 0 },
 
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
+  { "batch", OPT_BATCH, NULL, 0,
+    N_("Read all ADDRs first, then look them up in address order and print \
+the answers in the order given"), 0 },
+  { "server", OPT_SERVER, NULL, 0,
+    N_("Answer requests read from stdin until end of file, keeping recently \
+used files and processes open.  Each request is an optional line \
+'file PATH', 'pid PID' or 'build-id HEX', then one ADDR per line, then an \
+empty line, which is echoed after the answer."), 0 },
   /* Unsupported options.  */
   { "target", 'b', "ARG", OPTION_HIDDEN, NULL, 0 },
   { "demangler", OPT_DEMANGLER, "ARG", OPTION_HIDDEN, NULL, 0 },
@@ -92,7 +105,10 @@ static const char args_doc[] = N_("[ADDR...]");
 /* Prototype for option handler.  */
 static error_t parse_opt (int key, char *arg, struct argp_state *state);
 
-static struct argp_child argp_children[2]; /* [0] is set in main.  */
+/* Prototype for the handler of the standard libdwfl options.  */
+static error_t parse_dwfl_opt (int key, char *arg, struct argp_state *state);
+
+static struct argp_child argp_children[3]; /* [0] and [1] are set in main.  */
 
 /* Data structure to communicate with argp functions.  */
 static const struct argp argp =
@@ -104,6 +120,12 @@ static const struct argp argp =
 /* Handle ADDR.  */
 static int handle_address (const char *addr, Dwfl *dwfl);
 
+/* Answer requests from stdin, DWFL is used when they name no target.  */
+static int serve (Dwfl *dwfl);
+
+/* Handle the NADDRS strings in ADDRS together.  */
+static int handle_batch (char **addrs, size_t naddrs, Dwfl *dwfl);
+
 /* True when we should print the address for each entry.  */
 static bool print_addresses;
 
@@ -137,10 +159,21 @@ static bool demangle;
 /* True if all information should be printed on one line.  */
 static bool pretty;
 
-#ifdef USE_DEMANGLE
-static size_t demangle_buffer_len = 0;
-static char *demangle_buffer = NULL;
-#endif
+/* True if requests should be read from stdin.  */
+static bool server;
+
+/* True if all addresses should be looked up together.  */
+static bool batch;
+
+/* The standard libdwfl options, parsed by parse_dwfl_opt first.  */
+static struct argp dwfl_argp;
+static argp_parser_t dwfl_argp_parser;
+
+/* True if the standard libdwfl options selected what to look at.  */
+static bool dwfl_target;
+
+/* The --debuginfo-path option, also used for --server requests.  */
+static char *debuginfo_path;
 
 int
 main (int argc, char *argv[])
@@ -161,15 +194,65 @@ main (int argc, char *argv[])
   (void) textdomain (PACKAGE_TARNAME);
 
   /* Parse and process arguments.  This includes opening the modules.  */
-  argp_children[0].argp = dwfl_standard_argp ();
+  dwfl_argp = *dwfl_standard_argp ();
+  dwfl_argp_parser = dwfl_argp.parser;
+  dwfl_argp.parser = parse_dwfl_opt;
+  argp_children[0].argp = &dwfl_argp;
   argp_children[0].group = 1;
+  argp_children[1].argp = &demangle_argp;
   Dwfl *dwfl = NULL;
   (void) argp_parse (&argp, argc, argv, 0, &remaining, &dwfl);
-  assert (dwfl != NULL);
+  assert (dwfl != NULL || server);
 
   /* Now handle the addresses.  In case none are given on the command
      line, read from stdin.  */
-  if (remaining == argc)
+  if (server)
+    {
+      if (remaining < argc)
+	error (EXIT_FAILURE, 0,
+	       gettext ("addresses cannot be given with --server"));
+      result = serve (dwfl);
+    }
+  else if (batch)
+    {
+      if (remaining < argc)
+	result = handle_batch (&argv[remaining], argc - remaining, dwfl);
+      else
+	{
+	  /* We use no threads here which can interfere with handling a
+	     stream.  */
+	  (void) __fsetlocking (stdin, FSETLOCKING_BYCALLER);
+
+	  char **addrs = NULL;
+	  size_t naddrs = 0;
+	  size_t maxaddrs = 0;
+	  char *buf = NULL;
+	  size_t len = 0;
+	  ssize_t chars;
+	  while ((chars = getline (&buf, &len, stdin)) > 0)
+	    {
+	      if (buf[chars - 1] == '\n')
+		buf[chars - 1] = '\0';
+
+	      if (naddrs == maxaddrs)
+		{
+		  maxaddrs = maxaddrs == 0 ? 1024 : 2 * maxaddrs;
+		  addrs = xrealloc (addrs, maxaddrs * sizeof addrs[0]);
+		}
+	      addrs[naddrs++] = buf;
+	      buf = NULL;
+	      len = 0;
+	    }
+	  free (buf);
+
+	  result = handle_batch (addrs, naddrs, dwfl);
+
+	  for (size_t i = 0; i < naddrs; ++i)
+	    free (addrs[i]);
+	  free (addrs);
+	}
+    }
+  else if (remaining == argc)
     {
       /* We use no threads here which can interfere with handling a stream.  */
       (void) __fsetlocking (stdin, FSETLOCKING_BYCALLER);
@@ -200,9 +283,7 @@ main (int argc, char *argv[])
 
   dwfl_end (dwfl);
 
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
+  demangle_cache_end ();
 
   return result;
 }
@@ -265,25 +346,52 @@ parse_opt (int key, char *arg, struct argp_state *state)
       pretty = true;
       break;
 
+    case OPT_SERVER:
+      server = true;
+      break;
+
+    case OPT_BATCH:
+      batch = true;
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
   return 0;
 }
 
+/* Handle the standard libdwfl options.  */
+static error_t
+parse_dwfl_opt (int key, char *arg, struct argp_state *state)
+{
+  if (key == ARGP_KEY_SUCCESS && server && !dwfl_target)
+    {
+      /* Requests name what to look at, so don't default to -e a.out.
+	 Just let the standard parser clean up.  */
+      dwfl_argp_parser (ARGP_KEY_ERROR, NULL, state);
+      return 0;
+    }
+
+  for (const struct argp_option *o = dwfl_argp.options; o->name != NULL
+	 || o->doc != NULL; ++o)
+    if (o->key == key && key != 0)
+      {
+	if (strcmp (o->name, "debuginfo-path") == 0)
+	  debuginfo_path = arg;
+	else
+	  dwfl_target = true;
+	break;
+      }
+
+  return dwfl_argp_parser (key, arg, state);
+}
+
 static const char *
 symname (const char *name)
 {
 #ifdef USE_DEMANGLE
-  // Require GNU v3 ABI by the "_Z" prefix.
-  if (demangle && name[0] == '_' && name[1] == 'Z')
-    {
-      int status = -1;
-      char *dsymname = __cxa_demangle (name, demangle_buffer,
-				       &demangle_buffer_len, &status);
-      if (status == 0)
-	name = demangle_buffer = dsymname;
-    }
+  if (demangle)
+    name = demangle_cached (name);
 #endif
   return name;
 }
@@ -306,7 +414,7 @@ get_diename (Dwarf_Die *die)
 }
 
 static bool
-print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
+print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr, FILE *out)
 {
   Dwarf_Addr bias = 0;
   Dwarf_Die *cudie = dwfl_module_addrdie (mod, addr, &bias);
@@ -325,7 +433,7 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
 	  const char *name = get_diename (&scopes[i]);
 	  if (name == NULL)
 	    goto done;
-	  printf ("%s%c", symname (name), pretty ? ' ' : '\n');
+	  fprintf (out, "%s%c", symname (name), pretty ? ' ' : '\n');
 	  res = true;
 	  goto done;
 	}
@@ -340,12 +448,12 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
 	     own line.  Just print the first subroutine name.  */
 	  if (pretty)
 	    {
-	      printf ("%s ", symname (name));
+	      fprintf (out, "%s ", symname (name));
 	      res = true;
 	      goto done;
 	    }
 	  else
-	    printf ("%s inlined", symname (name));
+	    fprintf (out, "%s inlined", symname (name));
 
 	  Dwarf_Files *files;
 	  if (dwarf_getsrcfiles (cudie, &files, NULL) == 0)
@@ -388,17 +496,17 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
 		    }
 
 		  if (lineno == 0)
-		    printf (" from %s%s%s",
-			    comp_dir, comp_dir_sep, file);
+		    fprintf (out, " from %s%s%s",
+			     comp_dir, comp_dir_sep, file);
 		  else if (colno == 0)
-		    printf (" at %s%s%s:%u",
-			    comp_dir, comp_dir_sep, file, lineno);
+		    fprintf (out, " at %s%s%s:%u",
+			     comp_dir, comp_dir_sep, file, lineno);
 		  else
-		    printf (" at %s%s%s:%u:%u",
-			    comp_dir, comp_dir_sep, file, lineno, colno);
+		    fprintf (out, " at %s%s%s:%u:%u",
+			     comp_dir, comp_dir_sep, file, lineno, colno);
 		}
 	    }
-	  printf (" in ");
+	  fprintf (out, " in ");
 	  continue;
 	}
       }
@@ -409,7 +517,7 @@ done:
 }
 
 static void
-print_addrsym (Dwfl_Module *mod, GElf_Addr addr)
+print_addrsym (Dwfl_Module *mod, GElf_Addr addr, FILE *out)
 {
   GElf_Sym s;
   GElf_Off off;
@@ -422,17 +530,17 @@ print_addrsym (Dwfl_Module *mod, GElf_Addr addr)
       if (i >= 0)
 	name = dwfl_module_relocation_info (mod, i, NULL);
       if (name == NULL)
-	printf ("??%c", pretty ? ' ': '\n');
+	fprintf (out, "??%c", pretty ? ' ': '\n');
       else
-	printf ("(%s)+%#" PRIx64 "%c", name, addr, pretty ? ' ' : '\n');
+	fprintf (out, "(%s)+%#" PRIx64 "%c", name, addr, pretty ? ' ' : '\n');
     }
   else
     {
       name = symname (name);
       if (off == 0)
-	printf ("%s", name);
+	fprintf (out, "%s", name);
       else
-	printf ("%s+%#" PRIx64 "", name, off);
+	fprintf (out, "%s+%#" PRIx64 "", name, off);
 
       // Also show section name for address.
       if (show_symbol_sections)
@@ -448,12 +556,12 @@ print_addrsym (Dwfl_Module *mod, GElf_Addr addr)
 		  Elf *elf = dwfl_module_getelf (mod, &ebias);
 		  size_t shstrndx;
 		  if (elf_getshdrstrndx (elf, &shstrndx) >= 0)
-		    printf (" (%s)", elf_strptr (elf, shstrndx,
-						 shdr->sh_name));
+		    fprintf (out, " (%s)", elf_strptr (elf, shstrndx,
+						       shdr->sh_name));
 		}
 	    }
 	}
-      printf ("%c", pretty ? ' ' : '\n');
+      fprintf (out, "%c", pretty ? ' ' : '\n');
     }
 }
 
@@ -552,7 +660,8 @@ adjust_to_section (const char *name, uintmax_t *addr, Dwfl *dwfl)
 }
 
 static void
-print_src (const char *src, int lineno, int linecol, Dwarf_Die *cu)
+print_src (const char *src, int lineno, int linecol, Dwarf_Die *cu,
+	   FILE *out)
 {
   const char *comp_dir = "";
   const char *comp_dir_sep = "";
@@ -568,11 +677,11 @@ print_src (const char *src, int lineno, int linecol, Dwarf_Die *cu)
     }
 
   if (linecol != 0)
-    printf ("%s%s%s:%d:%d",
-	    comp_dir, comp_dir_sep, src, lineno, linecol);
+    fprintf (out, "%s%s%s:%d:%d",
+	     comp_dir, comp_dir_sep, src, lineno, linecol);
   else
-    printf ("%s%s%s:%d",
-	    comp_dir, comp_dir_sep, src, lineno);
+    fprintf (out, "%s%s%s:%d",
+	     comp_dir, comp_dir_sep, src, lineno);
 }
 
 static int
@@ -598,8 +707,10 @@ get_addr_width (Dwfl_Module *mod)
   return width;
 }
 
-static int
-handle_address (const char *string, Dwfl *dwfl)
+/* Parse STRING into *ADDRP.  Returns false if it is not a valid
+   address, symbol or section offset.  */
+static bool
+parse_address (const char *string, Dwfl *dwfl, uintmax_t *addrp)
 {
   char *endp;
   uintmax_t addr = strtoumax (string, &endp, 16);
@@ -645,37 +756,45 @@ handle_address (const char *string, Dwfl *dwfl)
 
       free (name);
       if (!parsed)
-	return 1;
+	return false;
     }
   else if (just_section != NULL
 	   && !adjust_to_section (just_section, &addr, dwfl))
-    return 1;
+    return false;
 
+  *addrp = addr;
+  return true;
+}
+
+/* Print everything requested about ADDR to OUT.  */
+static int
+print_address (Dwfl *dwfl, Dwarf_Addr addr, FILE *out)
+{
   Dwfl_Module *mod = dwfl_addrmodule (dwfl, addr);
 
   if (print_addresses)
     {
       int width = get_addr_width (mod);
-      printf ("0x%.*" PRIx64 "%s", width, addr, pretty ? ": " : "\n");
+      fprintf (out, "0x%.*" PRIx64 "%s", width, addr, pretty ? ": " : "\n");
     }
 
   if (show_functions)
     {
       /* First determine the function name.  Use the DWARF information if
 	 possible.  */
-      if (! print_dwarf_function (mod, addr) && !show_symbols)
+      if (! print_dwarf_function (mod, addr, out) && !show_symbols)
 	{
 	  const char *name = dwfl_module_addrname (mod, addr);
 	  name = name != NULL ? symname (name) : "??";
-	  printf ("%s%c", name, pretty ? ' ' : '\n');
+	  fprintf (out, "%s%c", name, pretty ? ' ' : '\n');
 	}
     }
 
   if (show_symbols)
-    print_addrsym (mod, addr);
+    print_addrsym (mod, addr, out);
 
   if ((show_functions || show_symbols) && pretty)
-    printf ("at ");
+    fprintf (out, "at ");
 
   Dwfl_Line *line = dwfl_module_getsrc (mod, addr);
 
@@ -685,7 +804,7 @@ handle_address (const char *string, Dwfl *dwfl)
   if (line != NULL && (src = dwfl_lineinfo (line, &addr, &lineno, &linecol,
 					    NULL, NULL)) != NULL)
     {
-      print_src (src, lineno, linecol, dwfl_linecu (line));
+      print_src (src, lineno, linecol, dwfl_linecu (line), out);
       if (show_flags)
 	{
 	  Dwarf_Addr bias;
@@ -697,14 +816,14 @@ handle_address (const char *string, Dwfl *dwfl)
 	  {
 	    bool flag;
 	    if ((*get) (info, &flag) == 0 && flag)
-	      fputs (note, stdout);
+	      fputs (note, out);
 	  }
 	  inline void show_int (int (*get) (Dwarf_Line *, unsigned int *),
 				const char *name)
 	  {
 	    unsigned int val;
 	    if ((*get) (info, &val) == 0 && val != 0)
-	      printf (" (%s %u)", name, val);
+	      fprintf (out, " (%s %u)", name, val);
 	  }
 
 	  show (&dwarf_linebeginstatement, " (is_stmt)");
@@ -714,10 +833,10 @@ handle_address (const char *string, Dwfl *dwfl)
 	  show_int (&dwarf_lineisa, "isa");
 	  show_int (&dwarf_linediscriminator, "discriminator");
 	}
-      putchar ('\n');
+      putc ('\n', out);
     }
   else
-    puts ("??:0");
+    fputs ("??:0\n", out);
 
   if (show_inlines)
     {
@@ -755,7 +874,7 @@ handle_address (const char *string, Dwfl *dwfl)
 			continue;
 
 		      if (pretty)
-			printf (" (inlined by) ");
+			fprintf (out, " (inlined by) ");
 
 		      if (show_functions)
 			{
@@ -770,9 +889,9 @@ handle_address (const char *string, Dwfl *dwfl)
 				  || tag == DW_TAG_entry_point
 				  || tag == DW_TAG_subprogram)
 				{
-				  printf ("%s%s",
-					  symname (get_diename (parent)),
-					  pretty ? " at " : "\n");
+				  fprintf (out, "%s%s",
+					   symname (get_diename (parent)),
+					   pretty ? " at " : "\n");
 				  break;
 				}
 			    }
@@ -795,11 +914,11 @@ handle_address (const char *string, Dwfl *dwfl)
 
 		      if (src != NULL)
 			{
-			  print_src (src, lineno, linecol, &cu);
-			  putchar ('\n');
+			  print_src (src, lineno, linecol, &cu, out);
+			  putc ('\n', out);
 			}
 		      else
-			puts ("??:0");
+			fputs ("??:0\n", out);
 		    }
 		}
 	    }
@@ -810,5 +929,473 @@ handle_address (const char *string, Dwfl *dwfl)
   return 0;
 }
 
+static int
+handle_address (const char *string, Dwfl *dwfl)
+{
+  uintmax_t addr;
+  if (! parse_address (string, dwfl, &addr))
+    return 1;
+
+  return print_address (dwfl, addr, stdout);
+}
+
+
+/* One address of a --batch.  */
+struct batch_addr
+{
+  uintmax_t addr;
+
+  /* Index of the string it was parsed from.  */
+  size_t input;
+};
+
+/* The answer to one string of a --batch.  */
+struct batch_answer
+{
+  char *text;
+  size_t len;
+  int result;
+
+  /* True if TEXT belongs to an earlier answer for the same address.  */
+  bool shared;
+};
+
+/* The line tables to decode for a --batch.  */
+struct batch_cus
+{
+  Dwarf_Die **cus;
+  size_t ncus;
+  size_t next;
+  pthread_mutex_t lock;
+};
+
+static int
+compare_batch_addr (const void *p1, const void *p2)
+{
+  const struct batch_addr *a1 = p1;
+  const struct batch_addr *a2 = p2;
+
+  if (a1->addr != a2->addr)
+    return a1->addr < a2->addr ? -1 : 1;
+
+  /* Keep the input order of equal addresses.  */
+  return a1->input < a2->input ? -1 : a1->input > a2->input;
+}
+
+static int
+compare_cu (const void *p1, const void *p2)
+{
+  Dwarf_Die *const *d1 = p1;
+  Dwarf_Die *const *d2 = p2;
+
+  return *d1 < *d2 ? -1 : *d1 > *d2;
+}
+
+/* Thread function: decode the line tables of units not yet taken.  */
+static void *
+decode_batch_cus (void *arg)
+{
+  struct batch_cus *args = arg;
+
+  while (1)
+    {
+      pthread_mutex_lock (&args->lock);
+      size_t i = args->next++;
+      pthread_mutex_unlock (&args->lock);
+      if (i >= args->ncus)
+	break;
+
+      Dwarf_Lines *lines;
+      size_t nlines;
+      (void) dwarf_getsrclines (args->cus[i], &lines, &nlines);
+    }
+
+  return NULL;
+}
+
+/* Decode the line tables of the units ADDRS are in, using as many
+   threads as there are CPUs.  Finding the units is not thread safe,
+   but decoding different ones at the same time is.  */
+static void
+decode_batch_lines (Dwfl *dwfl, const struct batch_addr *addrs,
+		    size_t naddrs)
+{
+  Dwarf_Die **cus = xmalloc (naddrs * sizeof cus[0]);
+  size_t ncus = 0;
+  Dwarf_Die *last = NULL;
+  for (size_t i = 0; i < naddrs; ++i)
+    {
+      Dwfl_Module *mod = dwfl_addrmodule (dwfl, addrs[i].addr);
+      Dwarf_Addr bias;
+      Dwarf_Die *cudie = dwfl_module_addrdie (mod, addrs[i].addr, &bias);
+      if (cudie == NULL || cudie == last)
+	continue;
+      last = cudie;
+
+      /* Split units get their lines from the skeleton unit.  Finding
+	 that is not thread safe, so do it right away.  The same goes for
+	 opening the alternate debug file.  */
+      uint8_t unit_type;
+      if (dwarf_cu_info (cudie->cu, NULL, &unit_type,
+			 NULL, NULL, NULL, NULL, NULL) != 0
+	  || unit_type == DW_UT_split_compile
+	  || unit_type == DW_UT_split_type)
+	{
+	  Dwarf_Lines *lines;
+	  size_t nlines;
+	  (void) dwarf_getsrclines (cudie, &lines, &nlines);
+	  continue;
+	}
+      (void) dwarf_getalt (dwarf_cu_getdwarf (cudie->cu));
+
+      /* Resolve the abbrev of the unit DIE here too, so the decoding
+	 threads don't need to look it up.  */
+      (void) dwarf_tag (cudie);
+
+      cus[ncus++] = cudie;
+    }
+
+  /* Addresses in sorted order can still go back and forth between
+     units, but each unit must only be decoded by one thread.  */
+  qsort (cus, ncus, sizeof cus[0], compare_cu);
+  size_t n = 0;
+  for (size_t i = 0; i < ncus; ++i)
+    if (n == 0 || cus[n - 1] != cus[i])
+      cus[n++] = cus[i];
+  ncus = n;
+
+  long int ncpus = sysconf (_SC_NPROCESSORS_ONLN);
+  size_t nthreads = ncpus > 1 ? (size_t) ncpus : 1;
+  if (nthreads > ncus)
+    nthreads = ncus;
+
+  struct batch_cus args = { .cus = cus, .ncus = ncus, .next = 0 };
+  pthread_mutex_init (&args.lock, NULL);
+  pthread_t *threads = NULL;
+  size_t nstarted = 0;
+  if (nthreads > 1)
+    threads = xmalloc ((nthreads - 1) * sizeof threads[0]);
+  for (size_t i = 0; i + 1 < nthreads; ++i)
+    if (pthread_create (&threads[nstarted], NULL, decode_batch_cus,
+			&args) == 0)
+      ++nstarted;
+  decode_batch_cus (&args);
+  for (size_t i = 0; i < nstarted; ++i)
+    pthread_join (threads[i], NULL);
+  free (threads);
+  pthread_mutex_destroy (&args.lock);
+  free (cus);
+}
+
+static int
+handle_batch (char **strings, size_t nstrings, Dwfl *dwfl)
+{
+  struct batch_answer *answers = xcalloc (nstrings, sizeof answers[0]);
+  struct batch_addr *addrs = xmalloc (nstrings * sizeof addrs[0]);
+  size_t naddrs = 0;
+  for (size_t i = 0; i < nstrings; ++i)
+    if (parse_address (strings[i], dwfl, &addrs[naddrs].addr))
+      addrs[naddrs++].input = i;
+    else
+      answers[i].result = 1;
+
+  /* Neighbouring addresses mostly share their unit, line table and
+     scopes, and the same address is only looked up once.  */
+  qsort (addrs, naddrs, sizeof addrs[0], compare_batch_addr);
+  decode_batch_lines (dwfl, addrs, naddrs);
+
+  for (size_t i = 0; i < naddrs; ++i)
+    {
+      struct batch_answer *answer = &answers[addrs[i].input];
+      if (i > 0 && addrs[i - 1].addr == addrs[i].addr)
+	{
+	  *answer = answers[addrs[i - 1].input];
+	  answer->shared = true;
+	  continue;
+	}
+
+      FILE *out = open_memstream (&answer->text, &answer->len);
+      if (out == NULL)
+	error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+      answer->result = print_address (dwfl, addrs[i].addr, out);
+      fclose (out);
+    }
+
+  int result = 0;
+  for (size_t i = 0; i < nstrings; ++i)
+    {
+      if (answers[i].text != NULL)
+	fwrite (answers[i].text, 1, answers[i].len, stdout);
+      result = answers[i].result;
+    }
+
+  for (size_t i = 0; i < nstrings; ++i)
+    if (! answers[i].shared)
+      free (answers[i].text);
+  free (answers);
+  free (addrs);
+
+  return result;
+}
+
+
+/* The files and processes --server keeps open.  */
+struct session
+{
+  struct session *next;
+
+  /* "file PATH" or "pid PID" as requested.  */
+  char *target;
+
+  /* The build ID of the main module of a file, if any.  */
+  const unsigned char *build_id;
+  int build_id_len;
+
+  Dwfl *dwfl;
+};
+
+/* How many sessions are kept open at most.  */
+#define MAX_SESSIONS 16
+
+static const Dwfl_Callbacks offline_callbacks =
+  {
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .debuginfo_path = &debuginfo_path,
+    .section_address = dwfl_offline_section_address,
+    .find_elf = dwfl_build_id_find_elf,
+  };
+
+static const Dwfl_Callbacks proc_callbacks =
+  {
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .debuginfo_path = &debuginfo_path,
+    .find_elf = dwfl_linux_proc_find_elf,
+  };
+
+static int
+session_build_id (Dwfl_Module *mod,
+		  void **userdata __attribute__ ((unused)),
+		  const char *name __attribute__ ((unused)),
+		  Dwarf_Addr start __attribute__ ((unused)),
+		  void *arg)
+{
+  struct session *s = arg;
+  GElf_Addr vaddr;
+  s->build_id_len = dwfl_module_build_id (mod, &s->build_id, &vaddr);
+  return DWARF_CB_ABORT;
+}
+
+/* Report the modules of TARGET into DWFL.  Returns zero on success.  */
+static int
+report_target (Dwfl *dwfl, const char *target)
+{
+  dwfl_report_begin (dwfl);
+  int result;
+  if (strncmp (target, "pid ", 4) == 0)
+    result = dwfl_linux_proc_report (dwfl, atoi (target + 4));
+  else
+    {
+      /* Like -e, show the file without address bias.  */
+      target += 5;
+      result = (dwfl_report_elf (dwfl, "", target, -1, 0, true) == NULL
+		? -1 : 0);
+    }
+  if (dwfl_report_end (dwfl, NULL, NULL) != 0)
+    result = -1;
+
+  if (result != 0)
+    {
+      if (result > 0)
+	error (0, result, "%s", target);
+      else
+	error (0, 0, "%s: %s", target, dwfl_errmsg (-1));
+    }
+  return result;
+}
+
+/* Return the session for TARGET, opened if necessary, and make it the
+   most recently used one in *SESSIONS.  */
+static struct session *
+get_session (struct session **sessions, const char *target)
+{
+  struct session **sp = sessions;
+  size_t n = 0;
+  while (*sp != NULL && strcmp ((*sp)->target, target) != 0)
+    {
+      sp = &(*sp)->next;
+      ++n;
+    }
+
+  struct session *s = *sp;
+  if (s != NULL)
+    {
+      /* The mappings of a process can have changed since the last
+	 request.  Modules that are still there are kept as they are.  */
+      if (strncmp (target, "pid ", 4) == 0
+	  && report_target (s->dwfl, target) != 0)
+	{
+	  *sp = s->next;
+	  dwfl_end (s->dwfl);
+	  free (s->target);
+	  free (s);
+	  return NULL;
+	}
+      *sp = s->next;
+    }
+  else
+    {
+      bool pid = strncmp (target, "pid ", 4) == 0;
+      Dwfl *dwfl = dwfl_begin (pid ? &proc_callbacks : &offline_callbacks);
+      if (dwfl == NULL)
+	{
+	  error (0, 0, "%s: %s", target, dwfl_errmsg (-1));
+	  return NULL;
+	}
+      if (report_target (dwfl, target) != 0)
+	{
+	  dwfl_end (dwfl);
+	  return NULL;
+	}
+
+      s = xcalloc (1, sizeof *s);
+      s->target = xstrdup (target);
+      s->dwfl = dwfl;
+      if (! pid)
+	dwfl_getmodules (dwfl, &session_build_id, s, 0);
+
+      /* Close the least recently used session if there are too many.  */
+      if (n >= MAX_SESSIONS)
+	{
+	  sp = sessions;
+	  while ((*sp)->next != NULL)
+	    sp = &(*sp)->next;
+	  dwfl_end ((*sp)->dwfl);
+	  free ((*sp)->target);
+	  free (*sp);
+	  *sp = NULL;
+	}
+    }
+
+  s->next = *sessions;
+  *sessions = s;
+  return s;
+}
+
+/* Return the session of the file with the build ID HEX.  Look at the
+   files already open first, then in the system .build-id directory.  */
+static struct session *
+get_build_id_session (struct session **sessions, const char *hex)
+{
+  size_t len = strlen (hex);
+  if (len < 4 || len % 2 != 0 || strspn (hex, "0123456789abcdef") != len)
+    {
+      error (0, 0, gettext ("invalid build ID '%s'"), hex);
+      return NULL;
+    }
+
+  for (struct session *s = *sessions; s != NULL; s = s->next)
+    if (s->build_id_len > 0 && (size_t) s->build_id_len * 2 == len)
+      {
+	int i = 0;
+	while (i < s->build_id_len)
+	  {
+	    unsigned int byte;
+	    if (sscanf (&hex[i * 2], "%2x", &byte) != 1
+		|| byte != s->build_id[i])
+	      break;
+	    ++i;
+	  }
+	if (i == s->build_id_len)
+	  return get_session (sessions, s->target);
+      }
+
+  /* The link without suffix is the file itself, but some systems only
+     have the separate debuginfo file.  */
+  char *target;
+  if (asprintf (&target, "file /usr/lib/debug/.build-id/%.2s/%s",
+		hex, &hex[2]) < 0)
+    error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+  if (access (target + 5, R_OK) != 0)
+    {
+      char *debug;
+      if (asprintf (&debug, "%s.debug", target) < 0)
+	error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+      free (target);
+      target = debug;
+    }
+
+  struct session *s = get_session (sessions, target);
+  free (target);
+  return s;
+}
+
+static int
+serve (Dwfl *dwfl)
+{
+  /* We use no threads here which can interfere with handling a stream.  */
+  (void) __fsetlocking (stdin, FSETLOCKING_BYCALLER);
+
+  struct session *sessions = NULL;
+  Dwfl *current = dwfl;
+  bool failed = false;
+  int result = 0;
+
+  char *buf = NULL;
+  size_t len = 0;
+  ssize_t chars;
+  while ((chars = getline (&buf, &len, stdin)) >= 0)
+    {
+      if (chars > 0 && buf[chars - 1] == '\n')
+	buf[--chars] = '\0';
+
+      if (chars == 0)
+	{
+	  /* End of the request, go back to the command line target.  */
+	  putchar ('\n');
+	  fflush (stdout);
+	  current = dwfl;
+	  failed = false;
+	  continue;
+	}
+
+      if (failed)
+	continue;
+
+      struct session *s = NULL;
+      if (strncmp (buf, "file ", 5) == 0 || strncmp (buf, "pid ", 4) == 0)
+	s = get_session (&sessions, buf);
+      else if (strncmp (buf, "build-id ", 9) == 0)
+	s = get_build_id_session (&sessions, buf + 9);
+      else if (current != NULL)
+	{
+	  result = handle_address (buf, current);
+	  continue;
+	}
+      else
+	error (0, 0, gettext ("no file, process or build ID requested"));
+
+      /* Ignore the rest of the request if its target is unusable.  */
+      if (s == NULL)
+	{
+	  failed = true;
+	  result = 1;
+	}
+      else
+	current = s->dwfl;
+    }
+  free (buf);
+
+  while (sessions != NULL)
+    {
+      struct session *s = sessions;
+      sessions = s->next;
+      dwfl_end (s->dwfl);
+      free (s->target);
+      free (s);
+    }
+
+  return result;
+}
+
 
 #include "debugpred.h"
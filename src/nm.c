@@ -33,7 +33,7 @@
 #include <libintl.h>
 #include <locale.h>
 #include <obstack.h>
-#include <search.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdio_ext.h>
@@ -45,6 +45,7 @@
 #include <system.h>
 #include <color.h>
 #include <printversion.h>
+#include <demangle.h>
 #include "../libebl/libeblP.h"
 #include "../libdwfl/libdwflP.h"
 
@@ -98,6 +99,9 @@ static const struct argp_option options[] =
     N_("Decode low-level symbol names into source code names"), 0 },
 #endif
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
+  { "jobs", 'j', "N", 0,
+    N_("Process up to N files or archive members, or the units of a single "
+       "file, in parallel"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -114,6 +118,7 @@ static error_t parse_opt (int key, char *arg, struct argp_state *state);
 static struct argp_child argp_children[] =
   {
     { &color_argp, 0, N_("Output formatting"), 2 },
+    { &demangle_argp, 0, NULL, 0 },
     { NULL, 0, NULL, 0}
   };
 
@@ -133,7 +138,7 @@ static int handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 
 /* Handle ELF file.  */
 static int handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
-		       const char *suffix);
+		       const char *suffix, FILE *out);
 
 
 #define INTERNAL_ERROR(fname) \
@@ -210,6 +215,267 @@ static enum
      a '@' after the identifying letter for the symbol class and type.  */
 static bool mark_special;
 
+/* Number of worker threads, from -j.  */
+static unsigned int njobs = 1;
+
+/* Upper limit for -j.  */
+#define MAX_JOBS 1024
+
+/* Number of threads collecting the local names of the CUs.  Only more
+   than one with -j when there is a single ELF file, which is then
+   handled in the main thread.  */
+static unsigned int nunit_threads = 1;
+
+
+/* With -j the symbols of every ELF file and archive member are
+   printed into a buffer by a worker thread.  The main thread opens
+   the files, queues a job for each ELF file and writes the buffers
+   out in the order the jobs were queued.  */
+struct nm_job
+{
+  /* What handle_elf is called for.  If ELF is NULL there is nothing
+     to do but write TEXT.  */
+  int fd;
+  Elf *elf;
+  char *prefix;
+  char *fname;
+  char *suffix;
+
+  /* The output and the return value of handle_elf.  */
+  char *text;
+  size_t textlen;
+  int result;
+  bool done;
+
+  /* Descriptors which are closed after the output is written.  This
+     keeps archives open until all their members are done.  */
+  Elf *end_elf;
+  int close_fd;
+};
+
+/* At most this many jobs per thread are waiting to be written out.
+   This limits the number of open files and the size of the buffers.  */
+#define JOBS_PER_THREAD 4
+
+/* The queue of jobs.  The indices only grow, the job with index I is
+   in slot I % JOBS_SIZE.  Jobs from JOBS_HEAD to JOBS_TAIL have not
+   been written out yet, JOBS_NEXT is the first job not yet taken by
+   a worker thread.  */
+static struct nm_job *jobs;
+static size_t jobs_size;
+static size_t jobs_head;
+static size_t jobs_next;
+static size_t jobs_tail;
+
+/* Set when all jobs are queued.  */
+static bool jobs_finished;
+
+/* The result of all jobs written out so far.  */
+static int jobs_result;
+
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_queued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t jobs_done = PTHREAD_COND_INITIALIZER;
+
+static pthread_t *workers;
+static unsigned int nworkers;
+
+
+static void *
+job_worker (void *arg __attribute__ ((unused)))
+{
+  pthread_mutex_lock (&jobs_lock);
+  while (true)
+    {
+      /* Skip the jobs which only write text.  */
+      while (jobs_next < jobs_tail && jobs[jobs_next % jobs_size].done)
+	++jobs_next;
+
+      if (jobs_next == jobs_tail)
+	{
+	  if (jobs_finished)
+	    break;
+	  pthread_cond_wait (&jobs_queued, &jobs_lock);
+	  continue;
+	}
+
+      struct nm_job *job = &jobs[jobs_next++ % jobs_size];
+      pthread_mutex_unlock (&jobs_lock);
+
+      FILE *out = open_memstream (&job->text, &job->textlen);
+      if (out == NULL)
+	error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+      int result = handle_elf (job->fd, job->elf, job->prefix, job->fname,
+			       job->suffix, out);
+      fclose (out);
+
+      pthread_mutex_lock (&jobs_lock);
+      job->result = result;
+      job->done = true;
+      pthread_cond_signal (&jobs_done);
+    }
+  pthread_mutex_unlock (&jobs_lock);
+
+  demangle_cache_thread_end ();
+
+  return NULL;
+}
+
+
+/* Start the worker threads.  Fall back to doing everything in the
+   main thread if none can be started.  */
+static void
+start_jobs (void)
+{
+  /* Worker threads report errors.  */
+  (void) __fsetlocking (stderr, FSETLOCKING_INTERNAL);
+
+  jobs_size = njobs * JOBS_PER_THREAD;
+  jobs = xmalloc (jobs_size * sizeof jobs[0]);
+  workers = xmalloc (njobs * sizeof workers[0]);
+  for (unsigned int i = 0; i < njobs; ++i)
+    if (pthread_create (&workers[nworkers], NULL, job_worker, NULL) == 0)
+      ++nworkers;
+
+  if (nworkers == 0)
+    {
+      free (jobs);
+      free (workers);
+      njobs = 1;
+    }
+}
+
+
+/* Write out the jobs which are done, in order.  If ALL wait for all
+   jobs, otherwise only until there is room for another one.  */
+static void
+write_jobs (bool all)
+{
+  pthread_mutex_lock (&jobs_lock);
+  while (jobs_head < jobs_tail)
+    {
+      struct nm_job *job = &jobs[jobs_head % jobs_size];
+      if (! job->done)
+	{
+	  if (! all && jobs_tail - jobs_head < jobs_size)
+	    break;
+	  pthread_cond_wait (&jobs_done, &jobs_lock);
+	  continue;
+	}
+      pthread_mutex_unlock (&jobs_lock);
+
+      fwrite_unlocked (job->text, 1, job->textlen, stdout);
+      jobs_result |= job->result;
+
+      if (job->end_elf != NULL && elf_end (job->end_elf) != 0)
+	INTERNAL_ERROR (job->fname);
+      if (job->close_fd != -1 && close (job->close_fd) != 0)
+	error (EXIT_FAILURE, errno, gettext ("while closing '%s'"),
+	       job->fname);
+
+      free (job->text);
+      free (job->prefix);
+      free (job->fname);
+      free (job->suffix);
+
+      pthread_mutex_lock (&jobs_lock);
+      ++jobs_head;
+    }
+  pthread_mutex_unlock (&jobs_lock);
+}
+
+
+/* Return the slot for a new job, after waiting for room.  */
+static struct nm_job *
+new_job (const char *fname)
+{
+  write_jobs (false);
+
+  struct nm_job *job = &jobs[jobs_tail % jobs_size];
+  memset (job, '\0', sizeof *job);
+  job->fname = xstrdup (fname);
+  job->close_fd = -1;
+  return job;
+}
+
+
+/* Make JOB visible to the worker threads.  */
+static void
+queue_job (struct nm_job *job)
+{
+  if (job->elf == NULL)
+    job->done = true;
+
+  pthread_mutex_lock (&jobs_lock);
+  ++jobs_tail;
+  pthread_cond_signal (&jobs_queued);
+  pthread_mutex_unlock (&jobs_lock);
+}
+
+
+/* Queue handle_elf for ELF.  ELF is ended after the output is
+   written, FD is closed then if CLOSE.  */
+static void
+queue_elf (int fd, Elf *elf, const char *prefix, const char *fname,
+	   const char *suffix, bool close)
+{
+  struct nm_job *job = new_job (fname);
+  job->fd = fd;
+  job->elf = elf;
+  job->prefix = prefix != NULL ? xstrdup (prefix) : NULL;
+  job->suffix = suffix != NULL ? xstrdup (suffix) : NULL;
+  job->end_elf = elf;
+  if (close)
+    job->close_fd = fd;
+  queue_job (job);
+}
+
+
+/* Queue TEXT of length TEXTLEN to be written out.  The job takes
+   over the malloced TEXT.  */
+static void
+queue_text (const char *fname, char *text, size_t textlen)
+{
+  struct nm_job *job = new_job (fname);
+  job->text = text;
+  job->textlen = textlen;
+  queue_job (job);
+}
+
+
+/* End ELF, and close FD unless it is -1, once all jobs queued so far
+   are written out.  */
+static void
+queue_end (const char *fname, Elf *elf, int fd)
+{
+  struct nm_job *job = new_job (fname);
+  job->end_elf = elf;
+  job->close_fd = fd;
+  queue_job (job);
+}
+
+
+/* Wait for all jobs and stop the worker threads.  Return the result
+   of all jobs.  */
+static int
+finish_jobs (void)
+{
+  pthread_mutex_lock (&jobs_lock);
+  jobs_finished = true;
+  pthread_cond_broadcast (&jobs_queued);
+  pthread_mutex_unlock (&jobs_lock);
+
+  write_jobs (true);
+
+  for (unsigned int i = 0; i < nworkers; ++i)
+    pthread_join (workers[i], NULL);
+
+  free (jobs);
+  free (workers);
+
+  return jobs_result;
+}
+
 
 int
 main (int argc, char *argv[])
@@ -237,6 +503,9 @@ main (int argc, char *argv[])
   /* Tell the library which version we are expecting.  */
   (void) elf_version (EV_CURRENT);
 
+  if (njobs > 1)
+    start_jobs ();
+
   if (remaining == argc)
     /* The user didn't specify a name so we use a.out.  */
     result = process_file ("a.out", false);
@@ -250,14 +519,18 @@ main (int argc, char *argv[])
       while (++remaining < argc);
     }
 
+  if (njobs > 1)
+    result |= finish_jobs ();
+
+  demangle_cache_end ();
+
   return result;
 }
 
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -286,6 +559,16 @@ parse_opt (int key, char *arg,
       hide_local = true;
       break;
 
+    case 'j':
+      {
+	char *endp;
+	unsigned long int n = strtoul (arg, &endp, 10);
+	if (*endp != '\0' || n == 0 || n > MAX_JOBS)
+	  argp_error (state, gettext ("invalid number of jobs '%s'"), arg);
+	njobs = n;
+      }
+      break;
+
     case 'n':
       sort = sort_numeric;
       break;
@@ -371,8 +654,19 @@ process_file (const char *fname, bool more_than_one)
     {
       if (elf_kind (elf) == ELF_K_ELF)
 	{
+	  if (njobs > 1 && more_than_one)
+	    {
+	      queue_elf (fd, elf, "", fname, NULL, true);
+	      return 0;
+	    }
+
+	  /* A single file is handled right here, the -j threads go
+	     through its CUs instead.  */
+	  if (njobs > 1)
+	    nunit_threads = njobs;
+
 	  int result = handle_elf (fd, elf, more_than_one ? "" : NULL,
-				   fname, NULL);
+				   fname, NULL, stdout);
 
 	  if (elf_end (elf) != 0)
 	    INTERNAL_ERROR (fname);
@@ -386,6 +680,12 @@ process_file (const char *fname, bool more_than_one)
 	{
 	  int result = handle_ar (fd, elf, NULL, fname, NULL);
 
+	  if (njobs > 1)
+	    {
+	      queue_end (fname, elf, fd);
+	      return result;
+	    }
+
 	  if (elf_end (elf) != 0)
 	    INTERNAL_ERROR (fname);
 
@@ -440,7 +740,18 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	  Elf_Arhdr *arhdr = NULL;
 	  size_t arhdr_off = 0;	/* Note: 0 is no valid offset.  */
 
-	  fputs_unlocked (gettext("\nArchive index:\n"), stdout);
+	  /* With -j the index is written out in between the jobs.  */
+	  char *text = NULL;
+	  size_t textlen = 0;
+	  FILE *out = stdout;
+	  if (njobs > 1)
+	    {
+	      out = open_memstream (&text, &textlen);
+	      if (out == NULL)
+		error (EXIT_FAILURE, errno, gettext ("memory exhausted"));
+	    }
+
+	  fputs_unlocked (gettext("\nArchive index:\n"), out);
 
 	  while (arsym->as_off != 0)
 	    {
@@ -454,11 +765,18 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 		  break;
 		}
 
-	      printf (gettext ("%s in %s\n"), arsym->as_name, arhdr->ar_name);
+	      fprintf (out, gettext ("%s in %s\n"),
+		       arsym->as_name, arhdr->ar_name);
 
 	      ++arsym;
 	    }
 
+	  if (out != stdout)
+	    {
+	      fclose (out);
+	      queue_text (fname, text, textlen);
+	    }
+
 	  if (elf_rand (elf, SARMAG) != SARMAG)
 	    {
 	      error (0, 0,
@@ -480,11 +798,30 @@ handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 	  && strcmp (arhdr->ar_name, "/SYM64/") != 0)
 	{
 	  if (elf_kind (subelf) == ELF_K_ELF)
-	    result |= handle_elf (fd, subelf, new_prefix, arhdr->ar_name,
-				  new_suffix);
+	    {
+	      if (njobs > 1)
+		{
+		  /* The job ends SUBELF when it is done.  */
+		  queue_elf (fd, subelf, new_prefix, arhdr->ar_name,
+			     new_suffix, false);
+		  cmd = elf_next (subelf);
+		  continue;
+		}
+
+	      result |= handle_elf (fd, subelf, new_prefix, arhdr->ar_name,
+				    new_suffix, stdout);
+	    }
 	  else if (elf_kind (subelf) == ELF_K_AR)
-	    result |= handle_ar (fd, subelf, new_prefix, arhdr->ar_name,
-				 new_suffix);
+	    {
+	      result |= handle_ar (fd, subelf, new_prefix, arhdr->ar_name,
+				   new_suffix);
+	      if (njobs > 1)
+		{
+		  queue_end (arhdr->ar_name, subelf, -1);
+		  cmd = elf_next (subelf);
+		  continue;
+		}
+	    }
 	  else
 	    {
 	      error (0, 0, gettext ("%s%s%s: file format not recognized"),
@@ -521,31 +858,86 @@ static const int length_map[2][3] =
 };
 
 
+/* The pubnames of a file, sorted by name.  */
+struct global_names
+{
+  struct global_name
+  {
+    Dwarf_Global global;
+    /* Index in the pubnames, the first one of several with the same
+       name is used.  */
+    size_t order;
+  } *names;
+  size_t nnames;
+  size_t nalloc;
+};
+
+
 static int
 global_compare (const void *p1, const void *p2)
 {
-  const Dwarf_Global *g1 = (const Dwarf_Global *) p1;
-  const Dwarf_Global *g2 = (const Dwarf_Global *) p2;
+  const struct global_name *g1 = (const struct global_name *) p1;
+  const struct global_name *g2 = (const struct global_name *) p2;
 
-  return strcmp (g1->name, g2->name);
+  int result = strcmp (g1->global.name, g2->global.name);
+  if (result == 0)
+    result = g1->order < g2->order ? -1 : g1->order > g2->order;
+  return result;
 }
 
 
-static void *global_root;
-
-
+/* Add GLOBAL to the struct global_names ARG points to.  */
 static int
 get_global (Dwarf *dbg __attribute__ ((unused)), Dwarf_Global *global,
-	    void *arg __attribute__ ((unused)))
+	    void *arg)
 {
-  tsearch (memcpy (xmalloc (sizeof (Dwarf_Global)), global,
-		   sizeof (Dwarf_Global)),
-	   &global_root, global_compare);
+  struct global_names *globals = arg;
+  if (globals->nnames == globals->nalloc)
+    {
+      globals->nalloc = globals->nalloc == 0 ? 64 : 2 * globals->nalloc;
+      globals->names = xrealloc (globals->names,
+				 globals->nalloc * sizeof globals->names[0]);
+    }
+  globals->names[globals->nnames].global = *global;
+  globals->names[globals->nnames].order = globals->nnames;
+  ++globals->nnames;
 
   return DWARF_CB_OK;
 }
 
 
+/* Get all pubnames of DBG into GLOBALS, sorted by name.  */
+static void
+get_global_names (Dwarf *dbg, struct global_names *globals)
+{
+  (void) dwarf_getpubnames (dbg, get_global, globals, 0);
+  qsort (globals->names, globals->nnames, sizeof globals->names[0],
+	 global_compare);
+}
+
+
+/* Find the first pubname called NAME.  */
+static Dwarf_Global *
+find_global (struct global_names *globals, const char *name)
+{
+  size_t lo = 0;
+  size_t hi = globals->nnames;
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      if (strcmp (globals->names[mid].global.name, name) < 0)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo < globals->nnames
+      && strcmp (globals->names[lo].global.name, name) == 0)
+    return &globals->names[lo].global;
+  return NULL;
+}
+
+
 struct local_name
 {
   const char *name;
@@ -553,35 +945,36 @@ struct local_name
   Dwarf_Word lineno;
   Dwarf_Addr lowpc;
   Dwarf_Addr highpc;
+  size_t order;
 };
 
+/* The local names of a file or of one CU.  All names of a file are
+   sorted by name and address.  */
+struct local_names
+{
+  struct local_name *names;
+  size_t nnames;
+  size_t nalloc;
+};
 
+
+/* Sort by name, then by address range with an enclosing range first,
+   then in the order the names were found.  */
 static int
 local_compare (const void *p1, const void *p2)
 {
-  struct local_name *g1 = (struct local_name *) p1;
-  struct local_name *g2 = (struct local_name *) p2;
-  int result;
+  const struct local_name *g1 = (const struct local_name *) p1;
+  const struct local_name *g2 = (const struct local_name *) p2;
 
-  result = strcmp (g1->name, g2->name);
+  int result = strcmp (g1->name, g2->name);
   if (result == 0)
     {
-      if (g1->lowpc <= g2->lowpc && g1->highpc >= g2->highpc)
-	{
-	  /* g2 is contained in g1.  Update the data.  */
-	  g2->lowpc = g1->lowpc;
-	  g2->highpc = g1->highpc;
-	  result = 0;
-	}
-      else if (g2->lowpc <= g1->lowpc && g2->highpc >= g1->highpc)
-	{
-	  /* g1 is contained in g2.  Update the data.  */
-	  g1->lowpc = g2->lowpc;
-	  g1->highpc = g2->highpc;
-	  result = 0;
-	}
-      else
+      if (g1->lowpc != g2->lowpc)
 	result = g1->lowpc < g2->lowpc ? -1 : 1;
+      else if (g1->highpc != g2->highpc)
+	result = g1->highpc > g2->highpc ? -1 : 1;
+      else if (g1->order != g2->order)
+	result = g1->order < g2->order ? -1 : 1;
     }
 
   return result;
@@ -613,101 +1006,259 @@ get_var_range (Dwarf_Die *die, Dwarf_Word *lowpc, Dwarf_Word *highpc)
 }
 
 
+/* A CU whose local names are collected by one of the threads.  */
+struct local_unit
+{
+  Dwarf_Die cudie;
+  struct local_names locals;
+};
 
-static void *local_root;
+struct local_units
+{
+  struct local_unit *units;
+  size_t nunits;
+  size_t next;
+  pthread_mutex_t lock;
+};
 
 
+/* Collect the names of the functions and variables which are
+   immediate children of UNIT's CU DIE.  */
 static void
-get_local_names (Dwarf *dbg)
+get_unit_local_names (struct local_unit *unit)
 {
+  /* Get the line information.  */
+  Dwarf_Files *files;
+  size_t nfiles;
+  if (dwarf_getsrcfiles (&unit->cudie, &files, &nfiles) != 0)
+    return;
+
+  Dwarf_Die die_mem;
+  Dwarf_Die *die = &die_mem;
+  if (dwarf_child (&unit->cudie, die) == 0)
+    /* Iterate over all immediate children of the CU DIE.  */
+    do
+      {
+	int tag = dwarf_tag (die);
+	if (tag != DW_TAG_subprogram && tag != DW_TAG_variable)
+	  continue;
+
+	/* We are interested in five attributes: name, decl_file,
+	   decl_line, low_pc, and high_pc.  */
+	Dwarf_Attribute attr_mem;
+	Dwarf_Attribute *attr = dwarf_attr (die, DW_AT_name, &attr_mem);
+	const char *name = dwarf_formstring (attr);
+	if (name == NULL)
+	  continue;
+
+	Dwarf_Word fileidx;
+	attr = dwarf_attr (die, DW_AT_decl_file, &attr_mem);
+	if (dwarf_formudata (attr, &fileidx) != 0 || fileidx >= nfiles)
+	  continue;
+
+	Dwarf_Word lineno;
+	attr = dwarf_attr (die, DW_AT_decl_line, &attr_mem);
+	if (dwarf_formudata (attr, &lineno) != 0 || lineno == 0)
+	  continue;
+
+	Dwarf_Addr lowpc;
+	Dwarf_Addr highpc;
+	if (tag == DW_TAG_subprogram)
+	  {
+	    if (dwarf_lowpc (die, &lowpc) != 0
+		|| dwarf_highpc (die, &highpc) != 0)
+	      continue;
+	  }
+	else
+	  {
+	    if (get_var_range (die, &lowpc, &highpc) != 0)
+	      continue;
+	  }
+
+	/* We have all the information.  Create a record.  */
+	struct local_names *locals = &unit->locals;
+	if (locals->nnames == locals->nalloc)
+	  {
+	    locals->nalloc = locals->nalloc == 0 ? 64 : 2 * locals->nalloc;
+	    locals->names = xrealloc (locals->names,
+				      locals->nalloc * sizeof locals->names[0]);
+	  }
+	struct local_name *newp = &locals->names[locals->nnames++];
+	newp->name = name;
+	newp->file = dwarf_filesrc (files, fileidx, NULL, NULL);
+	newp->lineno = lineno;
+	newp->lowpc = lowpc;
+	newp->highpc = highpc;
+      }
+    while (dwarf_siblingof (die, die) == 0);
+}
+
+
+/* Thread function: collect the local names of the CUs not yet taken.  */
+static void *
+get_local_units (void *arg)
+{
+  struct local_units *args = arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&args->lock);
+      size_t i = args->next++;
+      pthread_mutex_unlock (&args->lock);
+      if (i >= args->nunits)
+	break;
+
+      get_unit_local_names (&args->units[i]);
+    }
+
+  return NULL;
+}
+
+
+/* Get the names of the functions and variables of all CUs of DBG
+   into LOCALS, sorted by name and address.  The CUs are gone through
+   in NUNIT_THREADS threads.  */
+static void
+get_local_names (Dwarf *dbg, struct local_names *locals)
+{
+  struct local_units args = { .units = NULL, .nunits = 0, .next = 0 };
+  size_t maxunits = 0;
+
+  /* Reading the unit headers must not be done in parallel.  */
   Dwarf_Off offset = 0;
   Dwarf_Off old_offset;
   size_t hsize;
-
   while (dwarf_nextcu (dbg, old_offset = offset, &offset, &hsize, NULL, NULL,
 		       NULL) == 0)
     {
-      Dwarf_Die cudie_mem;
-      Dwarf_Die *cudie = dwarf_offdie (dbg, old_offset + hsize, &cudie_mem);
+      if (args.nunits == maxunits)
+	{
+	  maxunits = maxunits == 0 ? 64 : 2 * maxunits;
+	  args.units = xrealloc (args.units, maxunits * sizeof args.units[0]);
+	}
+
+      struct local_unit *unit = &args.units[args.nunits];
 
       /* If we cannot get the CU DIE there is no need to go on with
 	 this CU.  */
-      if (cudie == NULL)
+      if (dwarf_offdie (dbg, old_offset + hsize, &unit->cudie) == NULL)
 	continue;
       /* This better be a CU DIE.  */
-      if (dwarf_tag (cudie) != DW_TAG_compile_unit)
+      if (dwarf_tag (&unit->cudie) != DW_TAG_compile_unit)
 	continue;
 
-      /* Get the line information.  */
-      Dwarf_Files *files;
-      size_t nfiles;
-      if (dwarf_getsrcfiles (cudie, &files, &nfiles) != 0)
-	continue;
+      unit->locals = (struct local_names) { NULL, 0, 0 };
+      ++args.nunits;
 
-      Dwarf_Die die_mem;
-      Dwarf_Die *die = &die_mem;
-      if (dwarf_child (cudie, die) == 0)
-	/* Iterate over all immediate children of the CU DIE.  */
-	do
-	  {
-	    int tag = dwarf_tag (die);
-	    if (tag != DW_TAG_subprogram && tag != DW_TAG_variable)
-	      continue;
+      /* Split units get their lines from the skeleton unit.  Finding
+	 that is not thread safe, so do it right away.  */
+      uint8_t unit_type;
+      if (dwarf_cu_info (unit->cudie.cu, NULL, &unit_type, NULL, NULL,
+			 NULL, NULL, NULL) == 0
+	  && (unit_type == DW_UT_split_compile
+	      || unit_type == DW_UT_split_type))
+	{
+	  Dwarf_Files *files;
+	  size_t nfiles;
+	  (void) dwarf_getsrcfiles (&unit->cudie, &files, &nfiles);
+	}
+    }
 
-	    /* We are interested in five attributes: name, decl_file,
-	       decl_line, low_pc, and high_pc.  */
-	    Dwarf_Attribute attr_mem;
-	    Dwarf_Attribute *attr = dwarf_attr (die, DW_AT_name, &attr_mem);
-	    const char *name = dwarf_formstring (attr);
-	    if (name == NULL)
-	      continue;
+  size_t nthreads = nunit_threads;
+  if (nthreads > args.nunits)
+    nthreads = args.nunits;
 
-	    Dwarf_Word fileidx;
-	    attr = dwarf_attr (die, DW_AT_decl_file, &attr_mem);
-	    if (dwarf_formudata (attr, &fileidx) != 0 || fileidx >= nfiles)
-	      continue;
+  pthread_mutex_init (&args.lock, NULL);
+  pthread_t *threads = NULL;
+  size_t nstarted = 0;
+  if (nthreads > 1)
+    {
+      /* The names might come from the alternate debug file, which is
+	 opened lazily.  Do that before there are other threads.  */
+      (void) dwarf_getalt (dbg);
+      threads = xmalloc ((nthreads - 1) * sizeof threads[0]);
+      for (size_t i = 0; i + 1 < nthreads; ++i)
+	if (pthread_create (&threads[nstarted], NULL, get_local_units,
+			    &args) == 0)
+	  ++nstarted;
+    }
+  get_local_units (&args);
+  for (size_t i = 0; i < nstarted; ++i)
+    pthread_join (threads[i], NULL);
+  free (threads);
+  pthread_mutex_destroy (&args.lock);
+
+  /* Put the names of all units together.  */
+  size_t nnames = 0;
+  for (size_t u = 0; u < args.nunits; ++u)
+    nnames += args.units[u].locals.nnames;
+  locals->names = xmalloc ((nnames ?: 1) * sizeof locals->names[0]);
+  locals->nnames = 0;
+  for (size_t u = 0; u < args.nunits; ++u)
+    {
+      struct local_names *ulocals = &args.units[u].locals;
+      for (size_t i = 0; i < ulocals->nnames; ++i)
+	{
+	  locals->names[locals->nnames] = ulocals->names[i];
+	  locals->names[locals->nnames].order = locals->nnames;
+	  ++locals->nnames;
+	}
+      free (ulocals->names);
+    }
+  free (args.units);
 
-	    Dwarf_Word lineno;
-	    attr = dwarf_attr (die, DW_AT_decl_line, &attr_mem);
-	    if (dwarf_formudata (attr, &lineno) != 0 || lineno == 0)
-	      continue;
+  qsort (locals->names, locals->nnames, sizeof locals->names[0],
+	 local_compare);
 
-	    Dwarf_Addr lowpc;
-	    Dwarf_Addr highpc;
-	    if (tag == DW_TAG_subprogram)
-	      {
-		if (dwarf_lowpc (die, &lowpc) != 0
-		    || dwarf_highpc (die, &highpc) != 0)
-		  continue;
-	      }
-	    else
-	      {
-		if (get_var_range (die, &lowpc, &highpc) != 0)
-		  continue;
-	      }
-
-	    /* We have all the information.  Create a record.  */
-	    struct local_name *newp
-	      = (struct local_name *) xmalloc (sizeof (*newp));
-	    newp->name = name;
-	    newp->file = dwarf_filesrc (files, fileidx, NULL, NULL);
-	    newp->lineno = lineno;
-	    newp->lowpc = lowpc;
-	    newp->highpc = highpc;
-
-	   /* Check whether a similar local_name is already in the
-	      cache.  That should not happen.  But if it does, we
-	      don't want to leak memory.  */
-	    struct local_name **tres = tsearch (newp, &local_root,
-						local_compare);
-	    if (tres == NULL)
-              error (EXIT_FAILURE, errno,
-                     gettext ("cannot create search tree"));
-	    else if (*tres != newp)
-	      free (newp);
-	  }
-	while (dwarf_siblingof (die, die) == 0);
+  /* Merge names whose address range is within the one of a name
+     before them.  Like the search tree used before, the name found
+     first is kept, with the enclosing address range.  */
+  size_t n = 0;
+  for (size_t i = 0; i < locals->nnames; ++i)
+    {
+      struct local_name *last = n > 0 ? &locals->names[n - 1] : NULL;
+      struct local_name *name = &locals->names[i];
+      if (last != NULL && strcmp (last->name, name->name) == 0
+	  && last->highpc >= name->highpc)
+	{
+	  if (name->order < last->order)
+	    {
+	      last->file = name->file;
+	      last->lineno = name->lineno;
+	      last->order = name->order;
+	    }
+	  continue;
+	}
+      locals->names[n++] = *name;
+    }
+  locals->nnames = n;
+}
+
+
+/* Find the local name NAME whose address range contains ADDR.  */
+static struct local_name *
+find_local (struct local_names *locals, const char *name, Dwarf_Addr addr)
+{
+  size_t lo = 0;
+  size_t hi = locals->nnames;
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      if (strcmp (locals->names[mid].name, name) < 0)
+	lo = mid + 1;
+      else
+	hi = mid;
     }
+
+  for (; lo < locals->nnames && locals->names[lo].lowpc <= addr; ++lo)
+    {
+      if (strcmp (locals->names[lo].name, name) != 0)
+	break;
+      if (locals->names[lo].highpc >= addr)
+	return &locals->names[lo];
+    }
+
+  return NULL;
 }
 
 /* Do elf_strptr, but return a backup string and never NULL.  */
@@ -727,7 +1278,7 @@ sym_name (Elf *elf, GElf_Word strndx, GElf_Word st_name, char buf[], size_t n)
 static void
 show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 		   GElf_SymX *syms, size_t nsyms, int longest_name,
-		   int longest_where)
+		   int longest_where, FILE *out)
 {
   size_t shnum;
   if (elf_getshdrnum (ebl->elf, &shnum) < 0)
@@ -768,23 +1319,18 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
   int digits = length_map[gelf_getclass (ebl->elf) - 1][radix];
 
   /* We always print this prolog.  */
-  printf (gettext ("\n\nSymbols from %s:\n\n"), fullname);
+  fprintf (out, gettext ("\n\nSymbols from %s:\n\n"), fullname);
 
   /* The header line.  */
-  printf (gettext ("%*s%-*s %-*s Class  Type     %-*s %*s Section\n\n"),
-	  print_file_name ? (int) strlen (fullname) + 1: 0, "",
-	  longest_name, sgettext ("sysv|Name"),
-	  /* TRANS: the "sysv|" parts makes the string unique.  */
-	  digits, sgettext ("sysv|Value"),
-	  /* TRANS: the "sysv|" parts makes the string unique.  */
-	  digits, sgettext ("sysv|Size"),
-	  /* TRANS: the "sysv|" parts makes the string unique.  */
-	  longest_where, sgettext ("sysv|Line"));
-
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
+  fprintf (out, gettext ("%*s%-*s %-*s Class  Type     %-*s %*s Section\n\n"),
+	   print_file_name ? (int) strlen (fullname) + 1: 0, "",
+	   longest_name, sgettext ("sysv|Name"),
+	   /* TRANS: the "sysv|" parts makes the string unique.  */
+	   digits, sgettext ("sysv|Value"),
+	   /* TRANS: the "sysv|" parts makes the string unique.  */
+	   digits, sgettext ("sysv|Size"),
+	   /* TRANS: the "sysv|" parts makes the string unique.  */
+	   longest_where, sgettext ("sysv|Line"));
 
   /* Iterate over all symbols.  */
   for (cnt = 1; cnt < nsyms; ++cnt)
@@ -798,16 +1344,9 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 				     symstrbuf, sizeof symstrbuf);
 
 #ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
+      /* Demangle if necessary.  */
+      if (demangle)
+	symstr = demangle_cached (symstr);
 #endif
 
       char symbindbuf[50];
@@ -819,8 +1358,8 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
-	  fputs_unlocked (fullname, stdout);
-	  putchar_unlocked (':');
+	  fputs_unlocked (fullname, out);
+	  putc_unlocked (':', out);
 	}
 
       /* Covert the address.  */
@@ -841,23 +1380,19 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 	}
 
       /* Print the actual string.  */
-      printf ("%-*s|%s|%-6s|%-8s|%s|%*s|%s\n",
-	      longest_name, symstr, addressbuf,
-	      ebl_symbol_binding_name (ebl,
-				       GELF_ST_BIND (syms[cnt].sym.st_info),
-				       symbindbuf, sizeof (symbindbuf)),
-	      ebl_symbol_type_name (ebl, GELF_ST_TYPE (syms[cnt].sym.st_info),
-				    symtypebuf, sizeof (symtypebuf)),
-	      sizebuf, longest_where, syms[cnt].where,
-	      ebl_section_name (ebl, syms[cnt].sym.st_shndx, syms[cnt].xndx,
-				secnamebuf, sizeof (secnamebuf), scnnames,
-				shnum));
+      fprintf (out, "%-*s|%s|%-6s|%-8s|%s|%*s|%s\n",
+	       longest_name, symstr, addressbuf,
+	       ebl_symbol_binding_name (ebl,
+					GELF_ST_BIND (syms[cnt].sym.st_info),
+					symbindbuf, sizeof (symbindbuf)),
+	       ebl_symbol_type_name (ebl, GELF_ST_TYPE (syms[cnt].sym.st_info),
+				     symtypebuf, sizeof (symtypebuf)),
+	       sizebuf, longest_where, syms[cnt].where,
+	       ebl_section_name (ebl, syms[cnt].sym.st_shndx, syms[cnt].xndx,
+				 secnamebuf, sizeof (secnamebuf), scnnames,
+				 shnum));
     }
 
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
-
   if (scnnames_malloced)
     free (scnnames);
 }
@@ -906,17 +1441,12 @@ class_type_char (Elf *elf, const GElf_Ehdr *ehdr, GElf_Sym *sym)
 static void
 show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 		  const char *prefix, const char *fname, const char *fullname,
-		  GElf_SymX *syms, size_t nsyms)
+		  GElf_SymX *syms, size_t nsyms, FILE *out)
 {
   int digits = length_map[gelf_getclass (elf) - 1][radix];
 
   if (prefix != NULL && ! print_file_name)
-    printf ("\n%s:\n", fname);
-
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
+    fprintf (out, "\n%s:\n", fname);
 
   /* Iterate over all symbols.  */
   for (size_t cnt = 0; cnt < nsyms; ++cnt)
@@ -936,23 +1466,16 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 	continue;
 
 #ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
+      /* Demangle if necessary.  */
+      if (demangle)
+	symstr = demangle_cached (symstr);
 #endif
 
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
-	  fputs_unlocked (fullname, stdout);
-	  putchar_unlocked (':');
+	  fputs_unlocked (fullname, out);
+	  putc_unlocked (':', out);
 	}
 
       bool is_tls = GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_TLS;
@@ -973,7 +1496,7 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 		color = color_undef;
 	    }
 
-	  printf ("%*s %sU%s %s", digits, "", color, marker, symstr);
+	  fprintf (out, "%*s %sU%s %s", digits, "", color, marker, symstr);
 	}
       else
 	{
@@ -992,15 +1515,15 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 #define HEXFMT "%6$s%2$0*1$" PRIx64 "%8$s %10$0*9$" PRIx64 " %7$s%3$c%4$s %5$s"
 #define DECFMT "%6$s%2$*1$" PRId64 "%8$s %10$*9$" PRId64 " %7$s%3$c%4$s %5$s"
 #define OCTFMT "%6$s%2$0*1$" PRIo64 "%8$s %10$0*9$" PRIo64 " %7$s%3$c%4$s %5$s"
-	      printf ((radix == radix_hex ? HEXFMT
-		       : (radix == radix_decimal ? DECFMT : OCTFMT)),
-		      digits, syms[cnt].sym.st_value,
-		      class_type_char (elf, ehdr, &syms[cnt].sym), marker,
-		      symstr,
-		      color_mode ? color_address : "",
-		      color,
-		      color_mode ? color_off : "",
-		      digits, (uint64_t) syms[cnt].sym.st_size);
+	      fprintf (out, (radix == radix_hex ? HEXFMT
+			     : (radix == radix_decimal ? DECFMT : OCTFMT)),
+		       digits, syms[cnt].sym.st_value,
+		       class_type_char (elf, ehdr, &syms[cnt].sym), marker,
+		       symstr,
+		       color_mode ? color_address : "",
+		       color,
+		       color_mode ? color_off : "",
+		       digits, (uint64_t) syms[cnt].sym.st_size);
 #undef HEXFMT
 #undef DECFMT
 #undef OCTFMT
@@ -1010,14 +1533,14 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 #define HEXFMT "%6$s%2$0*1$" PRIx64 "%8$s %7$s%3$c%4$s %5$s"
 #define DECFMT "%6$s%2$*1$" PRId64 "%8$s %7$s%3$c%4$s %5$s"
 #define OCTFMT "%6$s%2$0*1$" PRIo64 "%8$s %7$s%3$c%4$s %5$s"
-	      printf ((radix == radix_hex ? HEXFMT
-		       : (radix == radix_decimal ? DECFMT : OCTFMT)),
-		      digits, syms[cnt].sym.st_value,
-		      class_type_char (elf, ehdr, &syms[cnt].sym), marker,
-		      symstr,
-		      color_mode ? color_address : "",
-		      color,
-		      color_mode ? color_off : "");
+	      fprintf (out, (radix == radix_hex ? HEXFMT
+			     : (radix == radix_decimal ? DECFMT : OCTFMT)),
+		       digits, syms[cnt].sym.st_value,
+		       class_type_char (elf, ehdr, &syms[cnt].sym), marker,
+		       symstr,
+		       color_mode ? color_address : "",
+		       color,
+		       color_mode ? color_off : "");
 #undef HEXFMT
 #undef DECFMT
 #undef OCTFMT
@@ -1025,31 +1548,22 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 	}
 
       if (color_mode)
-	fputs_unlocked (color_off, stdout);
-      putchar_unlocked ('\n');
+	fputs_unlocked (color_off, out);
+      putc_unlocked ('\n', out);
     }
-
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
 }
 
 
 static void
 show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 		    const char *prefix, const char *fullname, GElf_SymX *syms,
-		    size_t nsyms)
+		    size_t nsyms, FILE *out)
 {
   if (prefix != NULL && ! print_file_name)
-    printf ("%s:\n", fullname);
+    fprintf (out, "%s:\n", fullname);
 
   int digits = length_map[gelf_getclass (elf) - 1][radix];
 
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-
   /* Iterate over all symbols.  */
   for (size_t cnt = 0; cnt < nsyms; ++cnt)
     {
@@ -1064,46 +1578,35 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 	continue;
 
 #ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
+      /* Demangle if necessary.  */
+      if (demangle)
+	symstr = demangle_cached (symstr);
 #endif
 
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
-	  fputs_unlocked (fullname, stdout);
-	  putchar_unlocked (':');
-	  putchar_unlocked (' ');
+	  fputs_unlocked (fullname, out);
+	  putc_unlocked (':', out);
+	  putc_unlocked (' ', out);
 	}
 
-      printf ((radix == radix_hex
-	       ? "%s %c%s %0*" PRIx64 " %0*" PRIx64 "\n"
-	       : (radix == radix_decimal
-		  ? "%s %c%s %*" PRId64 " %*" PRId64 "\n"
-		  : "%s %c%s %0*" PRIo64 " %0*" PRIo64 "\n")),
-	      symstr,
-	      class_type_char (elf, ehdr, &syms[cnt].sym),
-	      mark_special
-	      ? (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_TLS
-		 ? "@"
-		 : (GELF_ST_BIND (syms[cnt].sym.st_info) == STB_WEAK
-		    ? "*" : " "))
-	      : "",
-	      digits, syms[cnt].sym.st_value,
-	      digits, syms[cnt].sym.st_size);
+      fprintf (out, (radix == radix_hex
+		     ? "%s %c%s %0*" PRIx64 " %0*" PRIx64 "\n"
+		     : (radix == radix_decimal
+			? "%s %c%s %*" PRId64 " %*" PRId64 "\n"
+			: "%s %c%s %0*" PRIo64 " %0*" PRIo64 "\n")),
+	       symstr,
+	       class_type_char (elf, ehdr, &syms[cnt].sym),
+	       mark_special
+	       ? (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_TLS
+		  ? "@"
+		  : (GELF_ST_BIND (syms[cnt].sym.st_info) == STB_WEAK
+		     ? "*" : " "))
+	       : "",
+	       digits, syms[cnt].sym.st_value,
+	       digits, syms[cnt].sym.st_size);
     }
-
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
 }
 
 
@@ -1122,16 +1625,16 @@ sort_by_address (const void *p1, const void *p2)
   return reverse_sort ? -result : result;
 }
 
-static Elf_Data *sort_by_name_strtab;
-
+/* ARG is the Elf_Data of the symbol string table.  */
 static int
-sort_by_name (const void *p1, const void *p2)
+sort_by_name (const void *p1, const void *p2, void *arg)
 {
   GElf_SymX *s1 = (GElf_SymX *) p1;
   GElf_SymX *s2 = (GElf_SymX *) p2;
+  Elf_Data *strtab = arg;
 
-  const char *n1 = sort_by_name_strtab->d_buf + s1->sym.st_name;
-  const char *n2 = sort_by_name_strtab->d_buf + s2->sym.st_name;
+  const char *n1 = strtab->d_buf + s1->sym.st_name;
+  const char *n2 = strtab->d_buf + s2->sym.st_name;
 
   int result = strcmp (n1, n2);
 
@@ -1196,7 +1699,7 @@ static void
 show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 	      Elf_Scn *scn, Elf_Scn *xndxscn,
 	      GElf_Shdr *shdr, const char *prefix, const char *fname,
-	      const char *fullname)
+	      const char *fullname, FILE *out)
 {
   /* Get the section header string table index.  */
   size_t shstrndx;
@@ -1235,6 +1738,8 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
      possible.  We just won't print any line number information.  */
   Dwarf *dbg = NULL;
   Dwfl *dwfl = NULL;
+  struct global_names globals = { NULL, 0, 0 };
+  struct local_names locals = { NULL, 0, 0 };
   if (format == format_sysv)
     {
       if (ehdr->e_type != ET_REL)
@@ -1278,9 +1783,9 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 	}
       if (dbg != NULL)
 	{
-	  (void) dwarf_getpubnames (dbg, get_global, NULL, 0);
+	  get_global_names (dbg, &globals);
 
-	  get_local_names (dbg);
+	  get_local_names (dbg, &locals);
 	}
     }
 
@@ -1307,10 +1812,6 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
     sym_mem = (GElf_SymX *) xmalloc (nentries * sizeof (GElf_SymX));
 
   /* Iterate over all symbols.  */
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
   int longest_name = 4;
   int longest_where = 4;
   size_t nentries_used = 0;
@@ -1338,31 +1839,22 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 	    continue;
 
 #ifdef USE_DEMANGLE
-	  /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-	  if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	    {
-	      int status = -1;
-	      char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					       &demangle_buffer_len, &status);
-
-	      if (status == 0)
-		symstr = dmsymstr;
-	    }
+	  /* Demangle if necessary.  */
+	  if (demangle)
+	    symstr = demangle_cached (symstr);
 #endif
 
 	  longest_name = MAX ((size_t) longest_name, strlen (symstr));
 
 	  if (sym->st_shndx != SHN_UNDEF
 	      && GELF_ST_BIND (sym->st_info) != STB_LOCAL
-	      && global_root != NULL)
+	      && globals.nnames > 0)
 	    {
-	      Dwarf_Global fake = { .name = symstr };
-	      Dwarf_Global **found = tfind (&fake, &global_root,
-					    global_compare);
+	      Dwarf_Global *found = find_global (&globals, symstr);
 	      if (found != NULL)
 		{
 		  Dwarf_Die die_mem;
-		  Dwarf_Die *die = dwarf_offdie (dbg, (*found)->die_offset,
+		  Dwarf_Die *die = dwarf_offdie (dbg, found->die_offset,
 						 &die_mem);
 
 		  Dwarf_Die cudie_mem;
@@ -1375,7 +1867,7 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 		      && lowpc <= sym->st_value
 		      && dwarf_highpc (die, &highpc) == 0
 		      && highpc > sym->st_value)
-		    cudie = dwarf_offdie (dbg, (*found)->cu_offset,
+		    cudie = dwarf_offdie (dbg, found->cu_offset,
 					  &cudie_mem);
 		  if (cudie != NULL)
 		    {
@@ -1406,20 +1898,14 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 	  /* Try to find the symbol among the local symbols.  */
 	  if (sym_mem[nentries_used].where[0] == '\0')
 	    {
-	      struct local_name fake =
-		{
-		  .name = symstr,
-		  .lowpc = sym->st_value,
-		  .highpc = sym->st_value,
-		};
-	      struct local_name **found = tfind (&fake, &local_root,
-						 local_compare);
+	      struct local_name *found = find_local (&locals, symstr,
+						     sym->st_value);
 	      if (found != NULL)
 		{
 		  /* We found the line.  */
 		  int n = obstack_printf (&whereob, "%s:%" PRIu64 "%c",
-					  basename ((*found)->file),
-					  (*found)->lineno,
+					  basename (found->file),
+					  found->lineno,
 					  '\0');
 		  sym_mem[nentries_used].where = obstack_finish (&whereob);
 
@@ -1434,9 +1920,7 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
       /* We use this entry.  */
       ++nentries_used;
     }
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
+
   /* Now we know the exact number.  */
   size_t nentries_orig = nentries;
   nentries = nentries_used;
@@ -1444,9 +1928,9 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
   /* Sort the entries according to the users wishes.  */
   if (sort == sort_name)
     {
-      sort_by_name_strtab = elf_getdata (elf_getscn (ebl->elf, shdr->sh_link),
-					 NULL);
-      qsort (sym_mem, nentries, sizeof (GElf_SymX), sort_by_name);
+      Elf_Data *strtab = elf_getdata (elf_getscn (ebl->elf, shdr->sh_link),
+				      NULL);
+      qsort_r (sym_mem, nentries, sizeof (GElf_SymX), sort_by_name, strtab);
     }
   else if (sort == sort_numeric)
     qsort (sym_mem, nentries, sizeof (GElf_SymX), sort_by_address);
@@ -1456,19 +1940,19 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
     {
     case format_sysv:
       show_symbols_sysv (ebl, shdr->sh_link, fullname, sym_mem, nentries,
-			 longest_name, longest_where);
+			 longest_name, longest_where, out);
       break;
 
     case format_bsd:
       show_symbols_bsd (ebl->elf, ehdr, shdr->sh_link, prefix, fname, fullname,
-			sym_mem, nentries);
+			sym_mem, nentries, out);
       break;
 
     case format_posix:
     default:
       assert (format == format_posix);
       show_symbols_posix (ebl->elf, ehdr, shdr->sh_link, prefix, fullname,
-			  sym_mem, nentries);
+			  sym_mem, nentries, out);
       break;
     }
 
@@ -1480,11 +1964,8 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 
   if (dbg != NULL)
     {
-      tdestroy (global_root, free);
-      global_root = NULL;
-
-      tdestroy (local_root, free);
-      local_root = NULL;
+      free (globals.names);
+      free (locals.names);
 
       if (dwfl == NULL)
 	(void) dwarf_end (dbg);
@@ -1496,7 +1977,7 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 
 static int
 handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
-	    const char *suffix)
+	    const char *suffix, FILE *out)
 {
   size_t prefix_len = prefix == NULL ? 0 : strlen (prefix);
   size_t suffix_len = suffix == NULL ? 0 : strlen (suffix);
@@ -1575,7 +2056,7 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 	    }
 
 	  show_symbols (fd, ebl, ehdr, scn, xndxscn, shdr, prefix, fname,
-			fullname);
+			fullname, out);
 	}
     }
 
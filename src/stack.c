@@ -30,6 +30,7 @@
 #include <dwarf.h>
 #include <system.h>
 #include <printversion.h>
+#include <demangle.h>
 
 /* Name and version of program.  */
 ARGP_PROGRAM_VERSION_HOOK_DEF = print_version;
@@ -88,11 +89,6 @@ static const Dwfl_Callbacks core_callbacks =
     .debuginfo_path = &debuginfo_path,
   };
 
-#ifdef USE_DEMANGLE
-static size_t demangle_buffer_len = 0;
-static char *demangle_buffer = NULL;
-#endif
-
 /* Whether any frames have been shown at all.  Determines exit status.  */
 static bool frames_shown = false;
 
@@ -226,15 +222,8 @@ print_frame (int nr, Dwarf_Addr pc, bool isactivation,
   if (symname != NULL)
     {
 #ifdef USE_DEMANGLE
-      // Require GNU v3 ABI by the "_Z" prefix.
-      if (! show_raw && symname[0] == '_' && symname[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dsymname = __cxa_demangle (symname, demangle_buffer,
-					   &demangle_buffer_len, &status);
-	  if (status == 0)
-	    symname = demangle_buffer = dsymname;
-	}
+      if (! show_raw)
+	symname = demangle_cached (symname);
 #endif
       printf (" %s", symname);
     }
@@ -673,10 +662,17 @@ main (int argc, char **argv)
       { NULL, 0, NULL, 0, NULL, 0 }
     };
 
+  const struct argp_child argp_children[] =
+    {
+      { &demangle_argp, 0, NULL, 0 },
+      { NULL, 0, NULL, 0 }
+    };
+
   const struct argp argp =
     {
       .options = options,
       .parser = parse_opt,
+      .children = argp_children,
       .doc = N_("Print a stack for each thread in a process or core file.\n\
 \n\
 Program exits with return code 0 if all frames were shown without \
@@ -747,9 +743,7 @@ invoked with bad or missing arguments it will exit with return code 64.")
   if (core_fd != -1)
     close (core_fd);
 
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
+  demangle_cache_end ();
 
   if (! frames_shown)
     error (EXIT_BAD, 0, N_("Couldn't show any frames."));
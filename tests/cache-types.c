@@ -0,0 +1,186 @@
+/* Test the dwarf_peel_type and dwarf_aggregate_size type cache.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include ELFUTILS_HEADER(dw)
+#include <dwarf.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* The result of dwarf_peel_type and dwarf_aggregate_size for one DIE
+   with a DW_AT_type.  */
+struct type_result
+{
+  int peel_res;
+  Dwarf_Off peel_off;
+  int size_res;
+  Dwarf_Word size;
+};
+
+static struct type_result *results;
+static size_t nresults;
+static size_t nalloc;
+
+/* Counts for the summary line of a file.  */
+static size_t ntypes;
+static size_t npeeled;
+static size_t nsized;
+static size_t nmismatch;
+
+static void
+get_result (Dwarf_Die *type, struct type_result *r)
+{
+  Dwarf_Die peeled;
+  r->peel_res = dwarf_peel_type (type, &peeled);
+  r->peel_off = r->peel_res == 0 ? dwarf_dieoffset (&peeled) : 0;
+  r->size = 0;
+  r->size_res = dwarf_aggregate_size (type, &r->size);
+}
+
+/* Record (CHECK false) or compare (CHECK true) the results for the
+   types of all DIEs below and including DIE.  */
+static void
+walk (Dwarf_Die *die, bool check, size_t *n)
+{
+  do
+    {
+      Dwarf_Attribute attr_mem;
+      Dwarf_Die type_mem;
+      Dwarf_Die *type = dwarf_formref_die (dwarf_attr (die, DW_AT_type,
+						       &attr_mem),
+					   &type_mem);
+      if (type != NULL)
+	{
+	  struct type_result r;
+	  get_result (type, &r);
+	  if (! check)
+	    {
+	      if (nresults == nalloc)
+		{
+		  nalloc = nalloc == 0 ? 256 : 2 * nalloc;
+		  results = realloc (results, nalloc * sizeof *results);
+		  assert (results != NULL);
+		}
+	      results[nresults++] = r;
+	      ++ntypes;
+	      if (r.peel_res == 0)
+		++npeeled;
+	      if (r.size_res == 0)
+		++nsized;
+	    }
+	  else
+	    {
+	      assert (*n < nresults);
+	      struct type_result *e = &results[(*n)++];
+	      if (r.peel_res != e->peel_res || r.peel_off != e->peel_off)
+		{
+		  printf ("[%" PRIx64 "] cached peel_type differs\n",
+			  dwarf_dieoffset (die));
+		  ++nmismatch;
+		}
+	      if (r.size_res != e->size_res || r.size != e->size)
+		{
+		  printf ("[%" PRIx64 "] cached aggregate_size differs\n",
+			  dwarf_dieoffset (die));
+		  ++nmismatch;
+		}
+
+	      /* Peeling the type DIE in place has to give the same.  */
+	      if (e->peel_res == 0
+		  && (dwarf_peel_type (type, type) != 0
+		      || dwarf_dieoffset (type) != e->peel_off))
+		{
+		  printf ("[%" PRIx64 "] cached peel_type in place differs\n",
+			  dwarf_dieoffset (die));
+		  ++nmismatch;
+		}
+	    }
+	}
+
+      Dwarf_Die child;
+      if (dwarf_child (die, &child) == 0)
+	walk (&child, check, n);
+    }
+  while (dwarf_siblingof (die, die) == 0);
+}
+
+static void
+walk_units (Dwarf *dbg, bool check)
+{
+  size_t n = 0;
+  Dwarf_CU *cu = NULL;
+  Dwarf_Die cudie;
+  while (dwarf_get_units (dbg, cu, &cu, NULL, NULL, &cudie, NULL) == 0)
+    {
+      Dwarf_Die child;
+      if (dwarf_child (&cudie, &child) == 0)
+	walk (&child, check, &n);
+    }
+  if (check)
+    assert (n == nresults);
+}
+
+/* Collect the type results of every DIE with a DW_AT_type without
+   the type cache.  Then enable the cache and check the results twice,
+   once filling the cache and once using it.  */
+int
+main (int argc, char *argv[])
+{
+  int result = 0;
+  for (int i = 1; i < argc; i++)
+    {
+      int fd = open (argv[i], O_RDONLY);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      if (dbg == NULL)
+	{
+	  printf ("%s not usable: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      nresults = ntypes = npeeled = nsized = nmismatch = 0;
+      walk_units (dbg, false);
+
+      if (dwarf_cache_types (dbg) != 0)
+	{
+	  printf ("%s cannot cache types: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+      walk_units (dbg, true);
+      walk_units (dbg, true);
+
+      printf ("%s: %zd types, %zd peeled, %zd sized, %zd differ\n",
+	      argv[i], ntypes, npeeled, nsized, nmismatch);
+      if (nmismatch != 0)
+	result = 1;
+
+      dwarf_end (dbg);
+      close (fd);
+    }
+
+  free (results);
+  return result;
+}
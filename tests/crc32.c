@@ -0,0 +1,134 @@
+/* Test program for crc32 and crc32_file.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../lib/libeu.h"
+
+/* Usage: crc32 [FILE...]
+   Checks crc32 against a byte at a time reference implementation, then
+   prints the crc32_file checksum of each FILE.
+   Usage: crc32 -b MB
+   Prints the crc32 throughput over a buffer of MB megabytes.  */
+
+static uint32_t
+crc32_ref (uint32_t crc, const unsigned char *buf, size_t len)
+{
+  crc = ~crc;
+  while (len-- > 0)
+    {
+      crc ^= *buf++;
+      for (int i = 0; i < 8; ++i)
+	crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+  return ~crc;
+}
+
+static int
+check_crc32 (void)
+{
+  int errors = 0;
+
+  unsigned char check[] = "123456789";
+  if (crc32 (0, check, 9) != 0xcbf43926)
+    {
+      printf ("crc32 check value %08" PRIx32 "\n", crc32 (0, check, 9));
+      ++errors;
+    }
+
+  /* All alignments and the lengths around the eight byte steps.  */
+  unsigned char buf[1024];
+  srandom (42);
+  for (size_t i = 0; i < sizeof buf; ++i)
+    buf[i] = random ();
+  for (size_t start = 0; start < 16; ++start)
+    for (size_t len = 0; start + len <= sizeof buf; len += len < 64 ? 1 : 61)
+      {
+	uint32_t want = crc32_ref (0, buf + start, len);
+	uint32_t got = crc32 (0, buf + start, len);
+	/* Continuing a CRC must give the same result.  */
+	uint32_t split = crc32 (crc32 (0, buf + start, len / 3),
+				buf + start + len / 3, len - len / 3);
+	if (got != want || split != want)
+	  {
+	    printf ("crc32 start %zd len %zd: %08" PRIx32 " %08" PRIx32
+		    " want %08" PRIx32 "\n", start, len, got, split, want);
+	    ++errors;
+	  }
+      }
+
+  return errors;
+}
+
+static int
+bench (size_t mb)
+{
+  size_t size = mb * 1024 * 1024;
+  unsigned char *buf = malloc (size);
+  if (buf == NULL)
+    {
+      perror ("malloc");
+      return 1;
+    }
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = i * 7;
+
+  struct timespec start, end;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  uint32_t crc = crc32 (0, buf, size);
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  double secs = ((end.tv_sec - start.tv_sec)
+		 + (end.tv_nsec - start.tv_nsec) / 1e9);
+  printf ("%08" PRIx32 ": %zd MB in %.3f s, %.1f MB/s\n",
+	  crc, mb, secs, secs > 0 ? mb / secs : 0);
+  free (buf);
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  if (argc == 3 && strcmp (argv[1], "-b") == 0)
+    return bench (atoi (argv[2]));
+
+  int errors = check_crc32 ();
+
+  for (int i = 1; i < argc; ++i)
+    {
+      int fd = open (argv[i], O_RDONLY);
+      uint32_t crc;
+      if (fd < 0 || crc32_file (fd, &crc) != 0)
+	{
+	  printf ("%s: %s\n", argv[i], strerror (errno));
+	  ++errors;
+	}
+      else
+	printf ("%08" PRIx32 "  %s\n", crc, argv[i]);
+      if (fd >= 0)
+	close (fd);
+    }
+
+  return errors != 0;
+}
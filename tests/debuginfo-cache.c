@@ -0,0 +1,131 @@
+/* Test program for dwfl_set_debuginfo_cache.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static char *debuginfo_path;
+
+static const Dwfl_Callbacks offline_callbacks =
+  {
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+    .debuginfo_path = &debuginfo_path,
+  };
+
+/* Report FILE as a new module NAME and tell whether its debuginfo
+   was found.  */
+static void
+report (Dwfl *dwfl, const char *name, const char *file)
+{
+  dwfl_report_begin_add (dwfl);
+  Dwfl_Module *mod = dwfl_report_offline (dwfl, name, file, -1);
+  if (mod == NULL)
+    {
+      printf ("%s: %s\n", file, dwfl_errmsg (-1));
+      exit (1);
+    }
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  Dwarf_Addr bias;
+  printf ("%s: dwarf %s\n", name,
+	  dwfl_module_getdwarf (mod, &bias) != NULL ? "yes" : "no");
+}
+
+int
+main (int argc, char **argv)
+{
+  if (argc != 5)
+    {
+      fprintf (stderr,
+	       "usage: debuginfo-cache DEBUGDIR FILE DEBUGFILE NEWNAME\n");
+      return 1;
+    }
+
+  /* The debug file is only installed in DEBUGDIR after it has been
+     searched once.  Without the cache it is found right away.  */
+  debuginfo_path = argv[1];
+  Dwfl *dwfl = dwfl_begin (&offline_callbacks);
+  assert (dwfl != NULL);
+  report (dwfl, "uncached", argv[2]);
+
+  if (rename (argv[3], argv[4]) != 0)
+    {
+      perror ("rename");
+      return 1;
+    }
+  report (dwfl, "installed", argv[2]);
+
+  if (rename (argv[4], argv[3]) != 0)
+    {
+      perror ("rename");
+      return 1;
+    }
+  if (dwfl_set_debuginfo_cache (dwfl, true) != 0)
+    {
+      printf ("dwfl_set_debuginfo_cache: %s\n", dwfl_errmsg (-1));
+      return 1;
+    }
+  report (dwfl, "before", argv[2]);
+
+  if (rename (argv[3], argv[4]) != 0)
+    {
+      perror ("rename");
+      return 1;
+    }
+  report (dwfl, "cached", argv[2]);
+
+  dwfl_flush_debuginfo_cache (dwfl);
+  report (dwfl, "flushed", argv[2]);
+
+  if (rename (argv[4], argv[3]) != 0)
+    {
+      perror ("rename");
+      return 1;
+    }
+  dwfl_flush_debuginfo_cache (dwfl);
+  report (dwfl, "removed", argv[2]);
+
+  /* A new round of reporting looks again too.  */
+  if (rename (argv[3], argv[4]) != 0)
+    {
+      perror ("rename");
+      return 1;
+    }
+  dwfl_report_begin (dwfl);
+  dwfl_report_end (dwfl, NULL, NULL);
+  report (dwfl, "rereported", argv[2]);
+
+  /* Turning the cache off forgets the listings too.  */
+  if (rename (argv[4], argv[3]) != 0)
+    {
+      perror ("rename");
+      return 1;
+    }
+  dwfl_set_debuginfo_cache (dwfl, false);
+  report (dwfl, "off", argv[2]);
+
+  dwfl_end (dwfl);
+  return 0;
+}
@@ -0,0 +1,226 @@
+/* Test the DIE index functions against a tree walk.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* The chain of DIEs from the unit DIE to the current one.  */
+struct chain
+{
+  Dwarf_Die *die;
+  struct chain *parent;
+};
+
+/* Whether dwarf_getscopes_die descends into a DIE with TAG.  */
+static bool
+may_have_scopes (int tag)
+{
+  switch (tag)
+    {
+    case DW_TAG_compile_unit:
+    case DW_TAG_module:
+    case DW_TAG_lexical_block:
+    case DW_TAG_with_stmt:
+    case DW_TAG_catch_block:
+    case DW_TAG_try_block:
+    case DW_TAG_entry_point:
+    case DW_TAG_inlined_subroutine:
+    case DW_TAG_subprogram:
+    case DW_TAG_namespace:
+    case DW_TAG_class_type:
+    case DW_TAG_structure_type:
+      return true;
+    default:
+      return false;
+    }
+}
+
+/* Check the scopes of DIE against the chain of the tree walk.  */
+static int
+check_scopes (Dwarf_Die *die, struct chain *chain)
+{
+  /* The walk from the unit DIE only finds DIEs of which all containing
+     DIEs, but the unit DIE, may have scopes.  */
+  int expected = 0;
+  if (chain->parent != NULL)
+    {
+      expected = 1;
+      for (struct chain *c = chain->parent; c != NULL; c = c->parent)
+	{
+	  if (c->parent != NULL && ! may_have_scopes (dwarf_tag (c->die)))
+	    {
+	      expected = 0;
+	      break;
+	    }
+	  expected++;
+	}
+    }
+
+  Dwarf_Die *scopes;
+  int nscopes = dwarf_getscopes_die (die, &scopes);
+  if (nscopes != expected)
+    {
+      printf ("DIE [%" PRIx64 "] bad number of scopes: %d, expected %d\n",
+	      dwarf_dieoffset (die), nscopes, expected);
+      return -1;
+    }
+
+  int res = 0;
+  struct chain *c = chain;
+  for (int i = 0; i < nscopes; ++i, c = c->parent)
+    if (dwarf_dieoffset (&scopes[i]) != dwarf_dieoffset (c->die))
+      {
+	printf ("DIE [%" PRIx64 "] bad scope %d\n", dwarf_dieoffset (die), i);
+	res = -1;
+      }
+
+  if (nscopes > 0)
+    free (scopes);
+  return res;
+}
+
+/* Check DIE, from the Dwarf that uses the DIE index, against the same
+   DIE PLAIN, from the Dwarf that never builds it.  */
+static int
+check_die (Dwarf_Die *die, Dwarf_Die *plain, struct chain *chain)
+{
+  if (dwarf_dieoffset (die) != dwarf_dieoffset (plain))
+    {
+      printf ("DIE [%" PRIx64 "] expected [%" PRIx64 "]\n",
+	      dwarf_dieoffset (die), dwarf_dieoffset (plain));
+      return -1;
+    }
+
+  Dwarf_Die result;
+  int res = dwarf_die_parent (die, &result);
+  Dwarf_Die *parent = chain->parent != NULL ? chain->parent->die : NULL;
+  if (parent == NULL)
+    {
+      if (res != 1)
+	{
+	  printf ("unit DIE [%" PRIx64 "] has a parent: %d\n",
+		  dwarf_dieoffset (die), res);
+	  return -1;
+	}
+    }
+  else if (res != 0
+	   || dwarf_dieoffset (&result) != dwarf_dieoffset (parent)
+	   || dwarf_tag (&result) != dwarf_tag (parent))
+    {
+      printf ("DIE [%" PRIx64 "] bad parent: %d %s\n",
+	      dwarf_dieoffset (die), res, dwarf_errmsg (-1));
+      return -1;
+    }
+
+  /* dwarf_siblingof uses the index now that dwarf_die_parent built it,
+     the plain Dwarf walks the children.  */
+  Dwarf_Die sib0, sib1, sib2;
+  int res0 = dwarf_siblingof (plain, &sib0);
+  int res1 = dwarf_siblingof (die, &sib1);
+  int res2 = dwarf_die_sibling (die, &sib2);
+  if (res0 != res1 || res0 != res2
+      || (res0 == 0 && (dwarf_dieoffset (&sib0) != dwarf_dieoffset (&sib1)
+			|| dwarf_dieoffset (&sib0) != dwarf_dieoffset (&sib2))))
+    {
+      printf ("DIE [%" PRIx64 "] bad sibling: %d, %d, %d\n",
+	      dwarf_dieoffset (die), res0, res1, res2);
+      return -1;
+    }
+
+  return check_scopes (die, chain);
+}
+
+static int
+walk (Dwarf_Die *die, Dwarf_Die *plain, struct chain *parent, size_t *count)
+{
+  struct chain chain = { .die = die, .parent = parent };
+  do
+    {
+      ++*count;
+      if (check_die (die, plain, &chain) != 0)
+	return -1;
+
+      Dwarf_Die child, plain_child;
+      int res = dwarf_child (die, &child);
+      if (res != dwarf_child (plain, &plain_child))
+	{
+	  printf ("DIE [%" PRIx64 "] bad child\n", dwarf_dieoffset (die));
+	  return -1;
+	}
+      if (res < 0)
+	return -1;
+      if (res == 0 && walk (&child, &plain_child, &chain, count) != 0)
+	return -1;
+    }
+  while (parent != NULL && dwarf_siblingof (die, die) == 0
+	 && dwarf_siblingof (plain, plain) == 0);
+
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++)
+    {
+      printf ("file: %s\n", argv[i]);
+      int fd = open (argv[i], O_RDONLY);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      int plain_fd = open (argv[i], O_RDONLY);
+      Dwarf *plain_dbg = dwarf_begin (plain_fd, DWARF_C_READ);
+      if (dbg == NULL || plain_dbg == NULL)
+	{
+	  printf ("%s not usable: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      size_t units = 0;
+      size_t dies = 0;
+      Dwarf_CU *cu = NULL;
+      Dwarf_CU *plain_cu = NULL;
+      Dwarf_Die cudie, plain_cudie;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, NULL, &cudie, NULL) == 0
+	     && dwarf_get_units (plain_dbg, plain_cu, &plain_cu, NULL, NULL,
+				 &plain_cudie, NULL) == 0)
+	{
+	  units++;
+	  if (walk (&cudie, &plain_cudie, NULL, &dies) != 0)
+	    return -1;
+	}
+
+      printf ("units: %zd, dies: %zd\n", units, dies);
+
+      dwarf_end (plain_dbg);
+      close (plain_fd);
+      dwarf_end (dbg);
+      close (fd);
+    }
+
+  return 0;
+}
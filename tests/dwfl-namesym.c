@@ -0,0 +1,188 @@
+/* Test program for dwfl_module_namesym.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+#include <gelf.h>
+
+
+static const Dwfl_Callbacks offline_callbacks =
+  {
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+  };
+
+static int errors;
+
+static bool
+has_symtab (Elf *elf)
+{
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+      if (shdr != NULL && shdr->sh_type == SHT_SYMTAB)
+	return true;
+    }
+  return false;
+}
+
+static int
+rank (const GElf_Sym *sym)
+{
+  int bind = GELF_ST_BIND (sym->st_info);
+  return bind == STB_GLOBAL ? 2 : bind == STB_WEAK ? 1 : 0;
+}
+
+static void
+lookup (Dwfl_Module *mod, const char *modname, const char *name)
+{
+  GElf_Sym sym;
+  GElf_Addr addr;
+  int ndx = dwfl_module_namesym (mod, name, &sym, &addr, NULL, NULL, NULL);
+  if (ndx < 0)
+    printf ("%s: %s not found%s\n", modname, name,
+	    dwfl_errno () == 0 ? "" : " (error)");
+  else
+    printf ("%s: %s [%d] 0x%" PRIx64 " %s\n", modname, name, ndx, addr,
+	    GELF_ST_BIND (sym.st_info) == STB_LOCAL ? "local"
+	    : GELF_ST_BIND (sym.st_info) == STB_WEAK ? "weak" : "global");
+}
+
+/* Whether symbol NDX can be found by its NAME.  */
+static bool
+findable (Dwfl_Module *mod, int ndx, const char **name, GElf_Sym *sym)
+{
+  *name = dwfl_module_getsym_info (mod, ndx, sym, NULL, NULL, NULL, NULL);
+  return (*name != NULL && (*name)[0] != '\0'
+	  && sym->st_shndx != SHN_UNDEF
+	  && GELF_ST_TYPE (sym->st_info) != STT_SECTION
+	  && GELF_ST_TYPE (sym->st_info) != STT_FILE);
+}
+
+/* The symbol NAME should be found as: the first one of the best
+   binding, going through the whole symbol table.  */
+static int
+expected (Dwfl_Module *mod, int nsyms, const char *name)
+{
+  int best = 0;
+  int best_rank = -1;
+  for (int i = 1; i < nsyms; ++i)
+    {
+      GElf_Sym sym;
+      const char *symname;
+      if (findable (mod, i, &symname, &sym) && strcmp (symname, name) == 0
+	  && rank (&sym) > best_rank)
+	{
+	  best = i;
+	  best_rank = rank (&sym);
+	}
+    }
+  return best;
+}
+
+/* Look up every symbol by its name and compare with what the
+   symbol table says.  */
+static int
+check_module (Dwfl_Module *mod, void **userdata __attribute__ ((unused)),
+	      const char *name, Dwarf_Addr start __attribute__ ((unused)),
+	      void *arg)
+{
+  char **names = arg;
+  int nsyms = dwfl_module_getsymtab (mod);
+  int checked = 0;
+  for (int i = 1; i < nsyms; ++i)
+    {
+      GElf_Sym sym;
+      GElf_Addr addr;
+      Elf *elf;
+      const char *symname = dwfl_module_getsym_info (mod, i, &sym, &addr,
+						     NULL, &elf, NULL);
+      if (symname == NULL || symname[0] == '\0'
+	  || sym.st_shndx == SHN_UNDEF
+	  || GELF_ST_TYPE (sym.st_info) == STT_SECTION
+	  || GELF_ST_TYPE (sym.st_info) == STT_FILE)
+	continue;
+
+      GElf_Sym found;
+      GElf_Addr found_addr;
+      int ndx = dwfl_module_namesym (mod, symname, &found, &found_addr,
+				     NULL, NULL, NULL);
+      if (ndx < 0)
+	{
+	  /* The dynamic symbol hash tables only have global symbols.  */
+	  if (rank (&sym) == 0 && ! has_symtab (elf))
+	    continue;
+	  printf ("%s: %s [%d] not found\n", name, symname, i);
+	  ++errors;
+	  continue;
+	}
+
+      GElf_Sym sym2;
+      GElf_Addr addr2;
+      const char *name2 = dwfl_module_getsym_info (mod, ndx, &sym2, &addr2,
+						   NULL, NULL, NULL);
+      if (name2 == NULL || strcmp (name2, symname) != 0
+	  || addr2 != found_addr || sym2.st_value != found.st_value
+	  || ndx != expected (mod, nsyms, symname)
+	  || (ndx == i && found_addr != addr))
+	{
+	  printf ("%s: %s [%d] found as [%d]\n", name, symname, i, ndx);
+	  ++errors;
+	}
+      ++checked;
+    }
+  printf ("%s: %d symbols, %d checked\n", name, nsyms, checked);
+
+  for (int i = 0; names[i] != NULL; ++i)
+    lookup (mod, name, names[i]);
+
+  return DWARF_CB_OK;
+}
+
+/* Usage: dwfl-namesym FILE... [-- NAME...]  */
+int
+main (int argc, char **argv)
+{
+  int nfiles = 1;
+  while (nfiles < argc && strcmp (argv[nfiles], "--") != 0)
+    ++nfiles;
+  char *nonames[] = { NULL };
+  char **names = nfiles < argc ? &argv[nfiles + 1] : nonames;
+
+  Dwfl *dwfl = dwfl_begin (&offline_callbacks);
+  assert (dwfl != NULL);
+  dwfl_report_begin (dwfl);
+  for (int i = 1; i < nfiles; ++i)
+    if (dwfl_report_offline (dwfl, argv[i], argv[i], -1) == NULL)
+      {
+	printf ("%s: %s\n", argv[i], dwfl_errmsg (-1));
+	return 1;
+      }
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  dwfl_getmodules (dwfl, check_module, names, 0);
+  dwfl_end (dwfl);
+
+  return errors != 0;
+}
@@ -0,0 +1,115 @@
+/* Test dwfl_prefetch_debuginfo.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static const Dwfl_Callbacks offline_callbacks =
+  {
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+  };
+
+static int
+print_module (Dwfl_Module *mod, void **userdata __attribute__ ((unused)),
+	      const char *name, Dwarf_Addr start __attribute__ ((unused)),
+	      void *arg)
+{
+  FILE *out = arg;
+  Dwarf_Addr bias;
+  Dwarf *dw = dwfl_module_getdwarf (mod, &bias);
+
+  size_t ncus = 0;
+  Dwarf_Die *cu = NULL;
+  while ((cu = dwfl_module_nextcu (mod, cu, &bias)) != NULL)
+    ++ncus;
+
+  fprintf (out, "%s: dwarf %s, cus %zd, symbols %d\n", name,
+	   dw != NULL ? "yes" : "no", ncus, dwfl_module_getsymtab (mod));
+  return DWARF_CB_OK;
+}
+
+/* Report all files, optionally prefetch and print all modules.  */
+static char *
+report (int nfiles, char **files, unsigned int nthreads)
+{
+  char *buf;
+  size_t size;
+  FILE *out = open_memstream (&buf, &size);
+  assert (out != NULL);
+
+  Dwfl *dwfl = dwfl_begin (&offline_callbacks);
+  assert (dwfl != NULL);
+  dwfl_report_begin (dwfl);
+  for (int i = 0; i < nfiles; ++i)
+    if (dwfl_report_offline (dwfl, files[i], files[i], -1) == NULL)
+      {
+	printf ("%s: %s\n", files[i], dwfl_errmsg (-1));
+	exit (1);
+      }
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  if (nthreads > 0 && dwfl_prefetch_debuginfo (dwfl, nthreads) != 0)
+    {
+      printf ("dwfl_prefetch_debuginfo: %s\n", dwfl_errmsg (-1));
+      exit (1);
+    }
+
+  dwfl_getmodules (dwfl, print_module, out, 0);
+  dwfl_end (dwfl);
+
+  fclose (out);
+  return buf;
+}
+
+int
+main (int argc, char **argv)
+{
+  char *plain = report (argc - 1, &argv[1], 0);
+  fputs (plain, stdout);
+
+  /* Prefetching must not change anything, with fewer or more threads
+     than there are modules.  */
+  for (unsigned int nthreads = 1; nthreads <= 8; nthreads *= 2)
+    {
+      char *prefetched = report (argc - 1, &argv[1], nthreads);
+      if (strcmp (plain, prefetched) != 0)
+	{
+	  printf ("different with %u threads:\n%s", nthreads, prefetched);
+	  return 1;
+	}
+      free (prefetched);
+    }
+
+  /* A prefetch stopped right away by dwfl_end shouldn't leak or hang.  */
+  Dwfl *dwfl = dwfl_begin (&offline_callbacks);
+  assert (dwfl != NULL);
+  for (int i = 1; i < argc; ++i)
+    dwfl_report_offline (dwfl, argv[i], argv[i], -1);
+  dwfl_report_end (dwfl, NULL, NULL);
+  assert (dwfl_prefetch_debuginfo (dwfl, 2) == 0);
+  dwfl_end (dwfl);
+
+  free (plain);
+  return 0;
+}
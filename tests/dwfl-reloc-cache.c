@@ -0,0 +1,101 @@
+/* Test program for dwfl_set_reloc_cache.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+#include <dwarf.h>
+
+
+static const Dwfl_Callbacks offline_callbacks =
+  {
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+  };
+
+/* Print what depends on the relocated debugging sections.  */
+static int
+print_module (Dwfl_Module *mod, void **userdata __attribute__ ((unused)),
+	      const char *name, Dwarf_Addr start __attribute__ ((unused)),
+	      void *arg __attribute__ ((unused)))
+{
+  Dwarf_Addr bias;
+  if (dwfl_module_getdwarf (mod, &bias) == NULL)
+    {
+      printf ("%s: %s\n", name, dwfl_errmsg (-1));
+      exit (1);
+    }
+
+  Dwarf_Die *cu = NULL;
+  while ((cu = dwfl_module_nextcu (mod, cu, &bias)) != NULL)
+    {
+      Dwarf_Addr low = 0;
+      dwarf_lowpc (cu, &low);
+      printf ("%s: CU %s low_pc 0x%" PRIx64 "\n", name,
+	      dwarf_diename (cu) ?: "???", low + bias);
+
+      Dwarf_Lines *lines;
+      size_t nlines;
+      if (dwarf_getsrclines (cu, &lines, &nlines) == 0)
+	for (size_t i = 0; i < nlines; ++i)
+	  {
+	    Dwarf_Line *line = dwarf_onesrcline (lines, i);
+	    Dwarf_Addr addr;
+	    int lineno;
+	    dwarf_lineaddr (line, &addr);
+	    dwarf_lineno (line, &lineno);
+	    printf ("  0x%" PRIx64 " %d\n", addr + bias, lineno);
+	  }
+    }
+
+  return DWARF_CB_OK;
+}
+
+/* Usage: dwfl-reloc-cache DIR FILE...
+   Reports all FILEs offline, using DIR as relocation cache unless
+   it is "-", and prints their CUs and line tables.  */
+int
+main (int argc, char **argv)
+{
+  if (argc < 3)
+    return 1;
+
+  Dwfl *dwfl = dwfl_begin (&offline_callbacks);
+  assert (dwfl != NULL);
+  if (strcmp (argv[1], "-") != 0 && dwfl_set_reloc_cache (dwfl, argv[1]) != 0)
+    {
+      printf ("dwfl_set_reloc_cache: %s\n", dwfl_errmsg (-1));
+      return 1;
+    }
+
+  dwfl_report_begin (dwfl);
+  for (int i = 2; i < argc; ++i)
+    if (dwfl_report_offline (dwfl, argv[i], argv[i], -1) == NULL)
+      {
+	printf ("%s: %s\n", argv[i], dwfl_errmsg (-1));
+	return 1;
+      }
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  dwfl_getmodules (dwfl, print_module, NULL, 0);
+  dwfl_end (dwfl);
+  return 0;
+}
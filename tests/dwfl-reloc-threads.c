@@ -0,0 +1,126 @@
+/* Test program for relocating ET_REL files with dwfl_set_threads.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+#include <gelf.h>
+
+
+static const Dwfl_Callbacks offline_callbacks =
+  {
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+    .section_address = dwfl_offline_section_address,
+  };
+
+/* Report FILE offline to a new Dwfl that may use NTHREADS threads and
+   return the ELF file with its debugging sections relocated.  */
+static Elf *
+relocate (Dwfl **dwflp, const char *file, unsigned int nthreads)
+{
+  Dwfl *dwfl = dwfl_begin (&offline_callbacks);
+  assert (dwfl != NULL);
+  if (dwfl_set_threads (dwfl, nthreads) != 0)
+    {
+      printf ("dwfl_set_threads: %s\n", dwfl_errmsg (-1));
+      exit (1);
+    }
+
+  dwfl_report_begin (dwfl);
+  Dwfl_Module *mod = dwfl_report_offline (dwfl, file, file, -1);
+  if (mod == NULL)
+    {
+      printf ("%s: %s\n", file, dwfl_errmsg (-1));
+      exit (1);
+    }
+  dwfl_report_end (dwfl, NULL, NULL);
+
+  Dwarf_Addr bias;
+  Dwarf *dbg = dwfl_module_getdwarf (mod, &bias);
+  if (dbg == NULL)
+    {
+      printf ("%s: %s\n", file, dwfl_errmsg (-1));
+      exit (1);
+    }
+
+  *dwflp = dwfl;
+  return dwarf_getelf (dbg);
+}
+
+/* Usage: dwfl-reloc-threads NTHREADS FILE...
+   Relocates each FILE once without threads and once with up to
+   NTHREADS threads, and checks that all section headers and contents
+   are the same.  */
+int
+main (int argc, char **argv)
+{
+  if (argc < 3)
+    return 1;
+
+  unsigned int nthreads = atoi (argv[1]);
+  int result = 0;
+  for (int i = 2; i < argc; ++i)
+    {
+      Dwfl *serial_dwfl, *threaded_dwfl;
+      Elf *serial = relocate (&serial_dwfl, argv[i], 1);
+      Elf *threaded = relocate (&threaded_dwfl, argv[i], nthreads);
+
+      size_t nsects = 0;
+      size_t differ = 0;
+      size_t nrels = 0;
+      Elf_Scn *scn = NULL;
+      Elf_Scn *tscn = NULL;
+      while ((scn = elf_nextscn (serial, scn)) != NULL)
+	{
+	  tscn = elf_nextscn (threaded, tscn);
+	  assert (tscn != NULL);
+
+	  GElf_Shdr shdr_mem, *shdr = gelf_getshdr (scn, &shdr_mem);
+	  GElf_Shdr tshdr_mem, *tshdr = gelf_getshdr (tscn, &tshdr_mem);
+	  Elf_Data *data = elf_getdata (scn, NULL);
+	  Elf_Data *tdata = elf_getdata (tscn, NULL);
+	  assert (shdr != NULL && tshdr != NULL);
+
+	  ++nsects;
+	  if (shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
+	    nrels += shdr->sh_size / shdr->sh_entsize;
+	  if (memcmp (shdr, tshdr, sizeof *shdr) != 0
+	      || (data == NULL) != (tdata == NULL)
+	      || (data != NULL
+		  && (data->d_size != tdata->d_size
+		      || (data->d_buf != NULL
+			  && memcmp (data->d_buf, tdata->d_buf,
+				     data->d_size) != 0))))
+	    ++differ;
+	}
+      assert (elf_nextscn (threaded, tscn) == NULL);
+
+      const char *base = strrchr (argv[i], '/');
+      printf ("%s: %zu sections, %zu relocations left, %zu differ\n",
+	      base != NULL ? base + 1 : argv[i], nsects, nrels, differ);
+      if (differ != 0)
+	result = 1;
+
+      dwfl_end (serial_dwfl);
+      dwfl_end (threaded_dwfl);
+    }
+
+  return result;
+}
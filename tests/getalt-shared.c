@@ -0,0 +1,148 @@
+/* Test that dwz alt files are shared between Dwarfs.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct counts
+{
+  size_t refs;
+  size_t strs;
+  int errors;
+};
+
+static int
+check_attr (Dwarf_Attribute *attr, void *arg)
+{
+  struct counts *counts = arg;
+  Dwarf_Die die;
+  switch (dwarf_whatform (attr))
+    {
+    case DW_FORM_GNU_ref_alt:
+      if (dwarf_formref_die (attr, &die) == NULL)
+	{
+	  printf ("bad ref_alt: %s\n", dwarf_errmsg (-1));
+	  counts->errors++;
+	}
+      else
+	counts->refs++;
+      break;
+
+    case DW_FORM_GNU_strp_alt:
+      if (dwarf_formstring (attr) == NULL)
+	{
+	  printf ("bad strp_alt: %s\n", dwarf_errmsg (-1));
+	  counts->errors++;
+	}
+      else
+	counts->strs++;
+      break;
+    }
+
+  return DWARF_CB_OK;
+}
+
+static void
+walk (Dwarf_Die *die, struct counts *counts)
+{
+  do
+    {
+      dwarf_getattrs (die, check_attr, counts, 0);
+
+      Dwarf_Die child;
+      if (dwarf_child (die, &child) == 0)
+	walk (&child, counts);
+    }
+  while (dwarf_siblingof (die, die) == 0);
+}
+
+static int
+count_alt_refs (Dwarf *dbg, const char *name)
+{
+  struct counts counts = { 0, 0, 0 };
+  Dwarf_CU *cu = NULL;
+  Dwarf_Die cudie;
+  while (dwarf_get_units (dbg, cu, &cu, NULL, NULL, &cudie, NULL) == 0)
+    walk (&cudie, &counts);
+
+  printf ("%s: ref_alt: %zd, strp_alt: %zd\n", name, counts.refs,
+	  counts.strs);
+  return counts.errors;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int errors = 0;
+  for (int i = 1; i < argc; i++)
+    {
+      printf ("file: %s\n", argv[i]);
+      int fd1 = open (argv[i], O_RDONLY);
+      int fd2 = open (argv[i], O_RDONLY);
+      int fd3 = open (argv[i], O_RDONLY);
+      Dwarf *dbg1 = dwarf_begin (fd1, DWARF_C_READ);
+      Dwarf *dbg2 = dwarf_begin (fd2, DWARF_C_READ);
+      Dwarf *dbg3 = dwarf_begin (fd3, DWARF_C_READ);
+      if (dbg1 == NULL || dbg2 == NULL || dbg3 == NULL)
+	{
+	  printf ("%s not usable: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      /* Only the Dwarfs that asked for it share their alt file.  */
+      dwarf_share_alt (dbg1);
+      dwarf_share_alt (dbg2);
+
+      Dwarf *alt1 = dwarf_getalt (dbg1);
+      Dwarf *alt2 = dwarf_getalt (dbg2);
+      Dwarf *alt3 = dwarf_getalt (dbg3);
+      if (alt1 == NULL || alt2 == NULL || alt3 == NULL)
+	{
+	  printf ("no alt file: %s\n", dwarf_errmsg (-1));
+	  return -1;
+	}
+      printf ("shared alt: %s\n", alt1 == alt2 ? "yes" : "no");
+      printf ("private alt: %s\n", alt3 != alt1 ? "yes" : "no");
+
+      errors += count_alt_refs (dbg3, "private");
+      dwarf_end (dbg3);
+      close (fd3);
+
+      /* The second Dwarf must still be able to use the alt file after
+	 the first one is gone.  */
+      errors += count_alt_refs (dbg1, "first");
+      dwarf_end (dbg1);
+      close (fd1);
+
+      errors += count_alt_refs (dbg2, "second");
+      dwarf_end (dbg2);
+      close (fd2);
+    }
+
+  return errors == 0 ? 0 : -1;
+}
@@ -0,0 +1,196 @@
+/* Test dwarf_getlocation_entries against dwarf_getlocations.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const unsigned int loc_attrs[] =
+  {
+    DW_AT_location,
+    DW_AT_frame_base,
+    DW_AT_data_member_location,
+    DW_AT_string_length,
+    DW_AT_return_addr,
+    DW_AT_static_link,
+    DW_AT_use_location,
+    DW_AT_vtable_elem_location
+  };
+
+#define NLOC_ATTRS (sizeof loc_attrs / sizeof loc_attrs[0])
+
+static int
+check_attr (Dwarf_Die *die, Dwarf_Attribute *attr, size_t *count)
+{
+  Dwarf_Location_Entry *entries;
+  size_t nentries;
+  if (dwarf_getlocation_entries (attr, &entries, &nentries) != 0)
+    {
+      /* dwarf_getlocations must fail on some entry too.  */
+      Dwarf_Addr base, start, end;
+      Dwarf_Op *expr;
+      size_t exprlen;
+      ptrdiff_t off = 0;
+      while ((off = dwarf_getlocations (attr, off, &base, &start, &end,
+					&expr, &exprlen)) > 0)
+	;
+      if (off == 0)
+	{
+	  printf ("DIE [%" PRIx64 "] attr 0x%x: unexpected failure: %s\n",
+		  dwarf_dieoffset (die), dwarf_whatattr (attr),
+		  dwarf_errmsg (-1));
+	  return -1;
+	}
+      return 0;
+    }
+
+  /* A second call must give the cached entries.  */
+  Dwarf_Location_Entry *entries2;
+  size_t nentries2;
+  if (dwarf_getlocation_entries (attr, &entries2, &nentries2) != 0
+      || entries2 != entries || nentries2 != nentries)
+    {
+      printf ("DIE [%" PRIx64 "] attr 0x%x: entries not cached\n",
+	      dwarf_dieoffset (die), dwarf_whatattr (attr));
+      return -1;
+    }
+
+  Dwarf_Addr base, start, end;
+  Dwarf_Op *expr;
+  size_t exprlen;
+  ptrdiff_t off = 0;
+  size_t i = 0;
+  while ((off = dwarf_getlocations (attr, off, &base, &start, &end,
+				    &expr, &exprlen)) > 0)
+    {
+      if (i >= nentries
+	  || entries[i].start != start || entries[i].end != end
+	  || entries[i].exprlen != exprlen
+	  || (exprlen != 0 && entries[i].expr != expr))
+	{
+	  printf ("DIE [%" PRIx64 "] attr 0x%x: entry %zd differs\n",
+		  dwarf_dieoffset (die), dwarf_whatattr (attr), i);
+	  return -1;
+	}
+      i++;
+    }
+  if (off < 0 || i != nentries)
+    {
+      printf ("DIE [%" PRIx64 "] attr 0x%x: %zd entries, expected %zd\n",
+	      dwarf_dieoffset (die), dwarf_whatattr (attr), nentries, i);
+      return -1;
+    }
+
+  /* Every entry must also be found by address.  */
+  for (i = 0; i < nentries; i++)
+    {
+      size_t expect = 0;
+      for (size_t j = 0; j < nentries; j++)
+	if (entries[i].start >= entries[j].start
+	    && entries[i].start < entries[j].end)
+	  expect++;
+
+      int got = dwarf_getlocation_addr (attr, entries[i].start,
+					NULL, NULL, 0);
+      /* A single location expression that is empty isn't counted.  */
+      if (got < 0
+	  || ((size_t) got != expect
+	      && ! (nentries == 1 && entries[0].exprlen == 0 && got == 0)))
+	{
+	  printf ("DIE [%" PRIx64 "] attr 0x%x: %d locations at 0x%" PRIx64
+		  ", expected %zd\n", dwarf_dieoffset (die),
+		  dwarf_whatattr (attr), got, entries[i].start, expect);
+	  return -1;
+	}
+    }
+
+  *count += nentries;
+  return 0;
+}
+
+static int
+walk (Dwarf_Die *die, size_t *attrs, size_t *count)
+{
+  do
+    {
+      for (size_t i = 0; i < NLOC_ATTRS; i++)
+	{
+	  Dwarf_Attribute attr;
+	  if (dwarf_attr (die, loc_attrs[i], &attr) != NULL)
+	    {
+	      ++*attrs;
+	      if (check_attr (die, &attr, count) != 0)
+		return -1;
+	    }
+	}
+
+      Dwarf_Die child;
+      int res = dwarf_child (die, &child);
+      if (res < 0)
+	return -1;
+      if (res == 0 && walk (&child, attrs, count) != 0)
+	return -1;
+    }
+  while (dwarf_tag (die) != DW_TAG_compile_unit
+	 && dwarf_tag (die) != DW_TAG_partial_unit
+	 && dwarf_tag (die) != DW_TAG_type_unit
+	 && dwarf_tag (die) != DW_TAG_skeleton_unit
+	 && dwarf_siblingof (die, die) == 0);
+
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++)
+    {
+      printf ("file: %s\n", argv[i]);
+      int fd = open (argv[i], O_RDONLY);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      if (dbg == NULL)
+	{
+	  printf ("%s not usable: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      size_t attrs = 0;
+      size_t entries = 0;
+      Dwarf_CU *cu = NULL;
+      Dwarf_Die cudie;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, NULL, &cudie, NULL) == 0)
+	if (walk (&cudie, &attrs, &entries) != 0)
+	  return -1;
+
+      printf ("attributes: %zd, entries: %zd\n", attrs, entries);
+
+      dwarf_end (dbg);
+      close (fd);
+    }
+
+  return 0;
+}
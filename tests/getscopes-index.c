@@ -0,0 +1,252 @@
+/* Test dwarf_getscopes against a walk of the whole unit.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* The walk below is how dwarf_getscopes found the scopes of a unit
+   before it used an index.  The test files don't have imported
+   units, so those aren't handled.  */
+
+#define MAX_DEPTH 256
+
+static bool
+may_have_scopes (int tag)
+{
+  switch (tag)
+    {
+    case DW_TAG_compile_unit:
+    case DW_TAG_module:
+    case DW_TAG_lexical_block:
+    case DW_TAG_with_stmt:
+    case DW_TAG_catch_block:
+    case DW_TAG_try_block:
+    case DW_TAG_entry_point:
+    case DW_TAG_inlined_subroutine:
+    case DW_TAG_subprogram:
+    case DW_TAG_namespace:
+    case DW_TAG_class_type:
+    case DW_TAG_structure_type:
+      return true;
+    default:
+      return false;
+    }
+}
+
+/* Like pc_match and pc_record, descend into the first child of
+   PATH[DEPTH] that contains PC.  Returns the depth of the innermost
+   DIE containing PC, zero if there is none.  */
+static int
+pc_path (Dwarf_Die *path, int depth, Dwarf_Addr pc)
+{
+  Dwarf_Die child;
+  if (dwarf_child (&path[depth], &child) != 0)
+    return depth;
+
+  do
+    if (dwarf_haspc (&child, pc) > 0)
+      {
+	assert (depth + 1 < MAX_DEPTH);
+	path[depth + 1] = child;
+	if (may_have_scopes (dwarf_tag (&child))
+	    && dwarf_haschildren (&child))
+	  return pc_path (path, depth + 1, pc);
+	return depth + 1;
+      }
+  while (dwarf_siblingof (&child, &child) == 0);
+
+  return depth;
+}
+
+/* Like origin_match, find the DIE at ADDR below ROOT.  The DIEs
+   between ROOT and it are stored in CHAIN from N on.  Returns the
+   number of DIEs in CHAIN, or -1 if it wasn't found.  */
+static int
+find_origin (Dwarf_Die *root, void *addr, Dwarf_Die *chain, int n)
+{
+  Dwarf_Die child;
+  if (dwarf_child (root, &child) != 0)
+    return -1;
+
+  do
+    {
+      if (child.addr == addr)
+	return n;
+
+      if (may_have_scopes (dwarf_tag (&child)) && dwarf_haschildren (&child))
+	{
+	  assert (n < MAX_DEPTH);
+	  chain[n] = child;
+	  int res = find_origin (&chain[n], addr, chain, n + 1);
+	  if (res >= 0)
+	    return res;
+	}
+    }
+  while (dwarf_siblingof (&child, &child) == 0);
+
+  return -1;
+}
+
+/* Find the scopes containing PC in the unit of CUDIE by walking the
+   whole unit.  Stores them in SCOPES and returns their number.  */
+static int
+walk_scopes (Dwarf_Die *cudie, Dwarf_Addr pc, Dwarf_Die *scopes)
+{
+  Dwarf_Die path[MAX_DEPTH];
+  path[0] = *cudie;
+  int innermost = pc_path (path, 0, pc);
+  if (innermost == 0)
+    return 0;
+
+  /* The innermost concrete inlined instance, if any.  */
+  int inlined = 0;
+  for (int d = innermost; d > 0 && inlined == 0; --d)
+    if (dwarf_tag (&path[d]) == DW_TAG_inlined_subroutine)
+      inlined = d;
+
+  int n = 0;
+  for (int d = innermost; d >= inlined; --d)
+    scopes[n++] = path[d];
+  if (inlined == 0)
+    return n;
+
+  /* Continue with the scopes of the abstract definition, searched from
+     the innermost scope containing the inlined instance outwards.  */
+  Dwarf_Attribute attr_mem;
+  Dwarf_Die origin;
+  if (dwarf_formref_die (dwarf_attr (&path[inlined], DW_AT_abstract_origin,
+				     &attr_mem), &origin) == NULL)
+    return -1;
+
+  for (int d = inlined - 1; d >= 0; --d)
+    {
+      Dwarf_Die chain[MAX_DEPTH];
+      int nchain = find_origin (&path[d], origin.addr, chain, 0);
+      if (nchain < 0)
+	continue;
+
+      assert (n + nchain + d + 1 <= 2 * MAX_DEPTH);
+      while (nchain > 0)
+	scopes[n++] = chain[--nchain];
+      while (d >= 0)
+	scopes[n++] = path[d--];
+      return n;
+    }
+
+  return 0;
+}
+
+/* Compare the scopes dwarf_getscopes finds for ADDR in the unit of
+   CUDIE with the walk.  Returns 0 if they match.  */
+static int
+check_scopes (Dwarf_Die *cudie, Dwarf_Addr addr)
+{
+  Dwarf_Die *scopes;
+  int nscopes = dwarf_getscopes (cudie, addr, &scopes);
+  Dwarf_Die expected[2 * MAX_DEPTH];
+  int nexpected = walk_scopes (cudie, addr, expected);
+
+  int res = nscopes == nexpected ? 0 : -1;
+  for (int i = 0; res == 0 && i < nscopes; ++i)
+    if (dwarf_dieoffset (&scopes[i]) != dwarf_dieoffset (&expected[i]))
+      res = -1;
+
+  if (res != 0)
+    {
+      printf ("%#" PRIx64 ":", addr);
+      for (int i = 0; i < nscopes; ++i)
+	printf (" [%" PRIx64 "]", dwarf_dieoffset (&scopes[i]));
+      printf (", expected:");
+      for (int i = 0; i < nexpected; ++i)
+	printf (" [%" PRIx64 "]", dwarf_dieoffset (&expected[i]));
+      printf ("\n");
+    }
+
+  if (nscopes > 0)
+    free (scopes);
+  return res;
+}
+
+/* Check the scopes of every line table address of every unit, and of
+   the address before it.  */
+int
+main (int argc, char *argv[])
+{
+  int result = 0;
+  for (int i = 1; i < argc; i++)
+    {
+      int fd = open (argv[i], O_RDONLY);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      if (dbg == NULL)
+	{
+	  printf ("%s not usable: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      size_t naddrs = 0;
+      size_t ndiffer = 0;
+      Dwarf_CU *cu = NULL;
+      Dwarf_Die cudie;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, NULL, &cudie, NULL) == 0)
+	{
+	  Dwarf_Lines *lines;
+	  size_t nlines;
+	  if (dwarf_getsrclines (&cudie, &lines, &nlines) != 0)
+	    continue;
+
+	  for (size_t l = 0; l < nlines; ++l)
+	    {
+	      Dwarf_Addr addr;
+	      if (dwarf_lineaddr (dwarf_onesrcline (lines, l), &addr) != 0)
+		return -1;
+	      if (addr > 0)
+		{
+		  naddrs++;
+		  if (check_scopes (&cudie, addr - 1) != 0)
+		    ndiffer++;
+		}
+	      naddrs++;
+	      if (check_scopes (&cudie, addr) != 0)
+		ndiffer++;
+	    }
+	}
+
+      printf ("%s: %zd addresses, %zd differ\n", basename (argv[i]),
+	      naddrs, ndiffer);
+      if (ndiffer != 0)
+	result = 1;
+
+      dwarf_end (dbg);
+      close (fd);
+    }
+
+  return result;
+}
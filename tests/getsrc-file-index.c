@@ -0,0 +1,165 @@
+/* Test dwarf_index_srcfiles against unindexed dwarf_getsrc_file.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Don't take forever on big files.  */
+#define MAX_QUERIES 250
+
+static int
+compare (Dwarf *dbg, Dwarf *idbg, const char *fname, int line, int col,
+	 size_t max)
+{
+  Dwarf_Line **srcs = NULL;
+  size_t nsrcs = max;
+  if (max != 0)
+    srcs = malloc (max * sizeof srcs[0]);
+  Dwarf_Line **isrcs = NULL;
+  size_t insrcs = max;
+  if (max != 0)
+    isrcs = malloc (max * sizeof isrcs[0]);
+
+  int res = dwarf_getsrc_file (dbg, fname, line, col, &srcs, &nsrcs);
+  int ires = dwarf_getsrc_file (idbg, fname, line, col, &isrcs, &insrcs);
+  if (res != ires || (res == 0 && nsrcs != insrcs))
+    {
+      printf ("%s:%d:%d (%zd): %d, %zd != %d, %zd\n", fname, line, col, max,
+	      res, res == 0 ? nsrcs : 0, ires, ires == 0 ? insrcs : 0);
+      return -1;
+    }
+
+  for (size_t i = 0; res == 0 && i < nsrcs; i++)
+    {
+      Dwarf_Addr addr, iaddr;
+      int l, il, c, ic;
+      dwarf_lineaddr (srcs[i], &addr);
+      dwarf_lineaddr (isrcs[i], &iaddr);
+      dwarf_lineno (srcs[i], &l);
+      dwarf_lineno (isrcs[i], &il);
+      dwarf_linecol (srcs[i], &c);
+      dwarf_linecol (isrcs[i], &ic);
+      if (addr != iaddr || l != il || c != ic
+	  || strcmp (dwarf_linesrc (srcs[i], NULL, NULL),
+		     dwarf_linesrc (isrcs[i], NULL, NULL)) != 0)
+	{
+	  printf ("%s:%d:%d (%zd): match %zd differs: %#" PRIx64
+		  " %d:%d != %#" PRIx64 " %d:%d\n",
+		  fname, line, col, max, i, addr, l, c, iaddr, il, ic);
+	  return -1;
+	}
+    }
+
+  free (srcs);
+  free (isrcs);
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++)
+    {
+      printf ("file: %s\n", argv[i]);
+      int fd = open (argv[i], O_RDONLY);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      int ifd = open (argv[i], O_RDONLY);
+      Dwarf *idbg = dwarf_begin (ifd, DWARF_C_READ);
+      if (dbg == NULL || idbg == NULL)
+	{
+	  printf ("%s not usable: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      if (dwarf_index_srcfiles (idbg, 4) != 0)
+	{
+	  printf ("%s cannot be indexed: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      /* Count the rows first, to spread the queries over them.  */
+      size_t nrows = 0;
+      Dwarf_CU *cu = NULL;
+      Dwarf_Die cudie;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, NULL, &cudie, NULL) == 0)
+	{
+	  Dwarf_Lines *lines;
+	  size_t nlines;
+	  if (dwarf_getsrclines (&cudie, &lines, &nlines) == 0)
+	    nrows += nlines;
+	}
+      size_t step = nrows / MAX_QUERIES + 1;
+
+      size_t queries = 0;
+      size_t row = 0;
+      cu = NULL;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, NULL, &cudie, NULL) == 0)
+	{
+	  Dwarf_Lines *lines;
+	  size_t nlines;
+	  if (dwarf_getsrclines (&cudie, &lines, &nlines) != 0)
+	    continue;
+
+	  for (size_t l = 0; l < nlines; l++, row++)
+	    {
+	      if (row % step != 0)
+		continue;
+
+	      Dwarf_Line *line = dwarf_onesrcline (lines, l);
+	      const char *fname = dwarf_linesrc (line, NULL, NULL);
+	      const char *base = strrchr (fname, '/');
+	      base = base != NULL ? base + 1 : fname;
+	      int lineno, col;
+	      dwarf_lineno (line, &lineno);
+	      dwarf_linecol (line, &col);
+
+	      if (compare (dbg, idbg, fname, lineno, 0, 0) != 0
+		  || compare (dbg, idbg, base, lineno, 0, 0) != 0
+		  || compare (dbg, idbg, base, lineno, col, 0) != 0
+		  || compare (dbg, idbg, base, lineno + 1, 0, 0) != 0
+		  || compare (dbg, idbg, base, 0, 0, 0) != 0
+		  || compare (dbg, idbg, base, lineno, 0, 1) != 0)
+		return -1;
+	      queries++;
+	    }
+	}
+
+      if (compare (dbg, idbg, "no-such-file.c", 1, 0, 0) != 0)
+	return -1;
+
+      printf ("queries: %zd\n", queries);
+
+      dwarf_end (dbg);
+      dwarf_end (idbg);
+      close (fd);
+      close (ifd);
+    }
+
+  return 0;
+}
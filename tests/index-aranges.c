@@ -0,0 +1,94 @@
+/* Test dwarf_index_aranges.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include ELFUTILS_HEADER(dw)
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+int
+main (int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++)
+    {
+      printf ("file: %s\n", argv[i]);
+      int fd = open (argv[i], O_RDONLY);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      if (dbg == NULL)
+	{
+	  printf ("%s not usable: %s\n", argv[i], dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      /* Use more threads than there are units.  */
+      if (dwarf_index_aranges (dbg, 4) != 0)
+	{
+	  printf ("dwarf_index_aranges: %s\n", dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      Dwarf_Aranges *aranges;
+      size_t naranges;
+      if (dwarf_getaranges (dbg, &aranges, &naranges) != 0)
+	{
+	  printf ("dwarf_getaranges: %s\n", dwarf_errmsg (-1));
+	  return -1;
+	}
+
+      for (size_t n = 0; n < naranges; ++n)
+	{
+	  Dwarf_Addr addr;
+	  Dwarf_Word length;
+	  Dwarf_Off offset;
+	  Dwarf_Arange *arange = dwarf_onearange (aranges, n);
+	  if (arange == NULL
+	      || dwarf_getarangeinfo (arange, &addr, &length, &offset) != 0)
+	    {
+	      printf ("bad arange %zd: %s\n", n, dwarf_errmsg (-1));
+	      return -1;
+	    }
+
+	  Dwarf_Die cudie;
+	  const char *name = "???";
+	  if (dwarf_offdie (dbg, offset, &cudie) != NULL)
+	    name = dwarf_diename (&cudie) ?: "???";
+	  printf (" %#" PRIx64 "..%#" PRIx64 ": [%" PRIx64 "] %s\n",
+		  addr, addr + length - 1, offset, name);
+
+	  /* Every address should map back to the same unit.  */
+	  if (dwarf_getarange_addr (aranges, addr) == NULL
+	      || dwarf_getarange_addr (aranges, addr + length - 1) == NULL)
+	    {
+	      printf ("no arange for %#" PRIx64 "\n", addr);
+	      return -1;
+	    }
+	}
+
+      dwarf_end (dbg);
+      close (fd);
+    }
+
+  return 0;
+}
@@ -67,4 +67,11 @@ fu()
 /tmp/x.cpp:33
 EOF
 
+# The demangled names are cached, each name is only demangled once.
+tempfiles stats.out
+testrun ${abs_top_builddir}/src/addr2line -C -f -i --demangle-stats -e testfile-inlines 0x00000000000005a0 0x00000000000005a1 0x00000000000005b0 0x00000000000005b1 0x00000000000005c0 0x00000000000005d0 0x00000000000005e0 0x00000000000005e1 0x00000000000005f0 0x00000000000005f1 0x00000000000005f2 2> stats.out > /dev/null
+testrun_compare cat stats.out <<\EOF
+demangle cache: 11 lookups, 7 hits, at most 4 names cached
+EOF
+
 exit 0
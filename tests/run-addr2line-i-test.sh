@@ -220,4 +220,29 @@ testrun_compare ${abs_top_builddir}/src/addr2line --pretty-print -a -f -i -e tes
  (inlined by) _Z2fuv at /tmp/x.cpp:33
 EOF
 
+# Out of order and repeated addresses looked up together.
+testrun_compare ${abs_top_builddir}/src/addr2line --batch -a -f -i -e testfile-inlines 0x00000000000005f2 0x00000000000005a0 0x00000000000005e1 0x00000000000005a0 0x00000000000005b1 <<\EOF
+0x00000000000005f2
+foobar inlined at /tmp/x.cpp:33 in _Z2fuv
+/tmp/x.cpp:5
+_Z2fuv
+/tmp/x.cpp:33
+0x00000000000005a0
+foobar
+/tmp/x.cpp:5
+0x00000000000005e1
+fubar inlined at /tmp/x.cpp:20 in _Z3foov
+/tmp/x.cpp:10
+baz
+/tmp/x.cpp:20
+_Z3foov
+/tmp/x.cpp:26
+0x00000000000005a0
+foobar
+/tmp/x.cpp:5
+0x00000000000005b1
+fubar
+/tmp/x.cpp:11
+EOF
+
 exit 0
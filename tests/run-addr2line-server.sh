@@ -0,0 +1,86 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+testfiles testfile testfile-inlines
+tempfiles server.in server.good server.out
+
+# Requests without a file use -e.  The build ID is the one of
+# testfile-inlines, which is found among the open files.  A request
+# for a file that doesn't exist gets an empty answer.
+cat > server.in <<\EOF
+0x08048468
+foo
+
+file testfile-inlines
+0x00000000000005a0
+0x00000000000005b1
+
+file no-such-file
+0x00000000000005a0
+
+build-id 2135fd61aca50b90333a956bec1ecfed572dd588
+0x00000000000005c0
+
+bar
+
+EOF
+
+cat > server.good <<\EOF
+foo
+/home/drepper/gnu/new-bu/build/ttt/f.c:3
+foo
+/home/drepper/gnu/new-bu/build/ttt/f.c:3
+
+foobar
+/tmp/x.cpp:5
+fubar
+/tmp/x.cpp:11
+
+
+foobar inlined at /tmp/x.cpp:15 in _Z3barv
+/tmp/x.cpp:5
+
+bar
+/home/drepper/gnu/new-bu/build/ttt/b.c:4
+
+EOF
+
+testrun ${abs_top_builddir}/src/addr2line --server -f -e testfile \
+  < server.in > server.out || exit 1
+cmp server.good server.out || exit 1
+
+# Without -e, requests have to name their file.
+cat > server.good <<\EOF
+
+/tmp/x.cpp:5
+/tmp/x.cpp:11
+
+
+/tmp/x.cpp:5
+/tmp/x.cpp:15
+
+
+EOF
+
+# The last request fails, so this exits with 1.
+testrun ${abs_top_builddir}/src/addr2line --server -i \
+  < server.in > server.out && exit 1
+cmp server.good server.out || exit 1
+
+exit 0
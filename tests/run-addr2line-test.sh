@@ -107,6 +107,13 @@ echo "# Everything from stdin (with newlines) with addresses."
 cat stdin.nl | testrun ${abs_top_builddir}/src/addr2line -a -f -e testfile > stdin.nl.out || exit 1
 cmp good.addr.out stdin.nl.out || exit 1
 
+echo "# Everything on the command line with addresses, looked up together."
+cat good.addr.out | testrun_compare ${abs_top_builddir}/src/addr2line --batch -a -f -e testfile 0x08048468 0x0804845c foo bar foo+0x0 bar+0x0 foo-0x0 bar-0x0
+
+echo "# Everything from stdin (with newlines) with addresses, looked up together."
+cat stdin.nl | testrun ${abs_top_builddir}/src/addr2line --batch -a -f -e testfile > stdin.nl.out || exit 1
+cmp good.addr.out stdin.nl.out || exit 1
+
 echo "# Pretty with functions and addresses."
 testrun_compare ${abs_top_builddir}/src/addr2line --pretty -a -f -e testfile 0x08048468 0x0804845c << EOF
 0x08048468: foo at /home/drepper/gnu/new-bu/build/ttt/f.c:3
@@ -0,0 +1,44 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# dwarf_cache_types remembers the results of dwarf_peel_type and
+# dwarf_aggregate_size.  cache-types checks that the cached results
+# are the same as the ones found without the cache for every DIE with
+# a DW_AT_type.  See run-aggregate-size.sh for the testfile-sizes files.
+
+testfiles testfile-sizes1.o testfile-sizes2.o testfile-sizes3.o
+testfiles testfile-sizes4.o testfile-dwarf-4 testfile-dwarf-5
+testfiles testfile-debug-types
+
+testrun_compare ${abs_builddir}/cache-types testfile-sizes1.o \
+  testfile-sizes2.o testfile-sizes3.o testfile-sizes4.o <<\EOF
+testfile-sizes1.o: 20 types, 20 peeled, 20 sized, 0 differ
+testfile-sizes2.o: 20 types, 20 peeled, 20 sized, 0 differ
+testfile-sizes3.o: 45 types, 43 peeled, 43 sized, 0 differ
+testfile-sizes4.o: 2 types, 2 peeled, 2 sized, 0 differ
+EOF
+
+testrun_compare ${abs_builddir}/cache-types testfile-dwarf-4 \
+  testfile-dwarf-5 testfile-debug-types <<\EOF
+testfile-dwarf-4: 25 types, 25 peeled, 25 sized, 0 differ
+testfile-dwarf-5: 25 types, 25 peeled, 25 sized, 0 differ
+testfile-debug-types: 4 types, 4 peeled, 3 sized, 0 differ
+EOF
+
+exit 0
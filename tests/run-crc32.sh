@@ -0,0 +1,33 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# see tests/testfile-dwarf-45.source
+testfiles testfile-dwarf-4 testfile-dwarf-5 testfile11
+
+tempfiles empty
+touch empty
+
+testrun_compare ${abs_builddir}/crc32 testfile-dwarf-4 testfile-dwarf-5 testfile11 empty <<\EOF
+4b3ee6f5  testfile-dwarf-4
+65830227  testfile-dwarf-5
+73f67d03  testfile11
+00000000  empty
+EOF
+
+exit 0
@@ -0,0 +1,45 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# see tests/testfile-dwarf-45.source
+testfiles testfile-dwarf-4
+
+tempfiles main.debug main
+mkdir -p debugdir
+testrun ${abs_top_builddir}/src/strip -o main -f main.debug testfile-dwarf-4
+
+# With an absolute debuginfo path the debug file is looked up in
+# subdirectories named after the main file's directory, and finally
+# directly in the debugdir.
+testrun_compare ${abs_builddir}/debuginfo-cache $(pwd)/debugdir \
+  $(pwd)/main $(pwd)/main.debug $(pwd)/debugdir/main.debug <<\EOF
+uncached: dwarf no
+installed: dwarf yes
+before: dwarf no
+cached: dwarf no
+flushed: dwarf yes
+removed: dwarf no
+rereported: dwarf yes
+off: dwarf no
+EOF
+
+rm -f debugdir/main.debug
+rmdir debugdir
+
+exit 0
@@ -0,0 +1,85 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# see run-readelf-dwz-multi.sh
+testfiles testfile_multi_main libtestfile_multi_shared.so
+# see run-readelf-zdebug-rel.sh
+testfiles testfile-debug-rel.o
+# see run-elflint-test.sh
+testfiles testfile-s390x-hash-both
+# see run-addr2line-test.sh
+testfiles testfile
+
+testrun_compare ${abs_builddir}/dwfl-namesym testfile_multi_main testfile-debug-rel.o testfile-s390x-hash-both -- main nonexistent <<\EOF
+testfile_multi_main: 69 symbols, 28 checked
+testfile_multi_main: main [64] 0x4006ac global
+testfile_multi_main: nonexistent not found
+testfile-debug-rel.o: 15 symbols, 1 checked
+testfile-debug-rel.o: main [14] 0x10000 global
+testfile-debug-rel.o: nonexistent not found
+testfile-s390x-hash-both: 64 symbols, 28 checked
+testfile-s390x-hash-both: main [59] 0x80000678 global
+testfile-s390x-hash-both: nonexistent not found
+EOF
+
+# Without .symtab the .gnu.hash (64bit) and .hash (32bit) tables are used.
+tempfiles multi_shared.stripped testfile.stripped
+testrun ${abs_top_builddir}/src/strip -o multi_shared.stripped libtestfile_multi_shared.so
+testrun ${abs_top_builddir}/src/strip -o testfile.stripped testfile
+
+testrun_compare ${abs_builddir}/dwfl-namesym multi_shared.stripped testfile.stripped -- call_foo _IO_stdin_used <<\EOF
+multi_shared.stripped: 13 symbols, 6 checked
+multi_shared.stripped: call_foo [9] 0x10670 global
+multi_shared.stripped: _IO_stdin_used not found
+testfile.stripped: 7 symbols, 1 checked
+testfile.stripped: call_foo not found
+testfile.stripped: _IO_stdin_used [5] 0x80484e0 global
+EOF
+
+# Of several symbols with the same name, but different versions, the
+# first global one is found, also when the hash chain has a weak one
+# before it.
+#
+# // w.c
+# int foo_v1 (void) { return 1; }
+# __attribute__ ((weak)) int foo_v2 (void) { return 2; }
+# __asm__ (".symver foo_v1,foo@VER_1");
+# __asm__ (".symver foo_v2,foo@@VER_2");
+#
+# // v.c is w.c with foo_v1 weak instead of foo_v2.
+#
+# // v.map
+# VER_1 { global: foo; local: foo_*; };
+# VER_2 { } VER_1;
+#
+# gcc -shared -fPIC -O2 -s -Wl,--version-script=v.map -Wl,--hash-style=gnu \
+#   -o testfile-namesym-weak-gnu.so w.c
+# gcc -shared -fPIC -O2 -s -Wl,--version-script=v.map -Wl,--hash-style=sysv \
+#   -o testfile-namesym-weak-sysv.so v.c
+
+testfiles testfile-namesym-weak-gnu.so testfile-namesym-weak-sysv.so
+
+testrun_compare ${abs_builddir}/dwfl-namesym testfile-namesym-weak-gnu.so testfile-namesym-weak-sysv.so -- foo <<\EOF
+testfile-namesym-weak-gnu.so: 9 symbols, 4 checked
+testfile-namesym-weak-gnu.so: foo [7] 0x11100 global
+testfile-namesym-weak-sysv.so: 9 symbols, 4 checked
+testfile-namesym-weak-sysv.so: foo [2] 0x25120 global
+EOF
+
+exit 0
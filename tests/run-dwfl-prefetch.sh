@@ -0,0 +1,34 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# see tests/testfile-dwarf-45.source
+testfiles testfile-dwarf-4 testfile-dwarf-5
+testfiles testfile-splitdwarf-5 testfile-hello5.dwo testfile-world5.dwo
+
+# see run-readelf-dwz-multi.sh
+testfiles testfile_multi_main testfile_multi.dwz
+
+testrun_compare ${abs_builddir}/dwfl-prefetch testfile-dwarf-4 testfile-dwarf-5 testfile-splitdwarf-5 testfile_multi_main <<\EOF
+testfile-dwarf-4: dwarf yes, cus 2, symbols 72
+testfile-dwarf-5: dwarf yes, cus 2, symbols 73
+testfile-splitdwarf-5: dwarf yes, cus 2, symbols 75
+testfile_multi_main: dwarf yes, cus 1, symbols 69
+EOF
+
+exit 0
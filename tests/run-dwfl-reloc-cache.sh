@@ -0,0 +1,58 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Both have a build ID, one uses REL and the other RELA relocations.
+testfiles hello_i386.ko hello_x86_64.ko
+
+tempfiles uncached.out stored.out loaded.out files.out
+mkdir -p reloccache
+
+# Relocating without a cache, with an empty cache directory and with
+# the cached sections must all give the same DWARF.
+testrun ${abs_builddir}/dwfl-reloc-cache - \
+  hello_i386.ko hello_x86_64.ko > uncached.out
+testrun ${abs_builddir}/dwfl-reloc-cache reloccache \
+  hello_i386.ko hello_x86_64.ko > stored.out
+cmp uncached.out stored.out
+
+test $(ls reloccache/*.reloc | wc -l) -eq 2 || exit 1
+ls -i reloccache > files.out
+
+# A cache hit leaves the files alone.
+testrun ${abs_builddir}/dwfl-reloc-cache reloccache \
+  hello_i386.ko hello_x86_64.ko > loaded.out
+cmp uncached.out loaded.out
+ls -i reloccache | cmp files.out -
+
+# A damaged cache file is ignored and replaced.
+for f in reloccache/*.reloc; do
+  dd if=$f of=$f.new bs=100 count=1 2>/dev/null
+  mv $f.new $f
+done
+testrun ${abs_builddir}/dwfl-reloc-cache reloccache \
+  hello_i386.ko hello_x86_64.ko > loaded.out
+cmp uncached.out loaded.out
+for f in reloccache/*.reloc; do
+  test $(wc -c < $f) -gt 100 || exit 1
+done
+
+rm -f reloccache/*.reloc
+rmdir reloccache
+
+exit 0
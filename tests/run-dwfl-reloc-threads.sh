@@ -0,0 +1,57 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# The .debug_loc and .debug_ranges sections of these files have 70144
+# relocations each, enough for two threads with dwfl_set_threads.
+# testfile-reloc-big-i386.o has REL, testfile-reloc-big-x86_64.o RELA
+# relocations.  They were made with as --32 and as --64 from:
+#
+#	.text
+# f:
+#	.fill 256,1,0x90
+#	.section .debug_abbrev,"",@progbits
+#	.byte 1,0x11,0,0x03,0x08,0,0,0
+#	.section .debug_info,"",@progbits
+#	.long 2f-1f
+# 1:	.short 4
+#	.long .debug_abbrev
+#	.byte 8			# 4 for i386
+#	.uleb128 1
+#	.string "big.c"
+# 2:
+#	.section .debug_loc,"",@progbits
+#	.irp i,0,1,2,...,255
+#	.rept 274
+#	.quad f+\i		# .long for i386
+#	.endr
+#	.endr
+#
+# and the same again for .debug_ranges.
+testfiles testfile-reloc-big-i386.o testfile-reloc-big-x86_64.o
+
+# Relocating them in several threads has to give the same sections as
+# relocating them in one.  The threads are only started on machines
+# with more than one CPU.
+testrun_compare ${abs_builddir}/dwfl-reloc-threads 4 \
+  testfile-reloc-big-i386.o testfile-reloc-big-x86_64.o <<\EOF
+testfile-reloc-big-i386.o: 14 sections, 0 relocations left, 0 differ
+testfile-reloc-big-x86_64.o: 14 sections, 0 relocations left, 0 differ
+EOF
+
+exit 0
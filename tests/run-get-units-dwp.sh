@@ -0,0 +1,1117 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Same sources as testfile-splitdwarf-[45], see tests/testfile-dwarf-45.source
+# but the .dwo files were combined into a DWARF package file and removed.
+#
+# gcc -gdwarf-4 -gsplit-dwarf -gno-as-loc-support \
+#     -gno-variable-location-views -O2 -o hello4.o -c hello.c
+# gcc -gdwarf-4 -gsplit-dwarf -gno-as-loc-support \
+#     -gno-variable-location-views -O2 -o world4.o -c world.c
+# gcc -o testfile-dwp-4 hello4.o world4.o
+# dwp -e testfile-dwp-4 -o testfile-dwp-4.dwp
+#
+# gcc -gdwarf-5 -gsplit-dwarf -gno-as-loc-support \
+#     -gno-variable-location-views -O2 -o hello.o -c hello.c
+# gcc -gdwarf-5 -gsplit-dwarf -gno-as-loc-support \
+#     -gno-variable-location-views -O2 -o world.o -c world.c
+# gcc -o testfile-dwp-5 hello.o world.o
+# llvm-dwp -e testfile-dwp-5 -o testfile-dwp-5.dwp
+#
+# The GNU Binutils dwp creates an invalid index for DWARF5, so llvm-dwp
+# was used for the DWARF5 package.
+
+testfiles testfile-dwp-4 testfile-dwp-4.dwp
+testfiles testfile-dwp-5 testfile-dwp-5.dwp
+
+testrun_compare ${abs_builddir}/get-units-split testfile-dwp-4 << \EOF
+file: testfile-dwp-4
+Got cudie unit_type: 4
+Found a skeleton unit, with split die: hello.c
+Got cudie unit_type: 4
+Found a skeleton unit, with split die: world.c
+
+EOF
+
+testrun_compare ${abs_builddir}/get-units-split testfile-dwp-5 << \EOF
+file: testfile-dwp-5
+Got cudie unit_type: 4
+Found a skeleton unit, with split die: hello.c
+Got cudie unit_type: 4
+Found a skeleton unit, with split die: world.c
+
+EOF
+
+# The split units use the str_offsets, loclists and rnglists
+# contributions from the package file.
+testrun_compare ${abs_builddir}/varlocs --exprlocs -e testfile-dwp-4 << \EOF
+module 'testfile-dwp-4'
+[b] CU 'hello.c'
+  producer (GNU_str_index)
+  language (data1)
+  name (GNU_str_index)
+  comp_dir (GNU_str_index)
+  GNU_dwo_id (data8)
+  [18] base_type "long int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [1c] base_type "long unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [20] typedef "wchar_t"
+    name (GNU_str_index)
+    decl_file (data1)
+    decl_line (data2)
+    decl_column (data1)
+    type (ref4)
+  [2a] base_type "int"
+    byte_size (data1)
+    encoding (data1)
+    name (string)
+  [31] base_type "long long int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [35] base_type "long double"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [39] variable "m"
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    type (ref4)
+    external (flag_present)
+    declaration (flag_present)
+  [43] variable "m"
+    specification (ref4)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    location (exprloc) {addr: 0x4018}
+  [4e] subprogram "main"
+    external (flag_present)
+    name (GNU_str_index)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    declaration (flag_present)
+    sibling (ref4)
+    [5b] formal_parameter
+      type (ref4)
+    [60] formal_parameter
+      type (ref4)
+  [66] pointer_type
+    byte_size (data1)
+    type (ref4)
+  [6c] pointer_type
+    byte_size (data1)
+    type (ref4)
+  [72] base_type "char"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [76] subprogram "foo"
+    external (flag_present)
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (data1)
+    sibling (ref4)
+    [87] formal_parameter "f"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+  [92] subprogram "baz"
+    external (flag_present)
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (data1)
+    sibling (ref4)
+    [a3] formal_parameter "x"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [ad] variable "r"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+  [b8] subprogram "frob"
+    name (GNU_str_index)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (data1)
+    sibling (ref4)
+    [c6] formal_parameter "a"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [d0] formal_parameter "b"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [da] variable "c"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+  [e5] subprogram "foo"
+    abstract_origin (ref4)
+    low_pc (GNU_addr_index)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    GNU_all_call_sites (flag_present)
+    sibling (ref4)
+    [f9] formal_parameter "f"
+      abstract_origin (ref4)
+      location (sec_offset)
+            [1170,1186) {reg5}
+            [1186,100001185) {GNU_entry_value(1) {reg5}, stack_value}
+    [102] inlined_subroutine "foo"
+      abstract_origin (ref4)
+      low_pc (GNU_addr_index)
+      high_pc (data8)
+      call_file (data1)
+      call_line (data1)
+      call_column (data1)
+      [113] formal_parameter "f"
+        abstract_origin (ref4)
+        location (sec_offset)
+              [1180,1186) {reg5}
+              [1186,100001185) {GNU_entry_value(1) {reg5}, stack_value}
+      [11c] GNU_call_site "main"
+        low_pc (GNU_addr_index)
+        GNU_tail_call (flag_present)
+        abstract_origin (ref4)
+        [122] GNU_call_site_parameter
+          location (exprloc) {reg5}
+          GNU_call_site_value (exprloc) {GNU_entry_value(1) {reg5}}
+        [129] GNU_call_site_parameter
+          location (exprloc) {reg4}
+          GNU_call_site_value (exprloc) {lit0}
+  [131] subprogram "baz"
+    abstract_origin (ref4)
+    low_pc (GNU_addr_index)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    GNU_all_call_sites (flag_present)
+    [141] formal_parameter "x"
+      abstract_origin (ref4)
+      location (sec_offset)
+            [1190,119c) {reg5}
+            [119c,11b0) {GNU_entry_value(1) {reg5}, stack_value}
+            [11b0,11c6) {reg5}
+            [11c6,1000011c5) {GNU_entry_value(1) {reg5}, stack_value}
+    [14a] variable "r"
+      abstract_origin (ref4)
+      location (sec_offset)
+            [1190,119a) {reg5}
+            [119a,119c) {breg5(0), breg0(0), minus, stack_value}
+            [119c,119f) {reg5}
+            [119f,11a5) {breg5(1), stack_value}
+            [11b0,11c6) {reg5}
+            [11c6,1000011c5) {GNU_entry_value(1) {reg5}, stack_value}
+    [153] inlined_subroutine "foo"
+      abstract_origin (ref4)
+      entry_pc (GNU_addr_index)
+      ranges (sec_offset)
+      call_file (data1)
+      call_line (data1)
+      call_column (data1)
+      [160] formal_parameter "f"
+        abstract_origin (ref4)
+        location (sec_offset)
+              [119c,119f) {reg5}
+              [119f,11a5) {breg5(1), stack_value}
+              [11b0,11b6) {reg5}
+              [11b9,11c6) {reg5}
+              [11c6,1000011c5) {GNU_entry_value(1) {reg5}, stack_value}
+      [169] inlined_subroutine "frob"
+        abstract_origin (ref4)
+        low_pc (GNU_addr_index)
+        high_pc (data8)
+        call_file (data1)
+        call_line (data1)
+        call_column (data1)
+        sibling (ref4)
+        [17e] formal_parameter "b"
+          abstract_origin (ref4)
+          location (sec_offset)
+                [119f,11af) {reg0}
+        [187] formal_parameter "a"
+          abstract_origin (ref4)
+          location (sec_offset)
+                [119f,11a5) {reg5}
+        [190] variable "c"
+          abstract_origin (ref4)
+          location (sec_offset)
+                [119f,11ae) {reg5}
+        [199] inlined_subroutine "baz"
+          abstract_origin (ref4)
+          low_pc (GNU_addr_index)
+          high_pc (data8)
+          call_file (data1)
+          call_line (data1)
+          call_column (data1)
+          [1aa] formal_parameter "x"
+            abstract_origin (ref4)
+            location (sec_offset)
+                  [11a5,11ae) {reg5}
+          [1b3] variable "r"
+            abstract_origin (ref4)
+            location (sec_offset)
+                  [11a5,11af) {reg5}
+          [1bc] GNU_call_site "foo"
+            low_pc (GNU_addr_index)
+            GNU_tail_call (flag_present)
+            abstract_origin (ref4)
+      [1c4] inlined_subroutine "foo"
+        abstract_origin (ref4)
+        low_pc (GNU_addr_index)
+        high_pc (data8)
+        call_file (data1)
+        call_line (data1)
+        call_column (data1)
+        [1d5] formal_parameter "f"
+          abstract_origin (ref4)
+          location (sec_offset)
+                [11b9,11c6) {reg5}
+                [11c6,1000011c5) {GNU_entry_value(1) {reg5}, stack_value}
+        [1de] GNU_call_site "main"
+          low_pc (GNU_addr_index)
+          GNU_tail_call (flag_present)
+          abstract_origin (ref4)
+          [1e4] GNU_call_site_parameter
+            location (exprloc) {reg4}
+            GNU_call_site_value (exprloc) {lit0}
+module 'testfile-dwp-4'
+[b] CU 'world.c'
+  producer (GNU_str_index)
+  language (data1)
+  name (GNU_str_index)
+  comp_dir (GNU_str_index)
+  GNU_dwo_id (data8)
+  [18] variable "m"
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    type (ref4)
+    external (flag_present)
+    declaration (flag_present)
+  [22] base_type "int"
+    byte_size (data1)
+    encoding (data1)
+    name (string)
+  [29] base_type "long unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [2d] base_type "long int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [31] base_type "long long int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [35] base_type "unsigned char"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [39] base_type "short unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [3d] base_type "unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [41] base_type "signed char"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [45] base_type "short int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [49] base_type "char"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [4d] const_type
+    type (ref4)
+  [52] base_type "long long unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (GNU_str_index)
+  [56] subprogram "exit"
+    external (flag_present)
+    name (GNU_str_index)
+    decl_file (data1)
+    decl_line (data2)
+    decl_column (data1)
+    prototyped (flag_present)
+    noreturn (flag_present)
+    declaration (flag_present)
+    sibling (ref4)
+    [60] formal_parameter
+      type (ref4)
+  [66] subprogram "baz"
+    external (flag_present)
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    declaration (flag_present)
+    sibling (ref4)
+    [76] formal_parameter
+      type (ref4)
+  [7c] subprogram "main"
+    external (flag_present)
+    name (GNU_str_index)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    low_pc (GNU_addr_index)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    GNU_all_call_sites (flag_present)
+    sibling (ref4)
+    [94] formal_parameter "argc"
+      name (GNU_str_index)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (sec_offset)
+            [1050,105d) {reg5}
+            [105d,1069) {reg0}
+            [1069,106f) {GNU_entry_value(1) {reg5}, stack_value}
+    [a1] formal_parameter "argv"
+      name (GNU_str_index)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (sec_offset)
+            [1050,1069) {reg4}
+            [1069,106f) {GNU_entry_value(1) {reg4}, stack_value}
+    [ae] variable "n"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (sec_offset)
+            [1065,1069) {reg5}
+    [bc] GNU_call_site "calc"
+      low_pc (GNU_addr_index)
+      abstract_origin (ref4)
+    [c2] GNU_call_site "exit"
+      low_pc (GNU_addr_index)
+      abstract_origin (ref4)
+  [c9] pointer_type
+    byte_size (data1)
+    type (ref4)
+  [cf] pointer_type
+    byte_size (data1)
+    type (ref4)
+  [d5] subprogram "calc"
+    external (flag_present)
+    name (GNU_str_index)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    low_pc (GNU_addr_index)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    GNU_all_call_sites (flag_present)
+    sibling (ref4)
+    [ed] formal_parameter "word"
+      name (GNU_str_index)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (sec_offset)
+            [11d0,11d8) {reg5}
+            [11d8,11fb) {GNU_entry_value(1) {reg5}, stack_value}
+    [fa] inlined_subroutine "frob"
+      abstract_origin (ref4)
+      entry_pc (GNU_addr_index)
+      ranges (sec_offset)
+      call_file (data1)
+      call_line (data1)
+      call_column (data1)
+      [107] formal_parameter "b"
+        abstract_origin (ref4)
+        location (sec_offset)
+              [11e8,11f3) {reg0}
+      [110] formal_parameter "a"
+        abstract_origin (ref4)
+        location (sec_offset)
+              [11e8,11ea) {reg1}
+              [11ea,11ef) {reg5}
+              [11ef,11f3) {GNU_entry_value(1) {reg5}, deref_size(1), const1u(56), shl, const1u(56), shra, stack_value}
+      [119] lexical_block
+        ranges (sec_offset)
+        [11e] variable "c"
+          abstract_origin (ref4)
+          location (sec_offset)
+                [11e8,11ea) {reg1}
+                [11ea,11f3) {reg5}
+        [127] GNU_call_site "baz"
+          low_pc (GNU_addr_index)
+          GNU_tail_call (flag_present)
+          abstract_origin (ref4)
+  [130] subprogram "frob"
+    name (GNU_str_index)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (data1)
+    [13a] formal_parameter "a"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [144] formal_parameter "b"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [14e] variable "c"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+EOF
+
+testrun_compare ${abs_builddir}/varlocs --exprlocs -e testfile-dwp-5 << \EOF
+module 'testfile-dwp-5'
+[14] CU 'hello.c'
+  producer (strx)
+  language (data1)
+  name (strx)
+  comp_dir (strx)
+  [19] base_type "long int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [1d] base_type "long unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [21] typedef "wchar_t"
+    name (strx)
+    decl_file (data1)
+    decl_line (data2)
+    decl_column (data1)
+    type (ref4)
+  [2b] base_type "int"
+    byte_size (data1)
+    encoding (data1)
+    name (string)
+  [32] base_type "long long int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [36] base_type "long double"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [3a] variable "m"
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    type (ref4)
+    external (flag_present)
+    declaration (flag_present)
+  [44] variable "m"
+    specification (ref4)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    location (exprloc) {addr: 0x4018}
+  [4f] subprogram "main"
+    external (flag_present)
+    name (strx)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    declaration (flag_present)
+    sibling (ref4)
+    [5c] formal_parameter
+      type (ref4)
+    [61] formal_parameter
+      type (ref4)
+  [67] pointer_type
+    byte_size (implicit_const)
+    type (ref4)
+  [6c] pointer_type
+    byte_size (implicit_const)
+    type (ref4)
+  [71] base_type "char"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [75] subprogram "foo"
+    external (flag_present)
+    name (string)
+    decl_file (implicit_const)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (implicit_const)
+    sibling (ref4)
+    [84] formal_parameter "f"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+  [8f] subprogram "baz"
+    external (flag_present)
+    name (string)
+    decl_file (implicit_const)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (implicit_const)
+    sibling (ref4)
+    [9e] formal_parameter "x"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [a8] variable "r"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (implicit_const)
+      type (ref4)
+  [b2] subprogram "frob"
+    name (strx)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (data1)
+    sibling (ref4)
+    [c0] formal_parameter "a"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [ca] formal_parameter "b"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+    [d4] variable "c"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (implicit_const)
+      type (ref4)
+  [de] subprogram "foo"
+    abstract_origin (ref4)
+    low_pc (addrx)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    call_all_calls (flag_present)
+    sibling (ref4)
+    [f2] formal_parameter "f"
+      abstract_origin (ref4)
+      location (loclistx)
+            [1170,1186) {reg5}
+            [1186,1187) {entry_value(1) {reg5}, stack_value}
+    [f8] inlined_subroutine "foo"
+      abstract_origin (ref4)
+      low_pc (addrx)
+      high_pc (data8)
+      call_file (data1)
+      call_line (data1)
+      call_column (data1)
+      [109] formal_parameter "f"
+        abstract_origin (ref4)
+        location (loclistx)
+              [1180,1186) {reg5}
+              [1186,1187) {entry_value(1) {reg5}, stack_value}
+      [10f] call_site
+        call_return_pc (addrx)
+        call_tail_call (flag_present)
+        call_origin (ref4)
+        [115] call_site_parameter
+          location (exprloc) {reg5}
+          call_value (exprloc) {entry_value(1) {reg5}}
+        [11c] call_site_parameter
+          location (exprloc) {reg4}
+          call_value (exprloc) {lit0}
+  [124] subprogram "baz"
+    abstract_origin (ref4)
+    low_pc (addrx)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    call_all_calls (flag_present)
+    [134] formal_parameter "x"
+      abstract_origin (ref4)
+      location (loclistx)
+            [1190,119c) {reg5}
+            [119c,11b0) {entry_value(1) {reg5}, stack_value}
+            [11b0,11c6) {reg5}
+            [11c6,11c7) {entry_value(1) {reg5}, stack_value}
+    [13a] variable "r"
+      abstract_origin (ref4)
+      location (loclistx)
+            [1190,119a) {reg5}
+            [119a,119c) {breg5(0), breg0(0), minus, stack_value}
+            [119c,119f) {reg5}
+            [119f,11a5) {breg5(1), stack_value}
+            [11b0,11c6) {reg5}
+            [11c6,11c7) {entry_value(1) {reg5}, stack_value}
+    [140] inlined_subroutine "foo"
+      abstract_origin (ref4)
+      entry_pc (addrx)
+      ranges (rnglistx)
+      call_file (data1)
+      call_line (data1)
+      call_column (data1)
+      [14a] formal_parameter "f"
+        abstract_origin (ref4)
+        location (loclistx)
+              [119c,119f) {reg5}
+              [119f,11a5) {breg5(1), stack_value}
+              [11b0,11b6) {reg5}
+              [11b9,11c6) {reg5}
+              [11c6,11c7) {entry_value(1) {reg5}, stack_value}
+      [150] inlined_subroutine "frob"
+        abstract_origin (ref4)
+        low_pc (addrx)
+        high_pc (data8)
+        call_file (data1)
+        call_line (data1)
+        call_column (data1)
+        sibling (ref4)
+        [165] formal_parameter "b"
+          abstract_origin (ref4)
+          location (loclistx)
+                [119f,11af) {reg0}
+        [16b] formal_parameter "a"
+          abstract_origin (ref4)
+          location (loclistx)
+                [119f,11a5) {reg5}
+        [171] variable "c"
+          abstract_origin (ref4)
+          location (loclistx)
+                [119f,11ae) {reg5}
+        [177] inlined_subroutine "baz"
+          abstract_origin (ref4)
+          low_pc (addrx)
+          high_pc (data8)
+          call_file (data1)
+          call_line (data1)
+          call_column (data1)
+          [188] formal_parameter "x"
+            abstract_origin (ref4)
+            location (loclistx)
+                  [11a5,11ae) {reg5}
+          [18e] variable "r"
+            abstract_origin (ref4)
+            location (loclistx)
+                  [11a5,11af) {reg5}
+          [194] call_site
+            call_return_pc (addrx)
+            call_tail_call (flag_present)
+            call_origin (ref4)
+      [19c] inlined_subroutine "foo"
+        abstract_origin (ref4)
+        low_pc (addrx)
+        high_pc (data8)
+        call_file (data1)
+        call_line (data1)
+        call_column (data1)
+        [1ad] formal_parameter "f"
+          abstract_origin (ref4)
+          location (loclistx)
+                [11b9,11c6) {reg5}
+                [11c6,11c7) {entry_value(1) {reg5}, stack_value}
+        [1b3] call_site
+          call_return_pc (addrx)
+          call_tail_call (flag_present)
+          call_origin (ref4)
+          [1b9] call_site_parameter
+            location (exprloc) {reg4}
+            call_value (exprloc) {lit0}
+module 'testfile-dwp-5'
+[14] CU 'world.c'
+  producer (strx)
+  language (data1)
+  name (strx)
+  comp_dir (strx)
+  [19] variable "m"
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    type (ref4)
+    external (flag_present)
+    declaration (flag_present)
+  [23] base_type "int"
+    byte_size (data1)
+    encoding (data1)
+    name (string)
+  [2a] base_type "long unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [2e] base_type "long int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [32] base_type "long long int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [36] base_type "unsigned char"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [3a] base_type "short unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [3e] base_type "unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [42] base_type "signed char"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [46] base_type "short int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [4a] base_type "char"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [4e] const_type
+    type (ref4)
+  [53] base_type "long long unsigned int"
+    byte_size (data1)
+    encoding (data1)
+    name (strx)
+  [57] subprogram "exit"
+    external (flag_present)
+    name (strx)
+    decl_file (data1)
+    decl_line (data2)
+    decl_column (data1)
+    prototyped (flag_present)
+    noreturn (flag_present)
+    declaration (flag_present)
+    sibling (ref4)
+    [61] formal_parameter
+      type (ref4)
+  [67] subprogram "baz"
+    external (flag_present)
+    name (string)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    declaration (flag_present)
+    sibling (ref4)
+    [77] formal_parameter
+      type (ref4)
+  [7d] subprogram "main"
+    external (flag_present)
+    name (strx)
+    decl_file (implicit_const)
+    decl_line (data1)
+    decl_column (implicit_const)
+    prototyped (flag_present)
+    type (ref4)
+    low_pc (addrx)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    call_all_calls (flag_present)
+    sibling (ref4)
+    [93] formal_parameter "argc"
+      name (strx)
+      decl_file (implicit_const)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (loclistx)
+            [1050,105d) {reg5}
+            [105d,1069) {reg0}
+            [1069,1071) {entry_value(1) {reg5}, stack_value}
+    [9c] formal_parameter "argv"
+      name (strx)
+      decl_file (implicit_const)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (loclistx)
+            [1050,1069) {reg4}
+            [1069,1071) {entry_value(1) {reg4}, stack_value}
+    [a5] variable "n"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (loclistx)
+            [1065,1069) {reg5}
+    [b0] call_site
+      call_return_pc (addrx)
+      call_origin (ref4)
+    [b6] call_site
+      call_return_pc (addrx)
+      call_origin (ref4)
+  [bd] pointer_type
+    byte_size (implicit_const)
+    type (ref4)
+  [c2] pointer_type
+    byte_size (implicit_const)
+    type (ref4)
+  [c7] subprogram "calc"
+    external (flag_present)
+    name (strx)
+    decl_file (implicit_const)
+    decl_line (data1)
+    decl_column (implicit_const)
+    prototyped (flag_present)
+    type (ref4)
+    low_pc (addrx)
+    high_pc (data8)
+    frame_base (exprloc) {call_frame_cfa {bregx(7,8)}}
+    call_all_calls (flag_present)
+    sibling (ref4)
+    [dd] formal_parameter "word"
+      name (strx)
+      decl_file (implicit_const)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+      location (loclistx)
+            [11d0,11d8) {reg5}
+            [11d8,11fb) {entry_value(1) {reg5}, stack_value}
+    [e6] inlined_subroutine "frob"
+      abstract_origin (ref4)
+      entry_pc (addrx)
+      ranges (rnglistx)
+      call_file (data1)
+      call_line (data1)
+      call_column (data1)
+      [f0] formal_parameter "b"
+        abstract_origin (ref4)
+        location (loclistx)
+              [11e8,11f3) {reg0}
+      [f6] formal_parameter "a"
+        abstract_origin (ref4)
+        location (loclistx)
+              [11e8,11ea) {reg1}
+              [11ea,11ef) {reg5}
+              [11ef,11f3) {entry_value(1) {reg5}, deref_size(1), const1u(56), shl, const1u(56), shra, stack_value}
+      [fc] lexical_block
+        ranges (rnglistx)
+        [fe] variable "c"
+          abstract_origin (ref4)
+          location (loclistx)
+                [11e8,11ea) {reg1}
+                [11ea,11f3) {reg5}
+        [104] call_site
+          call_return_pc (addrx)
+          call_tail_call (flag_present)
+          call_origin (ref4)
+  [10d] subprogram "frob"
+    name (strx)
+    decl_file (data1)
+    decl_line (data1)
+    decl_column (data1)
+    prototyped (flag_present)
+    type (ref4)
+    inline (data1)
+    [117] formal_parameter "a"
+      name (string)
+      decl_file (implicit_const)
+      decl_line (implicit_const)
+      decl_column (data1)
+      type (ref4)
+    [11f] formal_parameter "b"
+      name (string)
+      decl_file (implicit_const)
+      decl_line (implicit_const)
+      decl_column (data1)
+      type (ref4)
+    [127] variable "c"
+      name (string)
+      decl_file (data1)
+      decl_line (data1)
+      decl_column (data1)
+      type (ref4)
+EOF
+
+testrun_compare ${abs_builddir}/all-dwarf-ranges testfile-dwp-4 << \EOF
+die: hello.c (11)
+ 1170..11c7
+
+die: foo (2e)
+ 1170..1187
+
+die: foo (1d)
+ 1180..1187
+
+die: baz (2e)
+ 1190..11c7
+
+die: foo (1d)
+ 119c..11b0
+ 11b0..11b6
+ 11c0..11c7
+
+die: frob (1d)
+ 119f..11b0
+
+die: baz (1d)
+ 11a5..11b0
+
+die: foo (1d)
+ 11c0..11c7
+
+die: world.c (11)
+ 11d0..11fb
+ 1050..1071
+
+die: main (2e)
+ 1050..1071
+
+die: calc (2e)
+ 11d0..11fb
+
+die: frob (1d)
+ 11e3..11e5
+ 11e8..11f8
+
+die: <unknown> (b)
+ 11e3..11e5
+ 11e8..11f8
+
+EOF
+
+testrun_compare ${abs_builddir}/all-dwarf-ranges testfile-dwp-5 << \EOF
+die: hello.c (11)
+ 1170..11c7
+
+die: foo (2e)
+ 1170..1187
+
+die: foo (1d)
+ 1180..1187
+
+die: baz (2e)
+ 1190..11c7
+
+die: foo (1d)
+ 119c..11b0
+ 11b0..11b6
+ 11c0..11c7
+
+die: frob (1d)
+ 119f..11b0
+
+die: baz (1d)
+ 11a5..11b0
+
+die: foo (1d)
+ 11c0..11c7
+
+die: world.c (11)
+ 11d0..11fb
+ 1050..1071
+
+die: main (2e)
+ 1050..1071
+
+die: calc (2e)
+ 11d0..11fb
+
+die: frob (1d)
+ 11e3..11e5
+ 11e8..11f8
+
+die: <unknown> (b)
+ 11e3..11e5
+ 11e8..11f8
+
+EOF
+
+exit 0
@@ -0,0 +1,39 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# see run-readelf-dwz-multi.sh
+testfiles testfile_multi_main testfile_multi.dwz
+testfiles testfile-dwzstr testfile-dwzstr.multi
+
+testrun_compare ${abs_builddir}/getalt-shared testfile_multi_main testfile-dwzstr <<\EOF
+file: testfile_multi_main
+shared alt: yes
+private alt: yes
+private: ref_alt: 5, strp_alt: 1
+first: ref_alt: 5, strp_alt: 1
+second: ref_alt: 5, strp_alt: 1
+file: testfile-dwzstr
+shared alt: yes
+private alt: yes
+private: ref_alt: 5, strp_alt: 6
+first: ref_alt: 5, strp_alt: 6
+second: ref_alt: 5, strp_alt: 6
+EOF
+
+exit 0
@@ -0,0 +1,41 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# dwarf_getscopes on a unit DIE uses an index of the unit scopes.  It
+# has to find the same scopes, including the abstract origins of
+# inlined subroutines, as a walk of the whole unit.
+
+# see run-addr2line-i-test.sh, run-addr2line-i-lex-test.sh,
+# run-dwarf-getmacros.sh and tests/testfile-dwarf-45.source
+testfiles testfile-inlines testfile-lex-inlines testfiledwarfinlines
+testfiles testfile-dwarf-4 testfile-dwarf-5
+
+testrun_compare ${abs_builddir}/getscopes-index testfile-inlines \
+  testfile-lex-inlines testfiledwarfinlines \
+  testfile-dwarf-4 testfile-dwarf-5 <<\EOF
+testfile-inlines: 44 addresses, 0 differ
+testfile-lex-inlines: 10 addresses, 0 differ
+testfiledwarfinlines: 114 addresses, 0 differ
+testfile-dwarf-4: 114 addresses, 0 differ
+testfile-dwarf-5: 114 addresses, 0 differ
+EOF
+
+testrun ${abs_builddir}/getscopes-index ${abs_top_builddir}/src/addr2line
+
+exit 0
@@ -0,0 +1,82 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# see tests/testfile-dwarf-45.source
+testfiles testfile-dwarf-4 testfile-dwarf-5
+testfiles testfile-splitdwarf-5 testfile-hello5.dwo testfile-world5.dwo
+
+testrun_compare ${abs_builddir}/index-aranges testfile-dwarf-4 testfile-dwarf-5 <<\EOF
+file: testfile-dwarf-4
+ 0x400410..0x40042f: [21c] world.c
+ 0x400510..0x400560: [b] hello.c
+ 0x400570..0x40059a: [21c] world.c
+file: testfile-dwarf-5
+ 0x400410..0x40042f: [218] world.c
+ 0x400510..0x400560: [c] hello.c
+ 0x400570..0x40059a: [218] world.c
+EOF
+
+# Remove .debug_aranges, the ranges should now come from the unit DIEs
+# (.debug_ranges for DWARF4 and .debug_rnglists for DWARF5).
+tempfiles testfile-noaranges-4 testfile-noaranges-5 testfile-noaranges-split
+testrun ${abs_top_builddir}/src/strip -g -o testfile-noaranges-4 \
+	--keep-section=.debug_info --keep-section=.debug_abbrev \
+	--keep-section=.debug_str --keep-section=.debug_line \
+	--keep-section=.debug_ranges --keep-section=.debug_loc \
+	testfile-dwarf-4
+testrun ${abs_top_builddir}/src/strip -g -o testfile-noaranges-5 \
+	--keep-section=.debug_info --keep-section=.debug_abbrev \
+	--keep-section=.debug_str --keep-section=.debug_line \
+	--keep-section=.debug_line_str --keep-section=.debug_rnglists \
+	--keep-section=.debug_loclists \
+	testfile-dwarf-5
+
+testrun_compare ${abs_builddir}/index-aranges testfile-noaranges-4 testfile-noaranges-5 <<\EOF
+file: testfile-noaranges-4
+ 0x400410..0x40042f: [21c] world.c
+ 0x400510..0x400560: [b] hello.c
+ 0x400570..0x40059a: [21c] world.c
+file: testfile-noaranges-5
+ 0x400410..0x40042f: [218] world.c
+ 0x400510..0x400560: [c] hello.c
+ 0x400570..0x40059a: [218] world.c
+EOF
+
+# Skeleton units have their ranges in the main file.
+testrun ${abs_top_builddir}/src/strip -g -o testfile-noaranges-split \
+	--keep-section=.debug_info --keep-section=.debug_abbrev \
+	--keep-section=.debug_str --keep-section=.debug_line \
+	--keep-section=.debug_line_str --keep-section=.debug_rnglists \
+	--keep-section=.debug_addr --keep-section=.debug_str_offsets \
+	testfile-splitdwarf-5
+
+testrun_compare ${abs_builddir}/index-aranges testfile-noaranges-split <<\EOF
+file: testfile-noaranges-split
+ 0x401060..0x40107f: [49] ???
+ 0x401160..0x4011b0: [14] ???
+ 0x4011c0..0x4011ea: [49] ???
+EOF
+
+# libdwfl uses the synthesized ranges to find the CU of an address.
+testrun_compare ${abs_top_builddir}/src/addr2line -e testfile-noaranges-5 0x400520 0x400580 <<\EOF
+/var/tmp/hello/hello.c:26:34
+/var/tmp/hello/world.c:10:3
+EOF
+
+exit 0
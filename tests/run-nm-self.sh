@@ -34,3 +34,15 @@ for what_arg in --debug-syms --defined-only --dynamic --extern-only; do
     done
   done
 done
+
+# With -j the files and archive members are processed in parallel,
+# the output has to be the same.
+ET_AR=${abs_top_builddir}/libelf/libelf.a
+tempfiles nm.out nm-j.out
+for format_arg in --format=bsd --format=sysv --format=posix; do
+  testrun ${abs_top_builddir}/src/nm $format_arg --print-armap \
+    $ET_REL $ET_EXEC $ET_DYN $ET_AR > nm.out
+  testrun ${abs_top_builddir}/src/nm -j 3 $format_arg --print-armap \
+    $ET_REL $ET_EXEC $ET_DYN $ET_AR > nm-j.out
+  cmp nm.out nm-j.out
+done
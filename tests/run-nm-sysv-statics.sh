@@ -0,0 +1,113 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# The sysv format shows the source line of same named static functions
+# and variables of several CUs.  The identical helper functions of a.c
+# and b.c are folded into one, its line is the one of the first CU.
+#
+# // a.c
+# static int counter;
+#
+# static int
+# helper (int i)
+# {
+#   return i * 3 + 1;
+# }
+#
+# int
+# a_func (int i)
+# {
+#   counter += i;
+#   return helper (counter);
+# }
+#
+# // b.c is a.c with b_func doing counter -= i.
+# // c.c is a.c with c_func doing counter ^= i and helper returning i * 5 - 2.
+#
+# // m.c
+# extern int a_func (int);
+# extern int b_func (int);
+# extern int c_func (int);
+#
+# int
+# main (int argc, char **argv)
+# {
+#   return a_func (argc) + b_func (argc) + c_func (argc);
+# }
+#
+# gcc -g -O1 -fno-inline -ffunction-sections -fuse-ld=gold -Wl,--icf=all \
+#   -o testfile-nm-statics m.c a.c b.c c.c
+
+testfiles testfile-nm-statics
+
+tempfiles nm.out
+cat > nm.out <<\EOF
+
+
+Symbols from testfile-nm-statics:
+
+Name                                   Value            Class  Type     Size               Line Section
+
+_GLOBAL_OFFSET_TABLE_                 |0000000000001fe8|LOCAL |OBJECT  |0000000000000020|      |.got.plt
+_IO_stdin_used                        |00000000000006e4|GLOBAL|OBJECT  |0000000000000004|      |.rodata
+__FRAME_END__                         |00000000000007f8|LOCAL |OBJECT  |0000000000000000|      |.eh_frame
+__TMC_END__                           |0000000000002018|LOCAL |OBJECT  |0000000000000000|      |.tm_clone_table
+__TMC_LIST__                          |0000000000002018|LOCAL |OBJECT  |0000000000000000|      |.tm_clone_table
+__abi_tag                             |00000000000002b0|LOCAL |OBJECT  |0000000000000020|      |.note.ABI-tag
+__bss_start                           |0000000000002018|GLOBAL|NOTYPE  |0000000000000000|      |.fini_array
+__data_start                          |0000000000002008|GLOBAL|NOTYPE  |0000000000000000|      |.data
+__do_global_dtors_aux                 |0000000000000620|LOCAL |FUNC    |0000000000000000|      |.text
+__do_global_dtors_aux_fini_array_entry|0000000000001dc0|LOCAL |OBJECT  |0000000000000000|      |.fini_array
+__dso_handle                          |0000000000002010|LOCAL |OBJECT  |0000000000000000|      |.data
+__frame_dummy_init_array_entry        |0000000000001dc8|LOCAL |OBJECT  |0000000000000000|      |.init_array
+_edata                                |0000000000002018|GLOBAL|NOTYPE  |0000000000000000|      |.fini_array
+_end                                  |0000000000002028|GLOBAL|NOTYPE  |0000000000000000|      |.fini_array
+_fini                                 |00000000000006d8|LOCAL |FUNC    |0000000000000000|      |.fini
+_init                                 |0000000000000540|LOCAL |FUNC    |0000000000000000|      |.init
+_start                                |0000000000000580|GLOBAL|FUNC    |0000000000000022|      |.text
+a.c                                   |0000000000000000|LOCAL |FILE    |0000000000000000|      |ABS
+a_func                                |0000000000000696|GLOBAL|FUNC    |0000000000000012|a.c:10|.text
+b.c                                   |0000000000000000|LOCAL |FILE    |0000000000000000|      |ABS
+b_func                                |00000000000006a8|GLOBAL|FUNC    |0000000000000016|b.c:10|.text
+c.c                                   |0000000000000000|LOCAL |FILE    |0000000000000000|      |ABS
+c_func                                |00000000000006c3|GLOBAL|FUNC    |0000000000000012|c.c:10|.text
+completed.0                           |0000000000002018|LOCAL |OBJECT  |0000000000000001|      |.bss
+counter                               |000000000000201c|LOCAL |OBJECT  |0000000000000004| a.c:1|.bss
+counter                               |0000000000002020|LOCAL |OBJECT  |0000000000000004| b.c:1|.bss
+counter                               |0000000000002024|LOCAL |OBJECT  |0000000000000004| c.c:1|.bss
+crtstuff.c                            |0000000000000000|LOCAL |FILE    |0000000000000000|      |ABS
+crtstuff.c                            |0000000000000000|LOCAL |FILE    |0000000000000000|      |ABS
+data_start                            |0000000000002008|WEAK  |NOTYPE  |0000000000000000|      |.data
+deregister_tm_clones                  |00000000000005b0|LOCAL |FUNC    |0000000000000000|      |.text
+frame_dummy                           |0000000000000660|LOCAL |FUNC    |0000000000000000|      |.text
+helper                                |0000000000000691|LOCAL |FUNC    |0000000000000005| a.c:4|.text
+helper                                |00000000000006be|LOCAL |FUNC    |0000000000000005| c.c:4|.text
+m.c                                   |0000000000000000|LOCAL |FILE    |0000000000000000|      |ABS
+main                                  |0000000000000669|GLOBAL|FUNC    |0000000000000028| m.c:6|.text
+register_tm_clones                    |00000000000005e0|LOCAL |FUNC    |0000000000000000|      |.text
+EOF
+
+testrun_compare ${abs_top_builddir}/src/nm --defined-only -f sysv \
+  testfile-nm-statics < nm.out
+
+# With -j a single file has its CUs gone through in several threads.
+testrun_compare ${abs_top_builddir}/src/nm -j 3 --defined-only -f sysv \
+  testfile-nm-statics < nm.out
+
+exit 0
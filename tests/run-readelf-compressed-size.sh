@@ -0,0 +1,58 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# The decompressed image goes into a buffer sized by the uncompressed
+# size the container records.  Check images where that is right, and
+# where it is wrong or missing.  See run-readelf-compressed.sh.
+testfiles hello_i386.ko
+
+tempfiles readelf.out.1 readelf.out.2
+tempfiles hello.gz hello-split.gz hello.xz hello-blocks.xz hello.lzma
+
+testrun ${abs_top_builddir}/src/readelf -h -s -winfo hello_i386.ko \
+  > readelf.out.1
+
+check_compressed ()
+{
+  testrun ${abs_top_builddir}/src/readelf -h -s -winfo $1 > readelf.out.2
+  diff -u readelf.out.1 readelf.out.2 || exit 1
+}
+
+gzip -c hello_i386.ko > hello.gz
+check_compressed hello.gz
+
+# The gzip trailer only has the size of the last member.
+head -c 50000 hello_i386.ko | gzip -c > hello-split.gz
+tail -c +50001 hello_i386.ko | gzip -c >> hello-split.gz
+check_compressed hello-split.gz
+
+if grep -q -F '#define USE_LZMA' ${abs_top_builddir}/config.h \
+   && type xz > /dev/null 2>&1; then
+  xz -c hello_i386.ko > hello.xz
+  check_compressed hello.xz
+
+  # Several blocks, which the threaded decoder can handle in parallel.
+  xz -T2 --block-size=16384 -c hello_i386.ko > hello-blocks.xz
+  check_compressed hello-blocks.xz
+
+  xz --format=lzma -c hello_i386.ko > hello.lzma
+  check_compressed hello.lzma
+fi
+
+exit 0